@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+
+# Copyright 2019-2025 Andy Curtis
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Sweeps the introsort thresholds (see include/the-macro-library/src/macro_sort_config.h)
+# and the block swap threshold (src/macro_swap.h) for one element type on this machine
+# and writes a header with the fastest values.
+#
+#   macro-autotune.py --key u32 --elem-size 16 -o sort_config_16.h
+#
+# Each candidate is compiled into a small benchmark (with -D overrides) which sorts
+# random, nearly sorted, and few unique arrays of several sizes.  The thresholds are
+# tuned one at a time, keeping the best value found so far for the others.
+
+import argparse
+import os
+import platform
+import subprocess
+import sys
+import tempfile
+
+keys = {
+    'u32': 'uint32_t',
+    'u64': 'uint64_t',
+    'i32': 'int32_t',
+    'i64': 'int64_t',
+    'f32': 'float',
+    'f64': 'double',
+}
+
+defaults = [
+    ('MACRO_SORT_SMALL', 17, [8, 10, 12, 14, 17, 20, 24, 28, 32, 40, 48]),
+    ('MACRO_SORT_NINTHER', 40, [24, 32, 40, 56, 80, 128, 192, 256]),
+    ('MACRO_SORT_CHECK_FEW', 32, [16, 24, 32, 48, 64]),
+    ('MACRO_SORT_CHECK_SOME', 256, [64, 128, 256, 512, 1024]),
+    ('MACRO_SWAP_BLOCK_MIN', 64, [16, 32, 64, 128, 256, 1024]),
+]
+
+benchmark = r'''
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "the-macro-library/macro_sort.h"
+#include "the-macro-library/macro_time.h"
+
+typedef struct {
+    KEY_TYPE key;
+#if ELEM_SIZE > KEY_SIZE
+    unsigned char pad[ELEM_SIZE - KEY_SIZE];
+#endif
+} elem_t;
+
+static inline bool elem_less(const elem_t *a, const elem_t *b) {
+    return a->key < b->key;
+}
+
+macro_sort(sort_elems, elem_t, elem_less);
+
+static uint64_t seed = 88172645463325252ULL;
+static uint64_t next_rand(void) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+static void fill(elem_t *arr, size_t n, int pattern) {
+    size_t i;
+    memset(arr, 0, n * sizeof(elem_t));
+    for(i = 0; i < n; i++) {
+        if(pattern == 0)
+            arr[i].key = (KEY_TYPE)(next_rand() % 1000000000);
+        else if(pattern == 1)
+            arr[i].key = (KEY_TYPE)((next_rand() % 100) ? i : next_rand() % n);
+        else
+            arr[i].key = (KEY_TYPE)(next_rand() % 16);
+    }
+}
+
+int main(void) {
+    size_t sizes[] = {SIZES};
+    size_t total = TOTAL;
+    size_t s, r, reps, n;
+    int pattern;
+    for(s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        n = sizes[s];
+        reps = total / n;
+        if(reps < 1)
+            reps = 1;
+        elem_t *arr = (elem_t *)malloc(n * reps * sizeof(elem_t));
+        for(pattern = 0; pattern < 3; pattern++) {
+            uint64_t best = 0;
+            int trial;
+            for(trial = 0; trial < TRIALS; trial++) {
+                for(r = 0; r < reps; r++)
+                    fill(arr + r * n, n, pattern);
+                uint64_t start = macro_now();
+                for(r = 0; r < reps; r++)
+                    sort_elems(arr + r * n, n);
+                uint64_t elapsed = macro_now() - start;
+                if(!trial || elapsed < best)
+                    best = elapsed;
+            }
+            printf("%zu %d %.3f\n", n, pattern, (double)best / (double)(n * reps));
+        }
+        free(arr);
+    }
+    return 0;
+}
+'''
+
+
+def run_config(args, workdir, config):
+    src = os.path.join(workdir, 'bench.c')
+    exe = os.path.join(workdir, 'bench')
+    with open(src, 'w') as f:
+        f.write(benchmark)
+    cmd = [args.cc] + args.cflags.split() + ['-I' + args.include]
+    cmd += ['-DKEY_TYPE=' + keys[args.key], '-DKEY_SIZE=%d' % key_size(args.key)]
+    cmd += ['-DELEM_SIZE=%d' % args.elem_size, '-DTOTAL=%d' % args.total]
+    cmd += ['-DTRIALS=%d' % args.trials, '-DSIZES=' + ','.join(str(n) for n in args.sizes)]
+    for name, value in config.items():
+        cmd.append('-D%s=%d' % (name, value))
+    cmd += [src, '-o', exe]
+    subprocess.run(cmd, check=True)
+    out = subprocess.run([exe], check=True, capture_output=True, text=True).stdout
+    times = {}
+    for line in out.split('\n'):
+        if line:
+            n, pattern, ns = line.split()
+            times[(n, pattern)] = float(ns)
+    return times
+
+
+def key_size(key):
+    return 8 if key in ('u64', 'i64', 'f64') else 4
+
+
+def score(times, baseline):
+    # the average time relative to the defaults, so each size / pattern counts equally
+    return sum(times[k] / baseline[k] for k in times) / len(times)
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description='Tune the macro_sort thresholds for this machine')
+    parser.add_argument('--key', choices=sorted(keys.keys()), default='u32', help='the type of the sort key')
+    parser.add_argument('--elem-size', type=int, default=0, help='the size of each element (defaults to the key size)')
+    parser.add_argument('--sizes', type=int, nargs='+', default=[20, 50, 100, 1000, 10000, 1000000])
+    parser.add_argument('--total', type=int, default=2000000, help='elements sorted per size and pattern')
+    parser.add_argument('--trials', type=int, default=3)
+    parser.add_argument('--cc', default=os.environ.get('CC', 'cc'))
+    parser.add_argument('--cflags', default='-O3')
+    parser.add_argument('--include', default=os.path.join(here, '..', 'include'))
+    parser.add_argument('-o', '--output', default='macro_sort_config_tuned.h')
+    args = parser.parse_args()
+    if args.elem_size < key_size(args.key):
+        args.elem_size = key_size(args.key)
+
+    best = dict((name, value) for name, value, _ in defaults)
+    with tempfile.TemporaryDirectory() as workdir:
+        baseline = run_config(args, workdir, best)
+        for name, _, candidates in defaults:
+            # re-measure the current best so that one noisy run doesn't stick
+            best_score = score(run_config(args, workdir, best), baseline)
+            for value in candidates:
+                if value == best[name]:
+                    continue
+                config = dict(best)
+                config[name] = value
+                if config['MACRO_SORT_CHECK_FEW'] >= config['MACRO_SORT_CHECK_SOME']:
+                    continue
+                s = score(run_config(args, workdir, config), baseline)
+                print('%s=%d %.3f' % (name, value, s), file=sys.stderr)
+                if s < best_score * 0.99:
+                    best_score = s
+                    best[name] = value
+            print('%s => %d' % (name, best[name]), file=sys.stderr)
+        baseline = run_config(args, workdir, dict((name, value) for name, value, _ in defaults))
+        best_score = score(run_config(args, workdir, best), baseline)
+
+    with open(args.output, 'w') as f:
+        f.write('// generated by macro-autotune.py for %d byte elements with a %s key\n' % (args.elem_size, args.key))
+        f.write('// on %s (%s), %.1f%% of the default time\n' % (platform.node(), platform.machine(), best_score * 100.0))
+        f.write('// include before the first the-macro-library header\n')
+        for name, _, _ in defaults:
+            f.write('#undef %s\n#define %s %d\n' % (name, name, best[name]))
+    print('wrote %s' % args.output, file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
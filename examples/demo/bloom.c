@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "the-macro-library/macro_bloom.h"
+#include "the-macro-library/macro_bsearch.h"
+
+/* The filtered searches must return exactly what the unfiltered searches return (a
+   Bloom filter has no false negatives), and at 10 bits per key only about 1% of the
+   missing keys should get past the filter. */
+
+typedef struct {
+    macro_map_t node;
+    int value;
+} int_node;
+
+static inline
+int compare_int(const int *a, const int *b) {
+    return (*a > *b) - (*a < *b);
+}
+
+static inline
+int compare_node(const int_node *a, const int_node *b) {
+    return (a->value > b->value) - (a->value < b->value);
+}
+
+static inline
+int compare_key(const int *a, const int_node *b) {
+    return (*a > b->value) - (*a < b->value);
+}
+
+static inline
+uint64_t hash_int(const int *p) {
+    return macro_bloom_hash64((uint64_t)*p);
+}
+
+static inline
+uint64_t hash_node(const int_node *p) {
+    return hash_int(&p->value);
+}
+
+macro_bsearch(bsearch_ints, int, compare_int);
+macro_bloom_build(build_filter, int, hash_int);
+macro_bloom_bsearch(filtered_bsearch, int, hash_int, bsearch_ints);
+
+macro_map_insert(insert_node, int_node, compare_node);
+macro_map_find_kv(find_node, int, int_node, compare_key);
+macro_bloom_build_map(build_map_filter, int_node, hash_node);
+macro_bloom_map_find_kv(filtered_find, int, int_node, hash_int, find_node);
+
+#define NUM_KEYS 20000
+
+static int arr[NUM_KEYS];
+static int_node nodes[NUM_KEYS];
+
+int main() {
+    macro_bloom_t f, mf;
+    macro_map_t *root = NULL;
+    size_t passed = 0, missing = 0;
+    int failures = 0;
+
+    /* the even numbers below 2 * NUM_KEYS, the last 100 are added after the build */
+    for( int i=0; i<NUM_KEYS; i++ ) {
+        arr[i] = i * 2;
+        nodes[i].value = i * 2;
+        if(i < NUM_KEYS - 100)
+            insert_node(&root, nodes + i);
+    }
+    if(!build_filter(&f, arr, NUM_KEYS - 100, 10) || !build_map_filter(&mf, root, 10)) {
+        printf( "fail(bloom): build failed\n" );
+        return 1;
+    }
+    for( int i=NUM_KEYS - 100; i<NUM_KEYS; i++ ) {
+        insert_node(&root, nodes + i);
+        macro_bloom_add(&f, hash_int(arr + i));
+        macro_bloom_add(&mf, hash_node(nodes + i));
+    }
+
+    for( int key=-10; key<NUM_KEYS * 2 + 10; key++ ) {
+        int *r = bsearch_ints(&key, arr, NUM_KEYS);
+        if(filtered_bsearch(&f, &key, arr, NUM_KEYS) != r ||
+           filtered_find(&mf, root, &key) != find_node(root, &key)) {
+            if(failures++ < 10)
+                printf( "fail(bloom): key %d\n", key );
+        }
+        if(!r) {
+            missing++;
+            passed += macro_bloom_may_contain(&f, hash_int(&key));
+        }
+    }
+    if(passed * 100 > missing * 3) {
+        printf( "fail(bloom): %lu of %lu missing keys passed the filter\n",
+                (unsigned long)passed, (unsigned long)missing );
+        failures++;
+    }
+    if(!failures)
+        printf( "success(bloom): filtered searches match, %lu of %lu missing keys passed the filter\n",
+                (unsigned long)passed, (unsigned long)missing );
+    macro_bloom_destroy(&f);
+    macro_bloom_destroy(&mf);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "the-macro-library/macro_bsearch_batch.h"
+
+/* Searches for batches of keys (more and fewer than MACRO_BSEARCH_BATCH) and checks
+   every result against the single key macro_bsearch functions. */
+
+static inline
+int compare_int(const int *a, const int *b) {
+    return (*a > *b) - (*a < *b);
+}
+
+static inline
+int compare_key(const long *a, const int *b) {
+    return (*a > *b) - (*a < *b);
+}
+
+macro_bsearch_first(first_ints, int, compare_int);
+macro_bsearch_floor(floor_ints, int, compare_int);
+macro_bsearch_lower_bound(lower_bound_ints, int, compare_int);
+macro_bsearch_upper_bound(upper_bound_ints, int, compare_int);
+macro_bsearch_upper_bound_kv(upper_bound_key, long, int, compare_key);
+
+macro_bsearch_batch(batch_ints, int, compare_int);
+_macro_bsearch_batch(batch_floor_ints, floor, cmp_no_arg, int, compare_int);
+macro_bsearch_batch_lower_bound(batch_lower_bound_ints, int, compare_int);
+macro_bsearch_batch_upper_bound_compare(batch_upper_bound_cmp, int);
+macro_bsearch_batch_upper_bound_kv(batch_upper_bound_key, long, int, compare_key);
+
+#define MAX_N 1000
+#define MAX_KEYS 100
+
+static int arr[MAX_N], keys[MAX_KEYS];
+static long lkeys[MAX_KEYS];
+static int *results[5][MAX_KEYS];
+
+int main() {
+    const int sizes[] = { 0, 1, 2, 15, 16, 17, 100, MAX_N };
+    const int key_counts[] = { 0, 1, 15, 16, 17, 33, MAX_KEYS };
+    int failures = 0;
+    srand(1);
+    for( int s=0; s<(int)(sizeof(sizes)/sizeof(sizes[0])); s++ ) {
+        int n = sizes[s], value = 0;
+        for( int i=0; i<n; i++ ) {
+            value += rand() % 3;
+            arr[i] = value;
+        }
+        for( int c=0; c<(int)(sizeof(key_counts)/sizeof(key_counts[0])); c++ ) {
+            int num_keys = key_counts[c];
+            for( int i=0; i<num_keys; i++ ) {
+                keys[i] = rand() % (value + 3) - 1;
+                lkeys[i] = keys[i];
+            }
+            batch_ints(results[0], keys, num_keys, arr, n);
+            batch_floor_ints(results[1], keys, num_keys, arr, n);
+            batch_lower_bound_ints(results[2], keys, num_keys, arr, n);
+            batch_upper_bound_cmp(results[3], keys, num_keys, arr, n, compare_int);
+            batch_upper_bound_key(results[4], lkeys, num_keys, arr, n);
+            for( int i=0; i<num_keys; i++ ) {
+                if(results[0][i] != first_ints(keys+i, arr, n) ||
+                   results[1][i] != floor_ints(keys+i, arr, n) ||
+                   results[2][i] != lower_bound_ints(keys+i, arr, n) ||
+                   results[3][i] != upper_bound_ints(keys+i, arr, n) ||
+                   results[4][i] != upper_bound_key(lkeys+i, arr, n)) {
+                    if(failures++ < 10)
+                        printf( "fail(bsearch_batch): n=%d num_keys=%d key=%d\n", n, num_keys, keys[i] );
+                }
+            }
+        }
+    }
+    if(!failures)
+        printf( "success(bsearch_batch): every result matches macro_bsearch\n" );
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "the-macro-library/macro_bsearch.h"
+
+/* Checks every branchless bsearch flavor against the branchy one over sorted arrays
+   of every size up to 200 (with duplicates).  branchless_core is checked against
+   first since it always returns the first of several equal elements. */
+
+static inline
+int compare_int(const int *a, const int *b) {
+    return (*a > *b) - (*a < *b);
+}
+
+static inline
+int compare_key(const long *a, const int *b) {
+    return (*a > *b) - (*a < *b);
+}
+
+typedef int *(*search_t)(const int *key, const int *base, size_t n);
+
+macro_bsearch_first(first_ints, int, compare_int);
+macro_bsearch_last(last_ints, int, compare_int);
+macro_bsearch_floor(floor_ints, int, compare_int);
+macro_bsearch_ceiling(ceiling_ints, int, compare_int);
+macro_bsearch_lower_bound(lower_bound_ints, int, compare_int);
+macro_bsearch_upper_bound(upper_bound_ints, int, compare_int);
+
+_macro_bsearch(bl_core_ints, branchless_core, cmp_no_arg, int, compare_int);
+_macro_bsearch(bl_first_ints, branchless_first, cmp_no_arg, int, compare_int);
+_macro_bsearch(bl_last_ints, branchless_last, cmp_no_arg, int, compare_int);
+_macro_bsearch(bl_floor_ints, branchless_floor, cmp_no_arg, int, compare_int);
+_macro_bsearch(bl_ceiling_ints, branchless_ceiling, cmp_no_arg, int, compare_int);
+_macro_bsearch(bl_lower_bound_ints, branchless_lower_bound, cmp_no_arg, int, compare_int);
+_macro_bsearch(bl_upper_bound_ints, branchless_upper_bound, cmp_no_arg, int, compare_int);
+
+macro_bsearch_lower_bound_kv(lower_bound_key, long, int, compare_key);
+_macro_bsearch_kv(bl_lower_bound_key, branchless_lower_bound, cmp_no_arg, long, int, compare_key);
+macro_bsearch_last_kv(last_key, long, int, compare_key);
+_macro_bsearch_kv(bl_last_key, branchless_last, cmp_no_arg, long, int, compare_key);
+
+#define MAX_N 200
+
+static int arr[MAX_N];
+
+int main() {
+    const char *names[] = { "core", "first", "last", "floor", "ceiling", "lower_bound", "upper_bound" };
+    search_t expected[] = { first_ints, first_ints, last_ints, floor_ints, ceiling_ints,
+                            lower_bound_ints, upper_bound_ints };
+    search_t branchless[] = { bl_core_ints, bl_first_ints, bl_last_ints, bl_floor_ints,
+                              bl_ceiling_ints, bl_lower_bound_ints, bl_upper_bound_ints };
+    int failures = 0;
+    srand(1);
+    for( int n=0; n<=MAX_N; n++ ) {
+        int value = 0;
+        for( int i=0; i<n; i++ ) {
+            value += rand() % 3;
+            arr[i] = value;
+        }
+        for( int key=-1; key<=value+1; key++ ) {
+            long lkey = key;
+            for( int s=0; s<7; s++ ) {
+                if(branchless[s](&key, arr, n) != expected[s](&key, arr, n)) {
+                    if(failures++ < 10)
+                        printf( "fail(branchless_%s): n=%d key=%d\n", names[s], n, key );
+                }
+            }
+            if(bl_lower_bound_key(&lkey, arr, n) != lower_bound_key(&lkey, arr, n) ||
+               bl_last_key(&lkey, arr, n) != last_key(&lkey, arr, n)) {
+                if(failures++ < 10)
+                    printf( "fail(branchless kv): n=%d key=%d\n", n, key );
+            }
+        }
+    }
+    if(!failures)
+        printf( "success(bsearch_branchless): every flavor matches the branchy search\n" );
+    return failures ? 1 : 0;
+}
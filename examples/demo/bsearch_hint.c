@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "the-macro-library/macro_bsearch_hint.h"
+
+/* Checks the hinted searches from every hint and the cursor searches for ascending,
+   descending and random keys against macro_bsearch_lower_bound / upper_bound. */
+
+static inline
+int compare_int(const int *a, const int *b) {
+    return (*a > *b) - (*a < *b);
+}
+
+static inline
+int compare_key(const long *a, const int *b) {
+    return (*a > *b) - (*a < *b);
+}
+
+macro_bsearch_lower_bound(lower_bound_ints, int, compare_int);
+macro_bsearch_upper_bound(upper_bound_ints, int, compare_int);
+
+macro_bsearch_lower_bound_hint(lower_bound_hint, int, compare_int);
+macro_bsearch_upper_bound_hint(upper_bound_hint, int, compare_int);
+macro_bsearch_lower_bound_hint_kv(lower_bound_hint_kv, long, int, compare_key);
+macro_bsearch_lower_bound_cursor(lower_bound_cursor, int, compare_int);
+macro_bsearch_upper_bound_cursor(upper_bound_cursor, int, compare_int);
+macro_bsearch_upper_bound_cursor_kv(upper_bound_cursor_kv, long, int, compare_key);
+
+#define MAX_N 150
+
+static int arr[MAX_N];
+
+int main() {
+    int failures = 0;
+    srand(1);
+    for( int n=0; n<=MAX_N; n++ ) {
+        int value = 0;
+        macro_bsearch_cursor_t lower_cursor, upper_cursor, kv_cursor;
+        for( int i=0; i<n; i++ ) {
+            value += rand() % 3;
+            arr[i] = value;
+        }
+        for( int key=-1; key<=value+1; key++ ) {
+            long lkey = key;
+            int *lower = lower_bound_ints(&key, arr, n), *upper = upper_bound_ints(&key, arr, n);
+            for( int hint=0; hint<=n; hint++ ) {
+                if(lower_bound_hint(&key, arr, n, hint) != lower ||
+                   upper_bound_hint(&key, arr, n, hint) != upper ||
+                   lower_bound_hint_kv(&lkey, arr, n, hint) != lower) {
+                    if(failures++ < 10)
+                        printf( "fail(bsearch_hint): n=%d key=%d hint=%d\n", n, key, hint );
+                }
+            }
+        }
+
+        macro_bsearch_cursor_init(&lower_cursor, arr, n);
+        macro_bsearch_cursor_init(&upper_cursor, arr, n);
+        macro_bsearch_cursor_init(&kv_cursor, arr, n);
+        /* ascending, descending, then random keys */
+        for( int i=0; i<3*(value+3); i++ ) {
+            int key = i <= value+2 ? i - 1 : i < 2*(value+3) ? 2*(value+3) - i - 2 : rand() % (value+3) - 1;
+            long lkey = key;
+            if(lower_bound_cursor(&lower_cursor, &key) != lower_bound_ints(&key, arr, n) ||
+               upper_bound_cursor(&upper_cursor, &key) != upper_bound_ints(&key, arr, n) ||
+               upper_bound_cursor_kv(&kv_cursor, &lkey) != upper_bound_ints(&key, arr, n)) {
+                if(failures++ < 10)
+                    printf( "fail(bsearch_cursor): n=%d key=%d\n", n, key );
+            }
+        }
+    }
+    if(!failures)
+        printf( "success(bsearch_hint): hinted and cursor searches match macro_bsearch\n" );
+    return failures ? 1 : 0;
+}
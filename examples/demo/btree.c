@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "the-macro-library/macro_btree.h"
+
+/* Inserts and erases random keys and checks the B-tree against an array of flags
+   which records which keys are present.  After each round every find style is
+   checked for every key. */
+
+static inline
+int compare_int(const int *a, const int *b) {
+    return (*a > *b) - (*a < *b);
+}
+
+static inline
+int compare_key(const long *a, const int *b) {
+    return (*a > *b) - (*a < *b);
+}
+
+macro_btree_insert(insert_int, int, compare_int);
+macro_btree_erase(erase_int, int, compare_int);
+macro_btree_erase_kv(erase_key, long, int, compare_key);
+macro_btree_find(find_int, int, compare_int);
+_macro_btree(floor_int, floor, macro_btree_default(), int, compare_int);
+_macro_btree(ceiling_int, ceiling, macro_btree_default(), int, compare_int);
+_macro_btree(lower_bound_int, lower_bound, macro_btree_default(), int, compare_int);
+_macro_btree(upper_bound_int, upper_bound, macro_btree_default(), int, compare_int);
+macro_btree_find_kv(find_key, long, int, compare_key);
+
+#define RANGE 5000
+
+static bool present[RANGE];
+
+/* the value of r, or -1 for NULL */
+static int value(const int *r) {
+    return r ? *r : -1;
+}
+
+/* the first present key at or after k (stepping by dir), or -1 */
+static int scan(int k, int dir) {
+    while(k >= 0 && k < RANGE && !present[k])
+        k += dir;
+    return k >= 0 && k < RANGE ? k : -1;
+}
+
+int main() {
+    macro_btree_t t;
+    size_t size = 0;
+    int failures = 0;
+    macro_btree_init(&t);
+    srand(1);
+    /* grow, churn, then shrink to empty */
+    for( int round=0; round<6; round++ ) {
+        for( int i=0; i<RANGE; i++ ) {
+            int k = rand() % RANGE;
+            long lk = k;
+            bool erase = round < 2 ? rand() % 4 == 0 : round < 4 ? rand() & 1 : true;
+            bool r = erase ? (round & 1 ? erase_key(&t, &lk) : erase_int(&t, &k)) : insert_int(&t, &k);
+            if(r != (erase ? present[k] : !present[k])) {
+                if(failures++ < 10)
+                    printf( "fail(btree): %s %d returned %d\n", erase ? "erase" : "insert", k, r );
+            }
+            if(r)
+                size += erase ? -1 : 1;
+            present[k] = !erase;
+        }
+        if(round == 5) {
+            for( int k=0; k<RANGE; k++ )
+                if(present[k] && erase_int(&t, &k))
+                    size--, present[k] = false;
+        }
+        if(macro_btree_size(&t) != size) {
+            printf( "fail(btree): size %lu, expected %lu\n", (unsigned long)macro_btree_size(&t), (unsigned long)size );
+            failures++;
+        }
+        for( int k=-1; k<=RANGE; k++ ) {
+            long lk = k;
+            int found = k >= 0 && k < RANGE && present[k] ? k : -1;
+            int floor = k < 0 ? -1 : scan(k < RANGE ? k : RANGE - 1, -1);
+            int ceiling = k >= RANGE ? -1 : scan(k < 0 ? 0 : k, 1);
+            int upper = k + 1 >= RANGE ? -1 : scan(k + 1 < 0 ? 0 : k + 1, 1);
+            if(value(find_int(&t, &k)) != found || value(find_key(&t, &lk)) != found ||
+               value(floor_int(&t, &k)) != floor || value(ceiling_int(&t, &k)) != ceiling ||
+               value(lower_bound_int(&t, &k)) != ceiling || value(upper_bound_int(&t, &k)) != upper) {
+                if(failures++ < 10)
+                    printf( "fail(btree): round %d key %d\n", round, k );
+            }
+        }
+    }
+    if(!failures)
+        printf( "success(btree): inserts, erases and every find style match\n" );
+    macro_btree_destroy(&t);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "the-macro-library/macro_cmp_fields.h"
+#include "the-macro-library/macro_sort.h"
+
+/* Compares macro_cmp_fields(item, item_t, (key, asc), (key2, desc), (name, asc, strcmp),
+   (id, asc)) against the same comparison written as a chain of if statements. */
+
+typedef struct {
+    int key;
+    unsigned char key2;
+    const char *name;
+    long id;
+} item_t;
+
+macro_cmp_fields(item, item_t, (key, asc), (key2, desc), (name, asc, strcmp), (id, asc));
+
+static int compare_items(const item_t *a, const item_t *b) {
+    int n;
+    if(a->key != b->key)
+        return a->key < b->key ? -1 : 1;
+    if(a->key2 != b->key2)
+        return a->key2 > b->key2 ? -1 : 1;
+    n = strcmp(a->name, b->name);
+    if(n)
+        return n < 0 ? -1 : 1;
+    if(a->id != b->id)
+        return a->id < b->id ? -1 : 1;
+    return 0;
+}
+
+_macro_sort(sort_items, less_no_arg, item_t, item_less);
+
+#define NUM_ITEMS 2000
+
+static item_t items[NUM_ITEMS];
+
+int main() {
+    const char *names[] = { "", "a", "ab", "b" };
+    int failures = 0;
+
+    srand(1);
+    for( int i=0; i<NUM_ITEMS; i++ ) {
+        items[i].key = rand() % 5 - 2;
+        items[i].key2 = (unsigned char)(rand() % 3 + 254 * (rand() & 1));
+        items[i].name = names[rand() % 4];
+        items[i].id = rand() % 3;
+    }
+
+    /* every pair of a sample against every item */
+    for( int i=0; i<NUM_ITEMS; i+=13 ) {
+        for( int j=0; j<NUM_ITEMS; j++ ) {
+            int expected = compare_items(items+i, items+j);
+            if(item_cmp(items+i, items+j) != expected ||
+               item_less(items+i, items+j) != (expected < 0) ||
+               item_cmp_arg(items+i, items+j, NULL) != expected ||
+               item_arg_less(NULL, items+i, items+j) != (expected < 0)) {
+                if(failures++ < 10)
+                    printf( "fail(macro_cmp_fields): items %d and %d expected %d\n", i, j, expected );
+            }
+        }
+    }
+    if(!failures)
+        printf( "success(macro_cmp_fields): matches the if chain\n" );
+
+    sort_items(items, NUM_ITEMS);
+    for( int i=1; i<NUM_ITEMS; i++ ) {
+        if(compare_items(items+i-1, items+i) > 0) {
+            printf( "fail(sort with item_less): position %d is out of order\n", i );
+            return 1;
+        }
+    }
+    printf( "success(sort with item_less): %d items in order\n", NUM_ITEMS );
+    return failures ? 1 : 0;
+}
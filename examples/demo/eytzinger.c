@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "the-macro-library/macro_eytzinger.h"
+
+/* Builds Eytzinger arrays of every size up to 300 (with duplicate keys) and checks
+   the lookups against a linear scan of the sorted array (eytz[0] is not used).  Each element records its
+   position in the sorted array, so the checks can tell duplicates apart. */
+
+typedef struct {
+    int key;
+    int pos;
+} elem_t;
+
+static inline
+int compare_elem(const elem_t *a, const elem_t *b) {
+    return (a->key > b->key) - (a->key < b->key);
+}
+
+static inline
+int compare_key(const int *a, const elem_t *b) {
+    return (*a > b->key) - (*a < b->key);
+}
+
+macro_eytzinger_build(build_elems, elem_t);
+macro_eytzinger(find_elem, elem_t, compare_elem);
+macro_eytzinger_lower_bound(lower_bound_elem, elem_t, compare_elem);
+macro_eytzinger_upper_bound(upper_bound_elem, elem_t, compare_elem);
+macro_eytzinger_lower_bound_kv(lower_bound_key, int, elem_t, compare_key);
+macro_eytzinger_upper_bound_compare(upper_bound_cmp, elem_t);
+
+#define MAX_N 300
+
+static elem_t sorted[MAX_N], eytz[MAX_N + 1];
+
+/* the position of the result in the sorted array, or n for NULL */
+static int position(const elem_t *r, int n) {
+    return r ? r->pos : n;
+}
+
+int main() {
+    int failures = 0;
+    srand(1);
+    for( int n=0; n<=MAX_N; n++ ) {
+        int key = 0;
+        for( int i=0; i<n; i++ ) {
+            key += rand() % 3;
+            sorted[i].key = key;
+            sorted[i].pos = i;
+        }
+        build_elems(eytz, sorted, n);
+        for( int k=-1; k<=key+1; k++ ) {
+            elem_t e = { k, -1 };
+            int lower = 0, upper;
+            while(lower < n && sorted[lower].key < k)
+                lower++;
+            upper = lower;
+            while(upper < n && sorted[upper].key == k)
+                upper++;
+            if(position(lower_bound_elem(&e, eytz, n), n) != lower ||
+               position(lower_bound_key(&k, eytz, n), n) != lower ||
+               position(upper_bound_elem(&e, eytz, n), n) != upper ||
+               position(upper_bound_cmp(&e, eytz, n, compare_elem), n) != upper ||
+               position(find_elem(&e, eytz, n), n) != (upper > lower ? lower : n)) {
+                if(failures++ < 10)
+                    printf( "fail(eytzinger): n=%d key=%d expected [%d, %d)\n", n, k, lower, upper );
+            }
+        }
+    }
+    if(!failures)
+        printf( "success(eytzinger): find, lower_bound and upper_bound match a linear scan\n" );
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,145 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "the-macro-library/macro_hash_map.h"
+
+/* Makes random inserts, erases and finds against an array of expected values, then
+   checks that iterating the table visits every element once and erases some of them
+   with macro_hash_map_erase_at on the way.  The second table uses a hash with only a
+   few values, so that nearly every lookup has to probe past other elements. */
+
+#define RANGE 20000
+#define OPS 200000
+
+typedef struct {
+    int key;
+    int value;
+} item_t;
+
+static inline
+uint64_t hash_key(const int *key) {
+    return (uint64_t)*key;
+}
+
+static inline
+uint64_t hash_item(const item_t *item) {
+    return (uint64_t)item->key;
+}
+
+static inline
+uint64_t bad_hash_key(const int *key) {
+    return (uint64_t)(*key % 13);
+}
+
+static inline
+uint64_t bad_hash_item(const item_t *item) {
+    return (uint64_t)(item->key % 13);
+}
+
+static inline
+int compare_item(const item_t *a, const item_t *b) {
+    return (a->key > b->key) - (a->key < b->key);
+}
+
+static inline
+int compare_key(const int *a, const item_t *b) {
+    return (*a > b->key) - (*a < b->key);
+}
+
+macro_hash_map_insert(insert_item, item_t, hash_item, compare_item);
+macro_hash_map_find_kv(find_item, int, item_t, hash_key, compare_key);
+macro_hash_map_erase_kv(erase_item, int, item_t, hash_key, compare_key);
+
+macro_hash_map_insert(bad_insert_item, item_t, bad_hash_item, compare_item);
+macro_hash_map_find_kv(bad_find_item, int, item_t, bad_hash_key, compare_key);
+macro_hash_map_erase_kv(bad_erase_item, int, item_t, bad_hash_key, compare_key);
+
+typedef struct {
+    const char *name;
+    bool (*insert)(macro_hash_map_t *h, const item_t *item);
+    item_t *(*find)(const macro_hash_map_t *h, const int *key);
+    bool (*erase)(macro_hash_map_t *h, const int *key);
+    int range;
+} table_fns_t;
+
+/* 0 means the key is absent, otherwise the value is expected - 1 */
+static int expected[RANGE];
+static int visits[RANGE]; /* -1 for each element, +1 for each visit */
+
+static int check(const table_fns_t *t) {
+    macro_hash_map_t table;
+    int failures = 0, num = 0;
+
+    srand(1);
+    memset(expected, 0, sizeof(expected));
+    macro_hash_map_init(&table);
+    for( int i=0; i<OPS; i++ ) {
+        int key = rand() % t->range;
+        int op = rand() % 4;
+        if(op < 2) {
+            item_t item = { key, rand() % 1000 };
+            bool done = t->insert(&table, &item);
+            if(done != !expected[key] && failures++ < 10)
+                printf( "fail(%s): insert %d returned %d\n", t->name, key, done );
+            if(done) {
+                expected[key] = item.value + 1;
+                num++;
+            }
+        }
+        else if(op == 2) {
+            bool done = t->erase(&table, &key);
+            if(done != !!expected[key] && failures++ < 10)
+                printf( "fail(%s): erase %d returned %d\n", t->name, key, done );
+            if(done)
+                num--;
+            expected[key] = 0;
+        }
+        else {
+            item_t *r = t->find(&table, &key);
+            if((r ? r->key != key || r->value + 1 != expected[key] : expected[key] != 0) &&
+               failures++ < 10)
+                printf( "fail(%s): find %d\n", t->name, key );
+        }
+        if(macro_hash_map_size(&table) != (size_t)num && failures++ < 10)
+            printf( "fail(%s): size is %lu, expected %d\n", t->name,
+                    (unsigned long)macro_hash_map_size(&table), num );
+    }
+
+    /* every element once, erasing the odd keys on the way */
+    for( int key=0; key<t->range; key++ )
+        visits[key] = expected[key] ? -1 : 0;
+    for( size_t i=macro_hash_map_next(&table, 0); i<table.capacity; i=macro_hash_map_next(&table, i+1) ) {
+        item_t *e = macro_hash_map_slot(&table, item_t, i);
+        visits[e->key]++;
+        if(e->value + 1 != expected[e->key] && failures++ < 10)
+            printf( "fail(%s): slot %lu holds a wrong value\n", t->name, (unsigned long)i );
+        if(e->key & 1) {
+            expected[e->key] = 0;
+            macro_hash_map_erase_at(&table, i);
+        }
+    }
+    for( int key=0; key<t->range; key++ ) {
+        if(visits[key] && failures++ < 10)
+            printf( "fail(%s): key %d was visited the wrong number of times\n", t->name, key );
+        item_t *r = t->find(&table, &key);
+        if((r ? !expected[key] || r->value + 1 != expected[key] : expected[key] != 0) && failures++ < 10)
+            printf( "fail(%s): find %d after erase_at\n", t->name, key );
+    }
+    macro_hash_map_destroy(&table);
+    if(!failures)
+        printf( "success(%s): %d operations match the expected values\n", t->name, OPS );
+    return failures;
+}
+
+int main() {
+    table_fns_t tables[] = {
+        { "hash_map", insert_item, find_item, erase_item, RANGE },
+        { "hash_map collisions", bad_insert_item, bad_find_item, bad_erase_item, 2000 }
+    };
+    int failures = 0;
+    for( size_t i=0; i<sizeof(tables)/sizeof(tables[0]); i++ )
+        failures += check(tables + i);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "the-macro-library/macro_bsearch.h"
+#include "the-macro-library/macro_isearch.h"
+
+/* Checks isearch and the learned index against macro_bsearch_lower_bound for evenly
+   spread, clustered and duplicate heavy keys (uint64_t, int32_t and double). */
+
+#define cmp_values(type)                                                \
+    static inline int compare_ ## type(const type *a, const type *b) {  \
+        return (*a > *b) - (*a < *b);                                   \
+    }
+
+typedef double f64_t;
+
+cmp_values(uint64_t)
+cmp_values(int32_t)
+cmp_values(f64_t)
+
+macro_bsearch_lower_bound(lower_bound_u64, uint64_t, compare_uint64_t);
+macro_bsearch_lower_bound(lower_bound_i32, int32_t, compare_int32_t);
+macro_bsearch_lower_bound(lower_bound_f64, f64_t, compare_f64_t);
+
+macro_isearch(isearch_u64, uint64_t);
+macro_isearch(isearch_i32, int32_t);
+macro_isearch(isearch_f64, f64_t);
+
+macro_learned_index_t(u64_index_t, uint64_t);
+macro_learned_index_build(u64_index_build, uint64_t, u64_index_t);
+macro_learned_index_lower_bound(u64_index_lower_bound, uint64_t, u64_index_t);
+
+macro_learned_index_t(f64_index_t, f64_t);
+macro_learned_index_build(f64_index_build, f64_t, f64_index_t);
+macro_learned_index_lower_bound(f64_index_lower_bound, f64_t, f64_index_t);
+
+#define MAX_N 20000
+
+static uint64_t u64[MAX_N];
+static int32_t i32[MAX_N];
+static f64_t f64[MAX_N];
+
+static int failures = 0;
+
+static void fail(const char *test_name, int shape, size_t n, double key) {
+    if(failures++ < 10)
+        printf( "fail(%s): shape=%d n=%lu key=%g\n", test_name, shape, (unsigned long)n, key );
+}
+
+int main() {
+    const size_t sizes[] = { 0, 1, 2, 3, 100, MAX_N };
+    const size_t max_errors[] = { 1, 4, 32 };
+    srand(1);
+    for( int s=0; s<(int)(sizeof(sizes)/sizeof(sizes[0])); s++ ) {
+        size_t n = sizes[s];
+        /* evenly spread, clustered (squares), and few unique */
+        for( int shape=0; shape<3; shape++ ) {
+            uint64_t uv = 0;
+            int32_t iv = -1000000;
+            for( size_t i=0; i<n; i++ ) {
+                uint64_t step = shape == 0 ? (uint64_t)(rand() % 100) :
+                                shape == 1 ? (uint64_t)i * i * (rand() % 3) : (uint64_t)(rand() % 500 == 0);
+                uv += step;
+                iv += (int32_t)(step % 1000);
+                u64[i] = uv;
+                i32[i] = iv;
+                f64[i] = (double)uv / 3.0 - 100.0;
+            }
+            for( int e=0; e<3; e++ ) {
+                u64_index_t ui;
+                f64_index_t fi;
+                if(!u64_index_build(&ui, u64, n, max_errors[e]) || !f64_index_build(&fi, f64, n, max_errors[e])) {
+                    printf( "fail(learned_index): build failed\n" );
+                    return 1;
+                }
+                for( size_t i=0; i<n+2; i++ ) {
+                    /* each key and the value just above it, and keys before and after the array */
+                    uint64_t ukey = i < n ? u64[i] + (i & 1) : i == n ? 0 : uv + 1;
+                    f64_t fkey = i < n ? f64[i] + (double)(i & 1) / 8.0 : i == n ? -1e9 : 1e18;
+                    if(u64_index_lower_bound(&ui, &ukey) != lower_bound_u64(&ukey, u64, n))
+                        fail("learned_index uint64_t", shape, n, (double)ukey);
+                    if(f64_index_lower_bound(&fi, &fkey) != lower_bound_f64(&fkey, f64, n))
+                        fail("learned_index double", shape, n, fkey);
+                    if(e)
+                        continue;
+                    int32_t ikey = i < n ? i32[i] - (int32_t)(i & 1) : i == n ? INT32_MIN : INT32_MAX;
+                    if(isearch_u64(&ukey, u64, n) != lower_bound_u64(&ukey, u64, n))
+                        fail("isearch uint64_t", shape, n, (double)ukey);
+                    if(isearch_i32(&ikey, i32, n) != lower_bound_i32(&ikey, i32, n))
+                        fail("isearch int32_t", shape, n, ikey);
+                    if(isearch_f64(&fkey, f64, n) != lower_bound_f64(&fkey, f64, n))
+                        fail("isearch double", shape, n, fkey);
+                }
+                macro_learned_index_destroy(&ui);
+                macro_learned_index_destroy(&fi);
+            }
+        }
+    }
+    if(!failures)
+        printf( "success(isearch): isearch and the learned index match macro_bsearch_lower_bound\n" );
+    return failures ? 1 : 0;
+}
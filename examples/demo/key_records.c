@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+
+#include "the-macro-library/macro_key.h"
+
+/* Encodes (key asc, key2 desc, f asc, name asc) with the macro_key_put functions and
+   checks that sorting the encoded keys with memcmp (and with the radix sort) gives the
+   same order as comparing the fields one after the other. */
+
+typedef struct {
+    int32_t key;
+    int16_t key2;
+    float f;
+    char name[6];
+} item_t;
+
+enum { item_key_size = 4 + 2 + 4 + 6 };
+
+typedef struct {
+    unsigned char key[item_key_size];
+    uint32_t index;
+} item_rec_t;
+
+static void encode_item(unsigned char *dest, const item_t *src) {
+    unsigned char *p = macro_key_put_i32(dest, src->key);
+    p = macro_key_put_i16(p, src->key2);
+    macro_key_invert(p - 2, 2);
+    p = macro_key_put_f32(p, src->f);
+    macro_key_put_str(p, src->name, sizeof(src->name));
+}
+
+static int compare_items(const item_t *a, const item_t *b) {
+    int n;
+    if(a->key != b->key)
+        return a->key < b->key ? -1 : 1;
+    if(a->key2 != b->key2)
+        return a->key2 > b->key2 ? -1 : 1;
+    if(a->f != b->f)
+        return a->f < b->f ? -1 : 1;
+    n = strncmp(a->name, b->name, sizeof(a->name));
+    return n < 0 ? -1 : n > 0;
+}
+
+macro_key_sort(sort_recs, item_rec_t, key);
+macro_key_radix_sort(radix_sort_recs, item_rec_t, key);
+macro_key_bsearch(lower_bound_rec, lower_bound, item_rec_t, key);
+
+#define NUM_ITEMS 1000
+
+static item_t items[NUM_ITEMS];
+static item_rec_t recs[NUM_ITEMS], radix_recs[NUM_ITEMS];
+
+static int check_order(const char *test_name, const item_rec_t *r) {
+    for( int i=1; i<NUM_ITEMS; i++ ) {
+        if(compare_items(items + r[i-1].index, items + r[i].index) > 0) {
+            printf( "fail(%s): position %d is out of order\n", test_name, i );
+            return 1;
+        }
+    }
+    printf( "success(%s): %d records in order\n", test_name, NUM_ITEMS );
+    return 0;
+}
+
+/* the radix sort is stable, so records with equal keys must stay in index order */
+static int check_stable(const char *test_name, int n) {
+    item_rec_t *r = radix_recs;
+    for( int i=0; i<n; i++ ) {
+        item_t item = { rand() % 3, 0, 0.0f, "" };
+        encode_item(r[i].key, &item);
+        r[i].index = i;
+    }
+    radix_sort_recs(r, n);
+    for( int i=1; i<n; i++ ) {
+        int c = memcmp(r[i-1].key, r[i].key, item_key_size);
+        if(c > 0 || (c == 0 && r[i-1].index > r[i].index)) {
+            printf( "fail(%s): n=%d position %d is out of order\n", test_name, n, i );
+            return 1;
+        }
+    }
+    printf( "success(%s): n=%d equal keys kept their order\n", test_name, n );
+    return 0;
+}
+
+int main() {
+    const char *names[] = { "", "a", "ab", "abcdef", "b", "zz" };
+    int failures = 0;
+
+    srand(1);
+    for( int i=0; i<NUM_ITEMS; i++ ) {
+        items[i].key = rand() % 20 - 10;
+        items[i].key2 = (int16_t)(rand() % 7 - 3);
+        items[i].f = (float)(rand() % 9 - 4) / 2.0f;
+        strncpy(items[i].name, names[rand() % 6], sizeof(items[i].name));
+        encode_item(recs[i].key, items + i);
+        recs[i].index = i;
+    }
+    memcpy(radix_recs, recs, sizeof(recs));
+
+    sort_recs(recs, NUM_ITEMS);
+    failures += check_order("macro_key_sort", recs);
+    radix_sort_recs(radix_recs, NUM_ITEMS);
+    failures += check_order("macro_key_radix_sort", radix_recs);
+    failures += check_stable("macro_key_radix_sort stable", 100);
+    failures += check_stable("macro_key_radix_sort stable", NUM_ITEMS);
+
+    /* lower_bound on the encoded key versus a linear scan with the field comparison */
+    for( int i=0; i<NUM_ITEMS; i+=37 ) {
+        unsigned char key[item_key_size];
+        int expected = 0;
+        encode_item(key, items + i);
+        while(expected < NUM_ITEMS && compare_items(items + recs[expected].index, items + i) < 0)
+            expected++;
+        item_rec_t *r = lower_bound_rec(key, recs, NUM_ITEMS);
+        if(!r || r - recs != expected) {
+            printf( "fail(macro_key_bsearch): item %d expected at %d\n", i, expected );
+            failures++;
+        }
+    }
+    if(!failures)
+        printf( "success(macro_key_bsearch)\n" );
+    return failures ? 1 : 0;
+}
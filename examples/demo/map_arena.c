@@ -0,0 +1,116 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "the-macro-library/macro_map_arena.h"
+#include "the-macro-library/macro_string_id_map.h"
+
+/* Builds a string to id map out of arena nodes and checks it against a sorted array of
+   the same strings.  The tree is then freed back to the arena and rebuilt, which must
+   reuse the free lists instead of allocating new blocks. */
+
+#define NUM_KEYS 5000
+
+static char keys[NUM_KEYS][40];
+static const char *sorted[NUM_KEYS];
+
+static int compare_strings(const void *a, const void *b) {
+    return strcmp(*(const char **)a, *(const char **)b);
+}
+
+static size_t count_blocks(const macro_map_arena_t *a) {
+    size_t n = 0;
+    for( macro_map_arena_block_t *b = a->blocks; b; b = b->next )
+        n++;
+    return n;
+}
+
+static int build(macro_map_arena_t *arena, macro_map_t **root) {
+    *root = NULL;
+    for( size_t i=0; i<NUM_KEYS; i++ ) {
+        size_t len = strlen(keys[i]);
+        macro_string_id_map_t *node = (macro_string_id_map_t *)
+            macro_map_arena_alloc_key(arena, sizeof(*node), keys[i], len);
+        if(!node || ((size_t)node & 15)) {
+            printf( "fail(map_arena): allocation %lu is NULL or not 16 byte aligned\n", (unsigned long)i );
+            return 1;
+        }
+        node->id = i;
+        _macro_string_id_insert(root, node);
+    }
+    return 0;
+}
+
+static int check(const char *test_name, macro_map_t *root) {
+    size_t i = 0;
+    for( macro_map_t *n = macro_map_first(root); n; n = macro_map_next(n), i++ ) {
+        macro_string_id_map_t *node = (macro_string_id_map_t *)n;
+        if(i >= NUM_KEYS || strcmp((const char *)(node + 1), sorted[i]) ||
+           strcmp(keys[node->id], sorted[i])) {
+            printf( "fail(%s): node %lu doesn't match the sorted keys\n", test_name, (unsigned long)i );
+            return 1;
+        }
+    }
+    for( size_t j=0; j<NUM_KEYS; j+=7 ) {
+        if(macro_string_id_find(root, keys[j]) != j) {
+            printf( "fail(%s): %s not found\n", test_name, keys[j] );
+            return 1;
+        }
+    }
+    if(i != NUM_KEYS) {
+        printf( "fail(%s): %lu nodes, expected %d\n", test_name, (unsigned long)i, NUM_KEYS );
+        return 1;
+    }
+    printf( "success(%s): %d nodes match the sorted keys\n", test_name, NUM_KEYS );
+    return 0;
+}
+
+int main() {
+    macro_map_arena_t arena;
+    macro_map_t *root;
+    size_t blocks;
+    int failures = 0;
+
+    srand(1);
+    for( size_t i=0; i<NUM_KEYS; i++ ) {
+        /* unique keys of 1 to 38 characters */
+        int len = snprintf(keys[i], sizeof(keys[i]), "%lu", (unsigned long)i);
+        int extra = rand() % (int)(sizeof(keys[i]) - 1 - len);
+        for( int j=0; j<extra; j++ )
+            keys[i][len + j] = 'a' + rand() % 26;
+        keys[i][len + extra] = 0;
+        sorted[i] = keys[i];
+    }
+    qsort(sorted, NUM_KEYS, sizeof(sorted[0]), compare_strings);
+
+    macro_map_arena_init(&arena, 4096);
+    if(build(&arena, &root))
+        return 1;
+    failures += check("map_arena", root);
+    blocks = count_blocks(&arena);
+
+    macro_map_arena_free_tree(&arena, root, macro_string_id_map_size, NULL);
+    if(build(&arena, &root))
+        return 1;
+    failures += check("map_arena rebuilt from the free lists", root);
+    if(count_blocks(&arena) != blocks) {
+        printf( "fail(map_arena): %lu blocks after the rebuild, expected %lu\n",
+                (unsigned long)count_blocks(&arena), (unsigned long)blocks );
+        failures++;
+    }
+
+    /* a large allocation gets its own block and doesn't disturb the current one */
+    {
+        char *big = (char *)macro_map_arena_alloc(&arena, MACRO_MAP_ARENA_MAX * 4);
+        if(!big)
+            failures++;
+        else
+            memset(big, 0xff, MACRO_MAP_ARENA_MAX * 4);
+        failures += check("map_arena after a large allocation", root);
+    }
+
+    macro_map_arena_destroy(&arena);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,98 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "the-macro-library/macro_map.h"
+
+/* Builds trees of every size up to 600 from a sorted array and from a sorted list and
+   checks the red black rules, the parent pointers and the order of the nodes.  Each
+   tree then has nodes erased and inserted to check that the balancing code accepts it. */
+
+typedef struct {
+    macro_map_t node;
+    long value;
+} int_node;
+
+static inline
+int compare_int(const int_node *a, const int_node *b) {
+    return (a->value > b->value) - (a->value < b->value);
+}
+
+macro_map_insert(insert_int, int_node, compare_int);
+
+#define MAX_N 600
+
+static int_node nodes[MAX_N + 50];
+static macro_map_t *ptrs[MAX_N];
+
+/* returns the black height, or -1 if a rule is broken */
+static int black_height(const macro_map_t *n, const macro_map_t *parent) {
+    int l, r;
+    if(!n)
+        return 1;
+    if(_macro_map_parent(n) != parent)
+        return -1;
+    if(_macro_map_is_red(n) && ((n->left && _macro_map_is_red(n->left)) ||
+                                (n->right && _macro_map_is_red(n->right))))
+        return -1;
+    l = black_height(n->left, n);
+    r = black_height(n->right, n);
+    if(l < 0 || l != r)
+        return -1;
+    return l + !_macro_map_is_red(n);
+}
+
+/* the tree must hold the values in [0, n) except the ones in (lo, hi] */
+static bool valid(macro_map_t *root, int n, int lo, int hi) {
+    macro_map_t *p = macro_map_first(root);
+    if(root && _macro_map_is_red(root))
+        return false;
+    if(black_height(root, NULL) < 0)
+        return false;
+    for( int i=0; i<n; i++ ) {
+        if(i > lo && i <= hi)
+            continue;
+        if(!p || ((int_node *)p)->value != i)
+            return false;
+        p = macro_map_next(p);
+    }
+    return p == NULL;
+}
+
+int main() {
+    int failures = 0;
+    for( int n=0; n<=MAX_N; n++ ) {
+        for( int from_list=0; from_list<2; from_list++ ) {
+            macro_map_t *root;
+            for( int i=0; i<n; i++ ) {
+                nodes[i].value = i;
+                ptrs[i] = &nodes[i].node;
+                nodes[i].node.right = i + 1 < n ? &nodes[i+1].node : NULL;
+            }
+            root = from_list ? macro_map_build_sorted_list(n ? ptrs[0] : NULL) : macro_map_build_sorted(ptrs, n);
+            if(!valid(root, n, -1, -1)) {
+                if(failures++ < 10)
+                    printf( "fail(map_build_sorted%s): n=%d\n", from_list ? "_list" : "", n );
+                continue;
+            }
+            /* erase a range from the middle and insert it again */
+            for( int i=n/3; i<n/3+20 && i<n; i++ )
+                macro_map_erase(&root, &nodes[i].node);
+            if(!valid(root, n, n/3 - 1, n/3 + 19)) {
+                if(failures++ < 10)
+                    printf( "fail(map_build_sorted%s): n=%d after erasing\n", from_list ? "_list" : "", n );
+                continue;
+            }
+            for( int i=n/3; i<n/3+20 && i<n; i++ )
+                insert_int(&root, nodes + i);
+            if(!valid(root, n, -1, -1)) {
+                if(failures++ < 10)
+                    printf( "fail(map_build_sorted%s): n=%d after inserting\n", from_list ? "_list" : "", n );
+            }
+        }
+    }
+    if(!failures)
+        printf( "success(map_build_sorted): trees up to %d nodes are valid red black trees\n", MAX_N );
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,99 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <pthread.h>
+
+#include "the-macro-library/macro_map_concurrent.h"
+
+/* Readers search the map while a writer keeps erasing and inserting the odd keys.  The
+   even keys are never erased, so every reader must always find them.  Build with
+   -DTHREAD_SANITIZER=ON to check the demo under -fsanitize=thread. */
+
+#define NUM_KEYS 1024
+#define NUM_READERS 4
+#define NUM_WRITES 20000
+
+typedef struct {
+    macro_map_t node;
+    int value;
+} int_node;
+
+static inline
+int compare_int(const int_node *a, const int_node *b) {
+    return a->value - b->value;
+}
+
+static inline
+int compare_key(const int *a, const int_node *b) {
+    return *a - b->value;
+}
+
+static inline
+macro_map_insert(insert_int, int_node, compare_int);
+
+macro_map_concurrent_insert(concurrent_insert_int, int_node, insert_int);
+macro_map_concurrent_find_kv(concurrent_find_int, int, int_node, compare_key);
+
+static int_node nodes[NUM_KEYS];
+static macro_map_concurrent_t map;
+static int done = 0;
+
+static void *reader(void *arg) {
+    size_t *failures = (size_t *)arg;
+    int i = 0;
+    while(!__atomic_load_n(&done, __ATOMIC_ACQUIRE)) {
+        int key = i % (NUM_KEYS + 8) - 4;
+        int_node *r = concurrent_find_int(&map, &key);
+        if(key < 0 || key >= NUM_KEYS) {
+            if(r)
+                (*failures)++;
+        }
+        else if(r ? r->value != key : !(key & 1))
+            (*failures)++;
+        i += 7;
+    }
+    return NULL;
+}
+
+int main() {
+    pthread_t threads[NUM_READERS];
+    size_t failures[NUM_READERS];
+    size_t total = 0;
+    int i;
+
+    macro_map_concurrent_init(&map);
+    for( i=0; i<NUM_KEYS; i++ ) {
+        nodes[i].value = i;
+        concurrent_insert_int(&map, nodes+i);
+    }
+
+    for( i=0; i<NUM_READERS; i++ ) {
+        failures[i] = 0;
+        pthread_create(threads+i, NULL, reader, failures+i);
+    }
+
+    /* erased nodes are only reused by the writer, which is safe here because they
+       stay in the array for as long as the readers run */
+    for( i=0; i<NUM_WRITES; i++ ) {
+        int_node *n = nodes + ((i * 37) % NUM_KEYS | 1);
+        macro_map_concurrent_erase(&map, &n->node);
+        concurrent_insert_int(&map, n);
+    }
+
+    __atomic_store_n(&done, 1, __ATOMIC_RELEASE);
+    for( i=0; i<NUM_READERS; i++ ) {
+        pthread_join(threads[i], NULL);
+        total += failures[i];
+    }
+
+    for( i=0; i<NUM_KEYS; i++ ) {
+        if(concurrent_find_int(&map, &i) != nodes+i)
+            total++;
+    }
+    if(total)
+        printf( "fail(map_concurrent): %lu lookups returned the wrong node\n", (unsigned long)total );
+    else
+        printf( "success(map_concurrent): %d readers during %d writes\n", NUM_READERS, NUM_WRITES * 2 );
+    macro_map_concurrent_destroy(&map);
+    return total ? 1 : 0;
+}
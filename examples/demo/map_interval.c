@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "the-macro-library/macro_map_interval.h"
+
+/* Inserts random intervals (with repeated ones), erases some of them, and checks that
+   the overlaps of random points and ranges found with first and next are exactly the
+   ones found by scanning every interval, each once and in order of start. */
+
+#define NUM_INTERVALS 2000
+#define NUM_QUERIES 3000
+#define RANGE 10000
+
+typedef struct {
+    macro_map_t node;
+    long max_end;
+    long start, end;
+} interval_t;
+
+macro_map_interval_update(interval_update, interval_t, end, max_end);
+macro_map_interval_insert(interval_insert, interval_t, start, interval_update);
+macro_map_interval_first(interval_first, interval_t, long, start, end, max_end);
+macro_map_interval_next(interval_next, interval_t, long, start, end, max_end);
+
+static interval_t intervals[NUM_INTERVALS];
+static bool present[NUM_INTERVALS];
+static int seen[NUM_INTERVALS];
+
+/* returns the number of overlaps found, or -1 if one is wrong */
+static int query(const macro_map_t *root, long lo, long hi, int stamp) {
+    int found = 0;
+    long last = -1;
+    for( interval_t *r = interval_first(root, lo, hi); r; r = interval_next(r, lo, hi) ) {
+        int i = (int)(r - intervals);
+        if(!present[i] || seen[i] == stamp || r->start > hi || r->end < lo || r->start < last)
+            return -1;
+        seen[i] = stamp;
+        last = r->start;
+        found++;
+    }
+    return found;
+}
+
+int main() {
+    macro_map_t *root = NULL;
+    int failures = 0;
+
+    srand(1);
+    for( int i=0; i<NUM_INTERVALS; i++ ) {
+        if(i && rand() % 10 == 0)
+            intervals[i] = intervals[rand() % i];
+        else {
+            intervals[i].start = rand() % RANGE;
+            intervals[i].end = intervals[i].start + (rand() % 8 ? rand() % 20 : rand() % 2000);
+        }
+        if(!interval_insert(&root, intervals + i) && failures++ < 10)
+            printf( "fail(macro_map_interval_insert): interval %d\n", i );
+        present[i] = true;
+    }
+    if(interval_insert(&root, intervals) && failures++ < 10)
+        printf( "fail(macro_map_interval_insert): a node in the tree was inserted again\n" );
+
+    for( int i=0; i<NUM_INTERVALS; i+=3 ) {
+        macro_map_interval_erase(&root, &intervals[i].node, interval_update);
+        present[i] = false;
+    }
+
+    for( int q=0; q<NUM_QUERIES; q++ ) {
+        long lo = rand() % (RANGE + 2100) - 50;
+        long hi = q & 1 ? lo : lo + rand() % 100;
+        int expected = 0;
+        for( int i=0; i<NUM_INTERVALS; i++ )
+            if(present[i] && intervals[i].start <= hi && intervals[i].end >= lo)
+                expected++;
+        int found = query(root, lo, hi, q + 1);
+        if(found != expected && failures++ < 10)
+            printf( "fail(macro_map_interval): [%ld, %ld] found %d, expected %d\n", lo, hi, found, expected );
+    }
+    if(!failures)
+        printf( "success(macro_map_interval): %d queries match a scan of the intervals\n", NUM_QUERIES );
+    return failures ? 1 : 0;
+}
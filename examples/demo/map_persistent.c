@@ -0,0 +1,151 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "the-macro-library/macro_map_persistent.h"
+
+/* Makes random inserts and erases while a snapshot taken before them is held open, and
+   checks that the snapshot still holds exactly the keys it had, that the current tree
+   matches a set of flags and keeps the red black rules, and that every node copied or
+   retired along the way is freed by the end. */
+
+#define RANGE 2000
+#define ROUNDS 8
+#define WRITES 500
+
+typedef struct {
+    macro_map_t node;
+    int value;
+} int_node;
+
+static inline
+int compare_int(const int_node *a, const int_node *b) {
+    return (a->value > b->value) - (a->value < b->value);
+}
+
+static inline
+int compare_key(const int *a, const int_node *b) {
+    return (*a > b->value) - (*a < b->value);
+}
+
+macro_map_persistent_insert(insert_int, int_node, compare_int);
+macro_map_persistent_erase_kv(erase_int, int, int_node, compare_key);
+macro_map_find_kv(find_int, int, int_node, compare_key);
+
+static int live = 0;
+
+static int_node *new_node(int value) {
+    int_node *n = (int_node *)malloc(sizeof(int_node));
+    n->value = value;
+    live++;
+    return n;
+}
+
+static macro_map_t *copy_node(macro_map_t *n, void *arg) {
+    (void)arg;
+    return &new_node(((int_node *)n)->value)->node;
+}
+
+static void free_node(macro_map_t *n, void *arg) {
+    (void)arg;
+    live--;
+    free(n);
+}
+
+/* returns the black height, or -1 if a rule is broken */
+static int black_height(const macro_map_t *n) {
+    int l, r;
+    if(!n)
+        return 1;
+    if(_macro_map_persistent_is_red(n->right))
+        return -1;
+    if(_macro_map_persistent_is_red(n) && _macro_map_persistent_is_red(n->left))
+        return -1;
+    l = black_height(n->left);
+    r = black_height(n->right);
+    if(l < 0 || l != r)
+        return -1;
+    return l + !_macro_map_persistent_is_red(n);
+}
+
+/* macro_map_next uses the parent, which the persistent tree doesn't keep */
+static bool walk(const macro_map_t *n, const bool *flags, int *next) {
+    if(!n)
+        return true;
+    if(!walk(n->left, flags, next))
+        return false;
+    while(*next < RANGE && !flags[*next])
+        (*next)++;
+    if(*next >= RANGE || ((const int_node *)n)->value != *next)
+        return false;
+    (*next)++;
+    return walk(n->right, flags, next);
+}
+
+static bool matches(macro_map_t *root, const bool *flags) {
+    int next = 0;
+    if(!walk(root, flags, &next))
+        return false;
+    while(next < RANGE && !flags[next])
+        next++;
+    if(next < RANGE)
+        return false;
+    for( int i=0; i<RANGE; i++ ) {
+        int_node *r = find_int(root, &i);
+        if(flags[i] ? !r || r->value != i : r != NULL)
+            return false;
+    }
+    return true;
+}
+
+static bool present[RANGE], snapshot[RANGE];
+
+int main() {
+    macro_map_persistent_t map;
+    int failures = 0;
+
+    srand(1);
+    macro_map_persistent_init(&map, 1, copy_node, free_node, NULL);
+    for( int round=0; round<ROUNDS; round++ ) {
+        macro_map_t *root = macro_map_persistent_read_begin(&map, 0);
+        memcpy(snapshot, present, sizeof(present));
+
+        for( int i=0; i<WRITES; i++ ) {
+            int key = rand() % RANGE;
+            bool done;
+            if(rand() % 3) {
+                int_node *n = new_node(key);
+                done = insert_int(&map, n);
+                if(!done)
+                    free_node(&n->node, NULL);
+                if(done == present[key] && failures++ < 10)
+                    printf( "fail(map_persistent): insert %d returned %d\n", key, done );
+                present[key] = true;
+            }
+            else {
+                done = erase_int(&map, &key);
+                if(done != present[key] && failures++ < 10)
+                    printf( "fail(map_persistent): erase %d returned %d\n", key, done );
+                present[key] = false;
+            }
+        }
+
+        if(!matches(root, snapshot) && failures++ < 10)
+            printf( "fail(map_persistent): the snapshot changed in round %d\n", round );
+        macro_map_persistent_read_end(&map, 0);
+
+        root = macro_map_persistent_read_begin(&map, 0);
+        if((!matches(root, present) || _macro_map_persistent_is_red(root) || black_height(root) < 0) &&
+           failures++ < 10)
+            printf( "fail(map_persistent): the tree is wrong after round %d\n", round );
+        macro_map_persistent_read_end(&map, 0);
+    }
+
+    macro_map_persistent_destroy(&map);
+    if(live && failures++ < 10)
+        printf( "fail(map_persistent): %d nodes were not freed\n", live );
+    if(!failures)
+        printf( "success(map_persistent): %d rounds of %d writes under an open snapshot\n", ROUNDS, WRITES );
+    return failures ? 1 : 0;
+}
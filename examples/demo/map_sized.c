@@ -0,0 +1,108 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "the-macro-library/macro_map_sized.h"
+
+/* Makes random inserts and erases and checks macro_map_select, macro_map_rank_of and
+   the rank function against the sorted list of keys kept in a set of flags, along with
+   the size stored in every node. */
+
+#define RANGE 3000
+#define ROUNDS 6
+
+typedef struct {
+    macro_map_sized_t node;
+    int value;
+} int_node;
+
+static inline
+int compare_int(const int_node *a, const int_node *b) {
+    return (a->value > b->value) - (a->value < b->value);
+}
+
+static inline
+int compare_key(const int *a, const int_node *b) {
+    return (*a > b->value) - (*a < b->value);
+}
+
+macro_map_sized_insert(insert_int, int_node, compare_int);
+macro_map_rank_kv(rank_int, int, int_node, compare_key);
+macro_map_find_kv(find_int, int, int_node, compare_key);
+
+static int_node nodes[RANGE];
+static bool present[RANGE];
+static int sorted[RANGE];
+
+/* returns the size of the subtree, or -1 if a stored size is wrong */
+static long check_sizes(const macro_map_t *n) {
+    long l, r;
+    if(!n)
+        return 0;
+    l = check_sizes(n->left);
+    r = check_sizes(n->right);
+    if(l < 0 || r < 0 || (size_t)(l + r + 1) != macro_map_size_of(n))
+        return -1;
+    return l + r + 1;
+}
+
+int main() {
+    macro_map_t *root = NULL;
+    int failures = 0;
+
+    srand(1);
+    for( int i=0; i<RANGE; i++ )
+        nodes[i].value = i;
+
+    for( int round=0; round<ROUNDS; round++ ) {
+        for( int i=0; i<RANGE; i++ ) {
+            int key = rand() % RANGE;
+            if(rand() % 3) {
+                if(!present[key])
+                    insert_int(&root, nodes + key);
+                present[key] = true;
+            }
+            else {
+                if(present[key])
+                    macro_map_sized_erase(&root, &nodes[key].node.node);
+                present[key] = false;
+            }
+        }
+
+        int num = 0;
+        for( int i=0; i<RANGE; i++ )
+            if(present[i])
+                sorted[num++] = i;
+
+        if(check_sizes(root) != num && failures++ < 10)
+            printf( "fail(map_sized): the subtree sizes are wrong in round %d\n", round );
+
+        for( int k=0; k<=num; k++ ) {
+            int_node *r = (int_node *)macro_map_select(root, k);
+            if((k < num ? !r || r->value != sorted[k] : r != NULL) && failures++ < 10)
+                printf( "fail(macro_map_select): k=%d in round %d\n", k, round );
+            if(r && macro_map_rank_of(&r->node.node) != (size_t)k && failures++ < 10)
+                printf( "fail(macro_map_rank_of): k=%d in round %d\n", k, round );
+        }
+
+        /* rank_int counts the keys less than key, present or not */
+        for( int key=-1, less=0; key<=RANGE; key++ ) {
+            if(rank_int(root, &key) != (size_t)less && failures++ < 10)
+                printf( "fail(macro_map_rank): key=%d in round %d\n", key, round );
+            if(key >= 0 && key < RANGE && present[key])
+                less++;
+        }
+    }
+
+    for( int i=0; i<RANGE; i++ ) {
+        int_node *r = find_int(root, &i);
+        if(r ? r != nodes + i || !present[i] : present[i]) {
+            if(failures++ < 10)
+                printf( "fail(map_sized): find %d\n", i );
+        }
+    }
+    if(!failures)
+        printf( "success(map_sized): select and rank match the sorted keys\n" );
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "the-macro-library/macro_merge_sort.h"
+
+/* Sorts records by key with the merge sort and checks that the result is the stable
+   order (qsort by key and then by original position).  The comparisons are counted
+   and compared with macro_sort's. */
+
+typedef struct {
+    int key;
+    int pos;
+} rec_t;
+
+static size_t comparisons = 0;
+
+static inline
+bool less_rec(const rec_t *a, const rec_t *b) {
+    comparisons++;
+    return a->key < b->key;
+}
+
+static int qsort_compare_rec(const void *p1, const void *p2) {
+    const rec_t *a = (const rec_t *)p1, *b = (const rec_t *)p2;
+    if(a->key != b->key)
+        return a->key < b->key ? -1 : 1;
+    return (a->pos > b->pos) - (a->pos < b->pos);
+}
+
+macro_merge_sort(merge_sort_recs, rec_t, less_rec);
+macro_sort(sort_recs, rec_t, less_rec);
+
+#define MAX_N 20000
+
+static rec_t arr[MAX_N], copy[MAX_N], expected[MAX_N];
+
+static int test_sort(const char *test_name, int n, int range, int sorted_pct) {
+    size_t merge_comparisons;
+    for( int i=0; i<n; i++ ) {
+        arr[i].key = rand() % 100 < sorted_pct ? i : rand() % range;
+        arr[i].pos = i;
+    }
+    memcpy(copy, arr, n * sizeof(rec_t));
+    memcpy(expected, arr, n * sizeof(rec_t));
+    qsort(expected, n, sizeof(rec_t), qsort_compare_rec);
+
+    comparisons = 0;
+    merge_sort_recs(arr, n);
+    merge_comparisons = comparisons;
+    if(memcmp(arr, expected, n * sizeof(rec_t))) {
+        printf( "fail(%s): n=%d is not the stable order\n", test_name, n );
+        return 1;
+    }
+    comparisons = 0;
+    sort_recs(copy, n);
+    printf( "success(%s): n=%d stable with %lu comparisons (macro_sort %lu)\n", test_name, n,
+            (unsigned long)merge_comparisons, (unsigned long)comparisons );
+    return 0;
+}
+
+int main() {
+    int failures = 0;
+    srand(1);
+    failures += test_sort("merge_sort", 0, 10, 0);
+    failures += test_sort("merge_sort", 1, 10, 0);
+    failures += test_sort("merge_sort", 20, 10, 0);
+    failures += test_sort("merge_sort", MAX_N, 1000000, 0);
+    failures += test_sort("merge_sort duplicates", MAX_N, 8, 0);
+    failures += test_sort("merge_sort mostly sorted", MAX_N, MAX_N, 95);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,124 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "the-macro-library/macro_record_file.h"
+
+/* Writes record files with several fence spacings, checks each search style against
+   macro_bsearch over the same records in memory, and checks that files with a wrong
+   record size or a truncated body are rejected. */
+
+typedef struct {
+    uint32_t id;
+    uint32_t value;
+} record_t;
+
+static inline
+int compare_records(const record_t *a, const record_t *b) {
+    return (a->id > b->id) - (a->id < b->id);
+}
+
+static inline
+int compare_id(const uint32_t *a, const record_t *b) {
+    return (*a > b->id) - (*a < b->id);
+}
+
+typedef record_t *(*search_t)(const record_t *key, const record_t *base, size_t n);
+typedef record_t *(*file_search_t)(const macro_record_file_t *f, const record_t *key);
+
+macro_bsearch_first(first_mem, record_t, compare_records);
+macro_bsearch_last(last_mem, record_t, compare_records);
+macro_bsearch_floor(floor_mem, record_t, compare_records);
+macro_bsearch_ceiling(ceiling_mem, record_t, compare_records);
+macro_bsearch_lower_bound(lower_bound_mem, record_t, compare_records);
+macro_bsearch_upper_bound(upper_bound_mem, record_t, compare_records);
+macro_bsearch_lower_bound_kv(lower_bound_id_mem, uint32_t, record_t, compare_id);
+
+_macro_record_file(first_file, first, cmp_no_arg, record_t, compare_records);
+_macro_record_file(last_file, last, cmp_no_arg, record_t, compare_records);
+_macro_record_file(floor_file, floor, cmp_no_arg, record_t, compare_records);
+_macro_record_file(ceiling_file, ceiling, cmp_no_arg, record_t, compare_records);
+macro_record_file_lower_bound(lower_bound_file, record_t, compare_records);
+macro_record_file_upper_bound(upper_bound_file, record_t, compare_records);
+macro_record_file_lower_bound_kv(lower_bound_id_file, uint32_t, record_t, compare_id);
+macro_record_file(find_file, record_t, compare_records);
+
+#define MAX_N 2000
+
+static record_t records[MAX_N];
+
+/* the position of r in the mapped records, or -1 for NULL */
+static long file_pos(const macro_record_file_t *f, const record_t *r) {
+    return r ? (long)(r - (const record_t *)f->records) : -1;
+}
+
+static long mem_pos(const record_t *r) {
+    return r ? (long)(r - records) : -1;
+}
+
+int main() {
+    const char *names[] = { "first", "last", "floor", "ceiling", "lower_bound", "upper_bound" };
+    search_t mem[] = { first_mem, last_mem, floor_mem, ceiling_mem, lower_bound_mem, upper_bound_mem };
+    file_search_t file[] = { first_file, last_file, floor_file, ceiling_file, lower_bound_file, upper_bound_file };
+    const size_t sizes[] = { 0, 1, 2, 63, 64, 65, MAX_N };
+    const size_t fence_every[] = { 1, 3, 64, 5000 };
+    char filename[64];
+    int failures = 0;
+
+    snprintf(filename, sizeof(filename), "/tmp/record_file_demo_%d.dat", (int)getpid());
+    srand(1);
+    for( int s=0; s<(int)(sizeof(sizes)/sizeof(sizes[0])); s++ ) {
+        size_t n = sizes[s];
+        uint32_t id = 0;
+        for( size_t i=0; i<n; i++ ) {
+            id += rand() % 3;
+            records[i].id = id;
+            records[i].value = (uint32_t)i;
+        }
+        for( int e=0; e<4; e++ ) {
+            macro_record_file_t f;
+            if(!macro_record_file_write(filename, records, n, sizeof(record_t), fence_every[e]) ||
+               !macro_record_file_open(&f, filename, sizeof(record_t))) {
+                printf( "fail(record_file): n=%lu can't write or open %s\n", (unsigned long)n, filename );
+                return 1;
+            }
+            for( uint32_t k=0; k<=id+2; k++ ) {
+                record_t key = { k - 1, 0 };
+                uint32_t kid = k - 1;
+                for( int style=0; style<6; style++ ) {
+                    if(file_pos(&f, file[style](&f, &key)) != mem_pos(mem[style](&key, records, n))) {
+                        if(failures++ < 10)
+                            printf( "fail(record_file %s): n=%lu fence_every=%lu key=%u\n", names[style],
+                                    (unsigned long)n, (unsigned long)fence_every[e], key.id );
+                    }
+                }
+                record_t *r = find_file(&f, &key);
+                if(file_pos(&f, lower_bound_id_file(&f, &kid)) != mem_pos(lower_bound_id_mem(&kid, records, n)) ||
+                   (r ? r->id != key.id : first_mem(&key, records, n) != NULL)) {
+                    if(failures++ < 10)
+                        printf( "fail(record_file): n=%lu fence_every=%lu key=%u\n",
+                                (unsigned long)n, (unsigned long)fence_every[e], key.id );
+                }
+            }
+            macro_record_file_close(&f);
+        }
+    }
+
+    /* the wrong record size, and a file which is cut short */
+    {
+        macro_record_file_t f;
+        if(!macro_record_file_write(filename, records, MAX_N, sizeof(record_t), 64) ||
+           macro_record_file_open(&f, filename, sizeof(record_t) * 2) ||
+           truncate(filename, sizeof(macro_record_file_header_t) + 100) != 0 ||
+           macro_record_file_open(&f, filename, sizeof(record_t))) {
+            printf( "fail(record_file): a bad file was opened\n" );
+            failures++;
+        }
+    }
+    unlink(filename);
+
+    if(!failures)
+        printf( "success(record_file): every style matches macro_bsearch and bad files are rejected\n" );
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "the-macro-library/macro_set_ops.h"
+
+/* Checks intersect, union and difference (balanced and lopsided, so both the merge and
+   the galloping paths run) against a plain merge with std::set_* multiset semantics.
+   Each element records which array it came from, so the checks also see that equal
+   elements are copied from a. */
+
+typedef struct {
+    int key;
+    int from_b;
+} elem_t;
+
+static inline
+bool elem_less(const elem_t *a, const elem_t *b) {
+    return a->key < b->key;
+}
+
+macro_intersect(intersect_elems, elem_t, elem_less);
+macro_union(union_elems, elem_t, elem_less);
+macro_difference(difference_elems, elem_t, elem_less);
+macro_intersect_multi(intersect_many, elem_t, elem_less);
+
+enum { op_intersect, op_union, op_difference };
+
+static size_t reference(int op, elem_t *dest, const elem_t *a, size_t na, const elem_t *b, size_t nb) {
+    size_t i = 0, j = 0, k = 0;
+    while(i < na && j < nb) {
+        if(a[i].key < b[j].key) {
+            if(op != op_intersect)
+                dest[k++] = a[i];
+            i++;
+        }
+        else if(b[j].key < a[i].key) {
+            if(op == op_union)
+                dest[k++] = b[j];
+            j++;
+        }
+        else {
+            if(op != op_difference)
+                dest[k++] = a[i];
+            i++;
+            j++;
+        }
+    }
+    while(op != op_intersect && i < na)
+        dest[k++] = a[i++];
+    while(op == op_union && j < nb)
+        dest[k++] = b[j++];
+    return k;
+}
+
+#define MAX_N 3000
+
+static elem_t a[MAX_N], b[MAX_N], c[MAX_N], result[2 * MAX_N], expected[2 * MAX_N], tmp[MAX_N];
+
+static void fill(elem_t *arr, size_t n, int range, int from_b) {
+    int key = 0;
+    for( size_t i=0; i<n; i++ ) {
+        key += rand() % range;
+        arr[i].key = key;
+        arr[i].from_b = from_b;
+    }
+}
+
+static bool same(const elem_t *x, const elem_t *y, size_t n) {
+    for( size_t i=0; i<n; i++ )
+        if(x[i].key != y[i].key || x[i].from_b != y[i].from_b)
+            return false;
+    return true;
+}
+
+int main() {
+    const size_t sizes[][2] = { {0, 0}, {0, 10}, {10, 0}, {1, 1}, {100, 120}, {10, MAX_N}, {MAX_N, 7}, {MAX_N, MAX_N} };
+    const char *names[] = { "intersect", "union", "difference" };
+    int failures = 0;
+    srand(1);
+    for( int s=0; s<(int)(sizeof(sizes)/sizeof(sizes[0])); s++ ) {
+        size_t na = sizes[s][0], nb = sizes[s][1];
+        /* sparse, and dense with duplicates */
+        for( int range=1; range<=8; range+=7 ) {
+            fill(a, na, na < nb ? range * 300 : range, 0);
+            fill(b, nb, nb < na ? range * 300 : range, 1);
+            for( int op=0; op<3; op++ ) {
+                size_t r = op == op_intersect ? intersect_elems(result, a, na, b, nb) :
+                           op == op_union ? union_elems(result, a, na, b, nb) :
+                           difference_elems(result, a, na, b, nb);
+                size_t e = reference(op, expected, a, na, b, nb);
+                if(r != e || !same(result, expected, r)) {
+                    printf( "fail(%s): na=%lu nb=%lu returned %lu, expected %lu\n", names[op],
+                            (unsigned long)na, (unsigned long)nb, (unsigned long)r, (unsigned long)e );
+                    failures++;
+                }
+            }
+
+            /* three lists, against intersecting them two at a time */
+            {
+                const elem_t *lists[3] = { a, b, c };
+                size_t list_sizes[3] = { na, nb, na / 2 + 3 };
+                size_t e;
+                fill(c, list_sizes[2], range, 2);
+                e = reference(op_intersect, tmp, a, na, b, nb);
+                e = reference(op_intersect, expected, tmp, e, c, list_sizes[2]);
+                size_t r = intersect_many(result, lists, list_sizes, 3), k = 0;
+                /* the elements may be copied from any of the lists, so only the keys are compared */
+                while(k < r && k < e && result[k].key == expected[k].key)
+                    k++;
+                if(r != e || k != r) {
+                    printf( "fail(intersect_multi): na=%lu nb=%lu returned %lu, expected %lu\n",
+                            (unsigned long)na, (unsigned long)nb, (unsigned long)r, (unsigned long)e );
+                    failures++;
+                }
+            }
+        }
+    }
+
+    /* macro_intersect_uint32 over strictly increasing lists */
+    for( int s=0; s<(int)(sizeof(sizes)/sizeof(sizes[0])); s++ ) {
+        static uint32_t ua[MAX_N], ub[MAX_N], ur[MAX_N], ue[MAX_N];
+        size_t na = sizes[s][0], nb = sizes[s][1], r, e = 0, i = 0, j = 0;
+        uint32_t v = 0;
+        for( size_t k=0; k<na; k++ )
+            ua[k] = v += 1 + rand() % (na < nb ? 300 : 3);
+        v = 0;
+        for( size_t k=0; k<nb; k++ )
+            ub[k] = v += 1 + rand() % (nb < na ? 300 : 3);
+        while(i < na && j < nb) {
+            if(ua[i] < ub[j])
+                i++;
+            else if(ub[j] < ua[i])
+                j++;
+            else {
+                ue[e++] = ua[i];
+                i++;
+                j++;
+            }
+        }
+        r = macro_intersect_uint32(ur, ua, na, ub, nb);
+        if(r != e || memcmp(ur, ue, r * sizeof(uint32_t))) {
+            printf( "fail(macro_intersect_uint32): na=%lu nb=%lu returned %lu, expected %lu\n",
+                    (unsigned long)na, (unsigned long)nb, (unsigned long)r, (unsigned long)e );
+            failures++;
+        }
+    }
+
+    if(!failures)
+        printf( "success(set_ops): intersect, union, difference and intersect_multi match a merge\n" );
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* the thresholds are set before the first include, as a header written by
+   bin/macro-autotune.py would be.  These are the smallest values allowed, so the
+   pivot selection and macro_check_sorted paths run on small segments too. */
+#define MACRO_SORT_SMALL 8
+#define MACRO_SORT_NINTHER 24
+#define MACRO_SORT_CHECK_FEW 16
+#define MACRO_SORT_CHECK_SOME 64
+
+#include "the-macro-library/macro_sort.h"
+
+/* Sorts arrays of several sizes and shapes with the overridden thresholds and checks
+   them against qsort. */
+
+static inline
+bool less_int(const int *a, const int *b) {
+    return *a < *b;
+}
+
+static int qsort_compare_int(const void *a, const void *b) {
+    return (*(const int *)a > *(const int *)b) - (*(const int *)a < *(const int *)b);
+}
+
+macro_sort(sort_ints, int, less_int);
+
+#define MAX_N 3000
+
+static int arr[MAX_N], expected[MAX_N];
+
+int main() {
+    const int sizes[] = { 7, 8, 9, 23, 25, 63, 65, 255, 257, MAX_N };
+    int failures = 0;
+    srand(1);
+    for( int s=0; s<(int)(sizeof(sizes)/sizeof(sizes[0])); s++ ) {
+        int n = sizes[s];
+        /* random, few unique, sorted, reversed */
+        for( int shape=0; shape<4; shape++ ) {
+            for( int i=0; i<n; i++ )
+                arr[i] = shape == 0 ? rand() : shape == 1 ? rand() % 3 : shape == 2 ? i : n - i;
+            memcpy(expected, arr, n * sizeof(int));
+            qsort(expected, n, sizeof(int), qsort_compare_int);
+            sort_ints(arr, n);
+            if(memcmp(arr, expected, n * sizeof(int))) {
+                printf( "fail(sort_config): n=%d shape=%d doesn't match qsort\n", n, shape );
+                failures++;
+            }
+        }
+    }
+    if(!failures)
+        printf( "success(sort_config): MACRO_SORT_SMALL=%d MACRO_SORT_NINTHER=%d matches qsort\n",
+                MACRO_SORT_SMALL, MACRO_SORT_NINTHER );
+    return failures ? 1 : 0;
+}
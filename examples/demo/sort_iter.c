@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "the-macro-library/macro_sort_iter.h"
+
+/* Pulls elements from the sorted iterator and checks them (and the sorted prefix that
+   they point into) against qsort. */
+
+static inline
+bool less_int(const int *a, const int *b) {
+    return *a < *b;
+}
+
+static int qsort_compare_int(const void *a, const void *b) {
+    return (*(const int *)a > *(const int *)b) - (*(const int *)a < *(const int *)b);
+}
+
+macro_sort_iter_next(next_int, int, less_int);
+macro_sort_iter_next_compare(next, int);
+
+#define MAX_N 5000
+
+static int arr[MAX_N], expected[MAX_N];
+
+/* takes the first k elements (or all of them if k is n) */
+static int test_iter(const char *test_name, int n, int range, int k, bool use_compare) {
+    macro_sort_iter_t iter;
+    int *p, i = 0;
+    for( int j=0; j<n; j++ )
+        arr[j] = range ? rand() % range : n - j;
+    memcpy(expected, arr, n * sizeof(int));
+    qsort(expected, n, sizeof(int), qsort_compare_int);
+
+    macro_sort_iter_init(&iter, arr, n);
+    while(i < k && (p = use_compare ? next(&iter, less_int) : next_int(&iter)) != NULL) {
+        if(p != arr + i || *p != expected[i]) {
+            printf( "fail(%s): n=%d element %d is %d, expected %d\n", test_name, n, i, *p, expected[i] );
+            return 1;
+        }
+        i++;
+    }
+    if(i != k || (k == n && next_int(&iter) != NULL)) {
+        printf( "fail(%s): n=%d returned %d elements, expected %d\n", test_name, n, i, k );
+        return 1;
+    }
+    if(memcmp(arr, expected, k * sizeof(int))) {
+        printf( "fail(%s): n=%d the first %d elements are not sorted\n", test_name, n, k );
+        return 1;
+    }
+    printf( "success(%s): n=%d first %d elements match qsort\n", test_name, n, k );
+    return 0;
+}
+
+int main() {
+    int failures = 0;
+    srand(1);
+    failures += test_iter("sort_iter", 0, 10, 0, false);
+    failures += test_iter("sort_iter", 1, 10, 1, false);
+    failures += test_iter("sort_iter", 10, 10, 10, false);
+    failures += test_iter("sort_iter", MAX_N, 1000000, 10, false);
+    failures += test_iter("sort_iter", MAX_N, 1000000, MAX_N, false);
+    failures += test_iter("sort_iter duplicates", MAX_N, 4, MAX_N, false);
+    failures += test_iter("sort_iter reversed", MAX_N, 0, MAX_N, false);
+    failures += test_iter("sort_iter_compare", MAX_N, 1000000, 100, true);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "the-macro-library/macro_sort_resumable.h"
+
+/* Sorts arrays a few comparisons at a time and checks the result against qsort. */
+
+static inline
+bool less_int(const int *a, const int *b) {
+    return *a < *b;
+}
+
+static int qsort_compare_int(const void *a, const void *b) {
+    return (*(const int *)a > *(const int *)b) - (*(const int *)a < *(const int *)b);
+}
+
+macro_sort_resumable(sort_ints_step, int, less_int);
+macro_sort_resumable_compare(sort_step, int);
+
+#define MAX_N 5000
+
+static int arr[MAX_N], expected[MAX_N];
+
+static int test_sort(const char *test_name, int n, int range, size_t budget_comparisons, bool use_compare) {
+    macro_sort_state_t state;
+    int steps = 1;
+    for( int i=0; i<n; i++ )
+        arr[i] = range ? rand() % range : n - i;
+    memcpy(expected, arr, n * sizeof(int));
+    qsort(expected, n, sizeof(int), qsort_compare_int);
+
+    macro_sort_state_init(&state, arr, n);
+    while(use_compare ? !sort_step(&state, 0, budget_comparisons, less_int)
+                    : !sort_ints_step(&state, 0, budget_comparisons)) {
+        if(++steps > n * 100) {
+            printf( "fail(%s): n=%d did not finish\n", test_name, n );
+            return 1;
+        }
+    }
+    if(memcmp(arr, expected, n * sizeof(int))) {
+        printf( "fail(%s): n=%d doesn't match qsort\n", test_name, n );
+        return 1;
+    }
+    printf( "success(%s): n=%d sorted in %d steps\n", test_name, n, steps );
+    return 0;
+}
+
+int main() {
+    int failures = 0;
+    srand(1);
+    failures += test_sort("sort_resumable", 0, 10, 50, false);
+    failures += test_sort("sort_resumable", 1, 10, 50, false);
+    failures += test_sort("sort_resumable", 10, 10, 50, false);
+    failures += test_sort("sort_resumable", MAX_N, 1000000, 50, false);
+    failures += test_sort("sort_resumable duplicates", MAX_N, 4, 50, false);
+    failures += test_sort("sort_resumable reversed", MAX_N, 0, 1, false);
+    failures += test_sort("sort_resumable unlimited", MAX_N, 1000000, 0, false);
+    failures += test_sort("sort_resumable_compare", MAX_N, 1000000, 50, true);
+    return failures ? 1 : 0;
+}
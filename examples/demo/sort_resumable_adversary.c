@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "the-macro-library/macro_sort_resumable.h"
+
+/* Sorts inputs which defeat the pivot selection and checks that the resumable sort
+   falls back to the heap sort, so that the number of comparisons stays O(n log n).
+   The first input is the median of 3 killer sequence, and the second is built while
+   sorting by McIlroy's adversary (which answers each comparison so that the pivots
+   are as bad as possible for whatever pivot selection the sort uses). */
+
+#define N 20000
+
+static int arr[N], val[N], expected[N];
+static size_t cmps = 0;
+
+/* the adversary */
+static int gas, num_solid, candidate;
+
+static inline
+bool less_adversary(const int *a, const int *b) {
+    int x = *a, y = *b;
+    cmps++;
+    if(val[x] == gas && val[y] == gas)
+        val[x == candidate ? x : y] = num_solid++;
+    if(val[x] == gas)
+        candidate = x;
+    else if(val[y] == gas)
+        candidate = y;
+    return val[x] < val[y];
+}
+
+static inline
+bool less_int(const int *a, const int *b) {
+    cmps++;
+    return *a < *b;
+}
+
+static int qsort_compare_int(const void *a, const void *b) {
+    return (*(const int *)a > *(const int *)b) - (*(const int *)a < *(const int *)b);
+}
+
+macro_sort_resumable(sort_adversary_step, int, less_adversary);
+macro_sort_resumable(sort_ints_step, int, less_int);
+
+/* the comparisons allowed are a small multiple of n log2 n */
+static size_t limit(int n) {
+    size_t log_n = 0;
+    while((1 << log_n) < n)
+        log_n++;
+    return (size_t)n * log_n * 8;
+}
+
+static int check(const char *test_name, const int *expected, int n) {
+    if(memcmp(arr, expected, n * sizeof(int))) {
+        printf( "fail(%s): the array isn't sorted\n", test_name );
+        return 1;
+    }
+    if(cmps > limit(n)) {
+        printf( "fail(%s): %lu comparisons is more than %lu\n", test_name,
+                (unsigned long)cmps, (unsigned long)limit(n) );
+        return 1;
+    }
+    printf( "success(%s): n=%d sorted with %lu comparisons\n", test_name, n, (unsigned long)cmps );
+    return 0;
+}
+
+int main() {
+    macro_sort_state_t state;
+    int failures = 0, k = N / 2;
+
+    /* median of 3 killer */
+    for( int i=1; i<=k; i++ ) {
+        if(i & 1) {
+            arr[i-1] = i;
+            arr[i] = k + i;
+        }
+        arr[k+i-1] = 2 * i;
+    }
+    for( int i=0; i<N; i++ )
+        val[i] = i + 1;
+    cmps = 0;
+    macro_sort_state_init(&state, arr, N);
+    while(!sort_ints_step(&state, 0, 1000))
+        ;
+    failures += check("sort_resumable median of 3 killer", val, N);
+
+    /* McIlroy's adversary sorts the indexes, val holds the input it made up */
+    gas = N;
+    num_solid = 0;
+    candidate = 0;
+    for( int i=0; i<N; i++ ) {
+        arr[i] = i;
+        val[i] = gas;
+    }
+    cmps = 0;
+    macro_sort_state_init(&state, arr, N);
+    while(!sort_adversary_step(&state, 0, 1000))
+        ;
+    for( int i=1; i<N; i++ ) {
+        if(val[arr[i-1]] > val[arr[i]]) {
+            printf( "fail(sort_resumable adversary): position %d is out of order\n", i );
+            return 1;
+        }
+    }
+    if(cmps > limit(N)) {
+        printf( "fail(sort_resumable adversary): %lu comparisons is more than %lu\n",
+                (unsigned long)cmps, (unsigned long)limit(N) );
+        failures++;
+    }
+    else
+        printf( "success(sort_resumable adversary): n=%d sorted with %lu comparisons\n",
+                N, (unsigned long)cmps );
+
+    /* sorting the made up input again must also stay under the limit */
+    for( int i=0; i<N; i++ ) {
+        arr[i] = val[i];
+        expected[i] = val[i];
+    }
+    qsort(expected, N, sizeof(int), qsort_compare_int);
+    cmps = 0;
+    macro_sort_state_init(&state, arr, N);
+    while(!sort_ints_step(&state, 0, 1000))
+        ;
+    failures += check("sort_resumable adversary input", expected, N);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "the-macro-library/macro_sort_soa.h"
+
+/* Sorts a key column with two payload columns and checks every column against a
+   stable qsort of the rows (by key and then by original position). */
+
+typedef struct {
+    uint32_t key;
+    double price;
+    char *label;
+    int pos;
+} row_t;
+
+static inline
+bool less_id(const uint32_t *a, const uint32_t *b) {
+    return *a < *b;
+}
+
+static int qsort_compare_row(const void *p1, const void *p2) {
+    const row_t *a = (const row_t *)p1, *b = (const row_t *)p2;
+    if(a->key != b->key)
+        return a->key < b->key ? -1 : 1;
+    return (a->pos > b->pos) - (a->pos < b->pos);
+}
+
+macro_sort_soa(sort_by_id, uint32_t, less_id, (double, price), (char *, label));
+
+#define MAX_N 10000
+
+static uint32_t keys[MAX_N];
+static double prices[MAX_N];
+static char *labels[MAX_N];
+static char names[MAX_N][8];
+static row_t rows[MAX_N];
+
+static int test_soa(const char *test_name, int n, uint32_t range) {
+    for( int i=0; i<n; i++ ) {
+        keys[i] = (uint32_t)rand() % range;
+        prices[i] = i * 0.5;
+        snprintf(names[i], sizeof(names[i]), "%d", i);
+        labels[i] = names[i];
+        rows[i].key = keys[i];
+        rows[i].price = prices[i];
+        rows[i].label = labels[i];
+        rows[i].pos = i;
+    }
+    qsort(rows, n, sizeof(row_t), qsort_compare_row);
+    if(!sort_by_id(keys, prices, labels, n)) {
+        printf( "fail(%s): n=%d returned false\n", test_name, n );
+        return 1;
+    }
+    for( int i=0; i<n; i++ ) {
+        if(keys[i] != rows[i].key || prices[i] != rows[i].price || labels[i] != rows[i].label) {
+            printf( "fail(%s): n=%d row %d doesn't match the stable order\n", test_name, n, i );
+            return 1;
+        }
+    }
+    printf( "success(%s): n=%d rows match the stable order\n", test_name, n );
+    return 0;
+}
+
+int main() {
+    int failures = 0;
+    srand(1);
+    failures += test_soa("sort_soa", 0, 10);
+    failures += test_soa("sort_soa", 1, 10);
+    failures += test_soa("sort_soa", 50, 10);
+    failures += test_soa("sort_soa", MAX_N, 1000000);
+    failures += test_soa("sort_soa duplicates", MAX_N, 5);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "the-macro-library/macro_stree.h"
+
+/* Builds S-trees of unsigned 32 bit and signed 64 bit keys with sizes around the
+   node boundaries and checks lower_bound and upper_bound against a binary search of
+   the sorted keys.  Build with -DCMAKE_C_FLAGS=-mavx2 to check the AVX2 node search. */
+
+macro_stree_t(u32_stree_t, uint32_t);
+macro_stree_build(u32_stree_build, uint32_t, u32_stree_t);
+macro_stree_lower_bound(u32_stree_lower_bound, uint32_t, u32_stree_t);
+macro_stree_upper_bound(u32_stree_upper_bound, uint32_t, u32_stree_t);
+
+macro_stree_t(i64_stree_t, int64_t);
+macro_stree_build(i64_stree_build, int64_t, i64_stree_t);
+macro_stree_lower_bound(i64_stree_lower_bound, int64_t, i64_stree_t);
+macro_stree_upper_bound(i64_stree_upper_bound, int64_t, i64_stree_t);
+
+#define MAX_N 70000
+
+static uint32_t u32[MAX_N];
+static int64_t i64[MAX_N];
+
+/* the first position where key < arr[i] (or key <= arr[i] if lower) */
+#define reference_bound(arr, n, key, lower, r)                     \
+    {                                                              \
+        size_t lo = 0, hi = n;                                     \
+        while(lo < hi) {                                           \
+            size_t mid = lo + ((hi - lo) >> 1);                    \
+            if(lower ? arr[mid] < key : !(key < arr[mid]))         \
+                lo = mid + 1;                                      \
+            else                                                   \
+                hi = mid;                                          \
+        }                                                          \
+        r = lo;                                                    \
+    }
+
+int main() {
+    const size_t sizes[] = { 0, 1, 15, 16, 17, 136, 255, 256, 257, 4097, MAX_N };
+    int failures = 0;
+    srand(1);
+    for( int s=0; s<(int)(sizeof(sizes)/sizeof(sizes[0])); s++ ) {
+        size_t n = sizes[s];
+        u32_stree_t ut;
+        i64_stree_t it;
+        uint32_t uv = 0;
+        int64_t iv = INT64_MIN;
+        for( size_t i=0; i<n; i++ ) {
+            uv += rand() % 3;
+            u32[i] = uv;
+            iv += (int64_t)(rand() % 3) << 40;
+            i64[i] = i == n-1 ? INT64_MAX : iv;
+        }
+        if(!u32_stree_build(&ut, u32, n) || !i64_stree_build(&it, i64, n)) {
+            printf( "fail(stree): n=%lu build failed\n", (unsigned long)n );
+            return 1;
+        }
+        for( size_t i=0; i<n+2; i++ ) {
+            /* each key, the key just above it, and a key past the end */
+            uint32_t ukey = i < n ? u32[i] + (uint32_t)(i & 1) : i == n ? uv + 1 : 0;
+            int64_t ikey = i < n ? i64[i] - (int64_t)((i & 1) && i64[i] > INT64_MIN) : i == n ? INT64_MIN : INT64_MAX;
+            size_t lower, upper;
+            reference_bound(u32, n, ukey, true, lower);
+            reference_bound(u32, n, ukey, false, upper);
+            if(u32_stree_lower_bound(&ut, ukey) != lower || u32_stree_upper_bound(&ut, ukey) != upper) {
+                if(failures++ < 10)
+                    printf( "fail(stree uint32_t): n=%lu key=%u\n", (unsigned long)n, ukey );
+            }
+            reference_bound(i64, n, ikey, true, lower);
+            reference_bound(i64, n, ikey, false, upper);
+            if(i64_stree_lower_bound(&it, ikey) != lower || i64_stree_upper_bound(&it, ikey) != upper) {
+                if(failures++ < 10)
+                    printf( "fail(stree int64_t): n=%lu key=%lld\n", (unsigned long)n, (long long)ikey );
+            }
+        }
+        macro_stree_destroy(&ut);
+        macro_stree_destroy(&it);
+    }
+    if(!failures)
+        printf( "success(stree): lower_bound and upper_bound match a binary search\n" );
+    return failures ? 1 : 0;
+}
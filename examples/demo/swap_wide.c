@@ -0,0 +1,115 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "the-macro-library/macro_sort.h"
+#include "the-macro-library/src/macro_vecswap.h"
+
+/* Checks macro_block_swap, macro_swap and macro_vecswap against a byte at a time swap
+   for sizes around the block boundaries, and sorts wide elements against qsort. */
+
+typedef struct {
+    int key;
+    unsigned char pad[196];
+} wide_t;
+
+static inline
+bool less_wide(const wide_t *a, const wide_t *b) {
+    return a->key < b->key;
+}
+
+static int qsort_compare_wide(const void *a, const void *b) {
+    int x = ((const wide_t *)a)->key, y = ((const wide_t *)b)->key;
+    return (x > y) - (x < y);
+}
+
+macro_sort(sort_wide, wide_t, less_wide);
+
+static void byte_swap(unsigned char *x, unsigned char *y, size_t len) {
+    for( size_t i=0; i<len; i++ ) {
+        unsigned char t = x[i];
+        x[i] = y[i];
+        y[i] = t;
+    }
+}
+
+#define BUF_SIZE 600
+#define NUM_WIDE 2000
+
+static unsigned char buf[BUF_SIZE], expected[BUF_SIZE];
+static wide_t wide[NUM_WIDE], wide_expected[NUM_WIDE];
+
+static void fill(void) {
+    for( int i=0; i<BUF_SIZE; i++ )
+        buf[i] = (unsigned char)rand();
+    memcpy(expected, buf, BUF_SIZE);
+}
+
+int main() {
+    int failures = 0;
+    srand(1);
+
+    /* the block swap for every length up to 260 bytes at an odd offset */
+    for( size_t len=0; len<=260; len++ ) {
+        fill();
+        macro_block_swap(buf + 3, buf + 300, len);
+        byte_swap(expected + 3, expected + 300, len);
+        if(memcmp(buf, expected, BUF_SIZE)) {
+            printf( "fail(macro_block_swap): len=%lu\n", (unsigned long)len );
+            failures++;
+        }
+    }
+
+    /* macro_swap of one wide element, used as the body of an if without braces */
+    for( int i=0; i<2; i++ ) {
+        wide_t *a = wide, *b = wide + 1, tmp;
+        a->key = 1;
+        b->key = 2;
+        memset(a->pad, 'a', sizeof(a->pad));
+        memset(b->pad, 'b', sizeof(b->pad));
+        if(i)
+            macro_swap(a, b);
+        else
+            a->key = 3;
+        if(i ? a->key != 2 || a->pad[195] != 'b' || b->key != 1 || b->pad[0] != 'a'
+             : a->key != 3 || b->key != 2) {
+            printf( "fail(macro_swap): if/else %d\n", i );
+            failures++;
+        }
+    }
+
+    /* vecswap ranges of ints on either side of MACRO_SWAP_BLOCK_MIN */
+    for( ssize_t n=0; n<=40; n++ ) {
+        int *x = (int *)(buf + 4), *y = (int *)(buf + 300), *tmp_x, *tmp_y, tmp;
+        ssize_t tmp_n = n;
+        fill();
+        macro_vecswap(x, y, tmp_x, tmp_y, tmp_n);
+        byte_swap(expected + 4, expected + 300, n * sizeof(int));
+        if(memcmp(buf, expected, BUF_SIZE) || tmp_n != 0) {
+            printf( "fail(macro_vecswap): n=%ld\n", (long)n );
+            failures++;
+        }
+    }
+
+    for( int i=0; i<NUM_WIDE; i++ ) {
+        wide[i].key = rand() % 500;
+        memset(wide[i].pad, wide[i].key & 0xFF, sizeof(wide[i].pad));
+    }
+    memcpy(wide_expected, wide, sizeof(wide));
+    qsort(wide_expected, NUM_WIDE, sizeof(wide_t), qsort_compare_wide);
+    sort_wide(wide, NUM_WIDE);
+    for( int i=0; i<NUM_WIDE; i++ ) {
+        if(wide[i].key != wide_expected[i].key ||
+           memcmp(wide[i].pad, wide_expected[i].pad, sizeof(wide[i].pad))) {
+            printf( "fail(sort_wide): element %d doesn't match qsort\n", i );
+            failures++;
+            break;
+        }
+    }
+
+    if(!failures)
+        printf( "success(swap_wide): block swap, macro_swap, vecswap and sort match\n" );
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,199 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_bloom_H
+#define _macro_bloom_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "the-macro-library/macro_map.h"
+
+/*
+    A blocked Bloom filter which answers "definitely not present" for most keys that
+    are missing with a single cache line, before paying for a binary search or a tree
+    descent.
+
+    The filter is an array of 64 byte blocks (8 words of 64 bits).  A key's hash picks
+    one block and one bit in each of the 8 words, so adding or testing a key touches
+    exactly one cache line.  With 10 bits per key, about 1% of missing keys get through.
+
+    The filter works with hashes.  The hash function passed to the generators has the
+    form uint64_t hash(const type *p), and the filter wrappers need the same hash for a
+    key and for the element which matches it.  macro_bloom_hash64 and
+    macro_bloom_hash_bytes are provided to build hashes from.
+
+    macro_bloom_build(build_filter, int, hash_int);
+    bool build_filter(macro_bloom_t *f, const int *base, size_t n, size_t bits_per_key);
+
+    macro_bloom_build_map(build_map_filter, node_t, hash_node);
+    bool build_map_filter(macro_bloom_t *f, macro_map_t *root, size_t bits_per_key);
+
+    The filtered searches check the filter before calling an existing exact match
+    search (a macro_bsearch, macro_bsearch_first, macro_bsearch_last or macro_map_find
+    function):
+
+    macro_bloom_bsearch(filtered_bsearch, int, hash_int, bsearch_ints);
+    int *filtered_bsearch(const macro_bloom_t *f, const int *key, const int *base, size_t n);
+
+    macro_bloom_map_find_kv(filtered_find, char, node_t, hash_str, find_node);
+    node_t *filtered_find(const macro_bloom_t *f, const macro_map_t *root, const char *key);
+
+    Elements inserted after the filter is built must be added with macro_bloom_add (a
+    Bloom filter can't remove elements, so rebuild it after many erases).
+*/
+
+typedef struct {
+    uint64_t *blocks;
+    size_t num_blocks;
+} macro_bloom_t;
+
+static inline uint64_t macro_bloom_hash64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+static inline uint64_t macro_bloom_hash_bytes(const void *p, size_t len) {
+    const unsigned char *s = (const unsigned char *)p;
+    uint64_t h = 0xcbf29ce484222325ULL ^ len;
+    uint64_t w;
+    while(len >= 8) {
+        memcpy(&w, s, 8);
+        h = (h ^ macro_bloom_hash64(w)) * 0x100000001b3ULL;
+        s += 8;
+        len -= 8;
+    }
+    w = 0;
+    memcpy(&w, s, len);
+    return macro_bloom_hash64(h ^ w);
+}
+
+static inline bool macro_bloom_init(macro_bloom_t *f, size_t n, size_t bits_per_key) {
+    size_t num_blocks = (n * bits_per_key + 511) / 512;
+    if(!num_blocks)
+        num_blocks = 1;
+    f->blocks = (uint64_t *)aligned_alloc(64, num_blocks * 64);
+    f->num_blocks = 0;
+    if(!f->blocks)
+        return false;
+    memset(f->blocks, 0, num_blocks * 64);
+    f->num_blocks = num_blocks;
+    return true;
+}
+
+static inline void macro_bloom_destroy(macro_bloom_t *f) {
+    free(f->blocks);
+    f->blocks = NULL;
+    f->num_blocks = 0;
+}
+
+/* the upper 32 bits of the hash pick the block, and the lower 32 bits (multiplied by a
+   different odd constant for each word) pick a bit in each word */
+#define __mcro_bloom_block(f, hash)    \
+    ((f)->blocks + 8 * (size_t)((((hash) >> 32) * (uint64_t)(f)->num_blocks) >> 32))
+
+#define __mcro_bloom_bit(hash, salt) (1ULL << (((uint32_t)(hash) * (uint32_t)(salt)) >> 26))
+
+#define __mcro_bloom_words(action, w, hash)               \
+    action(w[0], __mcro_bloom_bit(hash, 0x47b6137bU));    \
+    action(w[1], __mcro_bloom_bit(hash, 0x44974d91U));    \
+    action(w[2], __mcro_bloom_bit(hash, 0x8824ad5bU));    \
+    action(w[3], __mcro_bloom_bit(hash, 0xa2b7289dU));    \
+    action(w[4], __mcro_bloom_bit(hash, 0x705495c7U));    \
+    action(w[5], __mcro_bloom_bit(hash, 0x2df1424bU));    \
+    action(w[6], __mcro_bloom_bit(hash, 0x9efc4947U));    \
+    action(w[7], __mcro_bloom_bit(hash, 0x5c6bfb31U))
+
+#define __mcro_bloom_set(word, bit) word |= (bit)
+#define __mcro_bloom_test(word, bit) r &= (word & (bit)) != 0
+
+static inline void macro_bloom_add(macro_bloom_t *f, uint64_t hash) {
+    uint64_t *w = __mcro_bloom_block(f, hash);
+    __mcro_bloom_words(__mcro_bloom_set, w, hash);
+}
+
+/* false means the key is definitely not in the set */
+static inline bool macro_bloom_may_contain(const macro_bloom_t *f, uint64_t hash) {
+    const uint64_t *w = __mcro_bloom_block(f, hash);
+    int r = 1;
+    __mcro_bloom_words(__mcro_bloom_test, w, hash);
+    return r != 0;
+}
+
+#define macro_bloom_build_h(name, value_type)    \
+    bool name(macro_bloom_t *f, const value_type *base, size_t n, size_t bits_per_key)
+
+#define macro_bloom_build(name, value_type, hash)        \
+    macro_bloom_build_h(name, value_type) {              \
+        size_t i;                                        \
+        if(!macro_bloom_init(f, n, bits_per_key))        \
+            return false;                                \
+        for(i = 0; i < n; i++)                           \
+            macro_bloom_add(f, hash(base + i));          \
+        return true;                                     \
+    }
+
+/* value_type must begin with its macro_map_t */
+#define macro_bloom_build_map_h(name, value_type)    \
+    bool name(macro_bloom_t *f, macro_map_t *root, size_t bits_per_key)
+
+#define macro_bloom_build_map(name, value_type, hash)                          \
+    macro_bloom_build_map_h(name, value_type) {                                \
+        macro_map_t *node;                                                     \
+        size_t n = 0;                                                          \
+        for(node = macro_map_first(root); node; node = macro_map_next(node))   \
+            n++;                                                               \
+        if(!macro_bloom_init(f, n, bits_per_key))                              \
+            return false;                                                      \
+        for(node = macro_map_first(root); node; node = macro_map_next(node))   \
+            macro_bloom_add(f, hash((const value_type *)node));                \
+        return true;                                                           \
+    }
+
+#define macro_bloom_bsearch_h(name, value_type)    \
+    value_type *name(const macro_bloom_t *f, const value_type *key, const value_type *base, size_t n)
+
+#define macro_bloom_bsearch(name, value_type, hash, bsearch)    \
+    macro_bloom_bsearch_h(name, value_type) {                   \
+        if(!macro_bloom_may_contain(f, hash(key)))              \
+            return NULL;                                        \
+        return bsearch(key, base, n);                           \
+    }
+
+#define macro_bloom_bsearch_kv_h(name, key_type, value_type)    \
+    value_type *name(const macro_bloom_t *f, const key_type *key, const value_type *base, size_t n)
+
+#define macro_bloom_bsearch_kv(name, key_type, value_type, hash, bsearch)    \
+    macro_bloom_bsearch_kv_h(name, key_type, value_type) {                   \
+        if(!macro_bloom_may_contain(f, hash(key)))                           \
+            return NULL;                                                     \
+        return bsearch(key, base, n);                                        \
+    }
+
+#define macro_bloom_map_find_h(name, value_type)    \
+    value_type *name(const macro_bloom_t *f, const macro_map_t *root, const value_type *key)
+
+#define macro_bloom_map_find(name, value_type, hash, find)    \
+    macro_bloom_map_find_h(name, value_type) {                \
+        if(!macro_bloom_may_contain(f, hash(key)))            \
+            return NULL;                                      \
+        return find(root, key);                               \
+    }
+
+#define macro_bloom_map_find_kv_h(name, key_type, value_type)    \
+    value_type *name(const macro_bloom_t *f, const macro_map_t *root, const key_type *key)
+
+#define macro_bloom_map_find_kv(name, key_type, value_type, hash, find)    \
+    macro_bloom_map_find_kv_h(name, key_type, value_type) {                \
+        if(!macro_bloom_may_contain(f, hash(key)))                         \
+            return NULL;                                                   \
+        return find(root, key);                                            \
+    }
+
+#endif /* _macro_bloom_H */
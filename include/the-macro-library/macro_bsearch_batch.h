@@ -0,0 +1,118 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_bsearch_batch_H
+#define _macro_bsearch_batch_H
+
+/*
+    Searches one sorted array for many keys at once.  A single binary search over a
+    large array waits on one cache miss per step.  The batched search advances a group
+    of MACRO_BSEARCH_BATCH (default 16) searches in lockstep and prefetches each
+    search's next midpoint, so the misses of the whole group overlap.
+
+    macro_bsearch_batch_lower_bound(lower_bound_ints, int, compare_int);
+
+    void lower_bound_ints(int **results, const int *keys, size_t num_keys,
+                          const int *base, size_t n);
+
+    results[i] is set to what the matching macro_bsearch function returns for keys[i]
+    (use results[i] - base for an index).  The bsearch styles are the same as
+    macro_bsearch's (core, first, last, floor, ceiling, lower_bound, upper_bound),
+    except that core always finds the first of several equal elements.  The kv
+    versions take an array of key_type.
+*/
+
+#include "the-macro-library/macro_bsearch.h"
+#include "the-macro-library/src/macro_bsearch_batch_code.h"
+
+#define _macro_bsearch_batch_h(name, style, value_type)                                \
+    void name(value_type **results, const value_type *keys, size_t num_keys,          \
+              const value_type *base, macro_cmp_signature(size_t n, style, value_type))
+
+#define _macro_bsearch_batch(name, bsearch_style, style, value_type, cmp)             \
+    _macro_bsearch_batch_h(name, style, value_type) {                                 \
+        __macro_bsearch_batch_ ## bsearch_style ## _code(style, value_type, cmp)      \
+    }
+
+#define _macro_bsearch_batch_kv_h(name, style, key_type, value_type)                   \
+    void name(value_type **results, const key_type *keys, size_t num_keys,            \
+              const value_type *base,                                                 \
+              macro_cmp_kv_signature(size_t n, style, key_type, value_type))
+
+#define _macro_bsearch_batch_kv(name, bsearch_style, style, key_type, value_type, cmp)                \
+    _macro_bsearch_batch_kv_h(name, style, key_type, value_type) {                                    \
+        __macro_bsearch_batch_kv_ ## bsearch_style ## _code(style, key_type, value_type, cmp)         \
+    }
+
+#define _macro_bsearch_batch_compare_h(name, style, value_type)    \
+    __macro_bsearch_batch_compare_h(name, style, value_type)
+
+#define __macro_bsearch_batch_compare_h(name, style, value_type)    \
+    _macro_bsearch_batch_h(name, compare_ ## style, value_type)
+
+#define _macro_bsearch_batch_compare(name, bsearch_style, style, value_type)          \
+    _macro_bsearch_batch_compare_h(name, style, value_type) {                         \
+        __macro_bsearch_batch_ ## bsearch_style ## _code(style, value_type, cmp)      \
+    }
+
+#define _macro_bsearch_batch_kv_compare_h(name, style, key_type, value_type)    \
+    __macro_bsearch_batch_kv_compare_h(name, style, key_type, value_type)
+
+#define __macro_bsearch_batch_kv_compare_h(name, style, key_type, value_type)    \
+    _macro_bsearch_batch_kv_h(name, compare_ ## style, key_type, value_type)
+
+#define _macro_bsearch_batch_kv_compare(name, bsearch_style, style, key_type, value_type)             \
+    _macro_bsearch_batch_kv_compare_h(name, style, key_type, value_type) {                            \
+        __macro_bsearch_batch_kv_ ## bsearch_style ## _code(style, key_type, value_type, cmp)         \
+    }
+
+#define macro_bsearch_batch_h(name, value_type)    \
+    _macro_bsearch_batch_h(name, macro_bsearch_default(), value_type )
+
+#define macro_bsearch_batch_compare_h(name, value_type)    \
+    _macro_bsearch_batch_compare_h(name, macro_bsearch_default(), value_type )
+
+#define macro_bsearch_batch(name, value_type, cmp)    \
+    _macro_bsearch_batch(name, core, macro_bsearch_default(), value_type, cmp)
+
+#define macro_bsearch_batch_compare(name, value_type)    \
+    _macro_bsearch_batch_compare(name, core, macro_bsearch_default(), value_type )
+
+#define macro_bsearch_batch_lower_bound(name, value_type, cmp)    \
+    _macro_bsearch_batch(name, lower_bound, macro_bsearch_default(), value_type, cmp)
+
+#define macro_bsearch_batch_lower_bound_compare(name, value_type)    \
+    _macro_bsearch_batch_compare(name, lower_bound, macro_bsearch_default(), value_type )
+
+#define macro_bsearch_batch_upper_bound(name, value_type, cmp)    \
+    _macro_bsearch_batch(name, upper_bound, macro_bsearch_default(), value_type, cmp)
+
+#define macro_bsearch_batch_upper_bound_compare(name, value_type)    \
+    _macro_bsearch_batch_compare(name, upper_bound, macro_bsearch_default(), value_type )
+
+/* kv version (accepts a different type of key) */
+
+#define macro_bsearch_batch_kv_h(name, key_type, value_type)    \
+    _macro_bsearch_batch_kv_h(name, macro_bsearch_default(), key_type, value_type )
+
+#define macro_bsearch_batch_kv_compare_h(name, key_type, value_type)    \
+    _macro_bsearch_batch_kv_compare_h(name, macro_bsearch_default(), key_type, value_type )
+
+#define macro_bsearch_batch_kv(name, key_type, value_type, cmp)    \
+    _macro_bsearch_batch_kv(name, core, macro_bsearch_default(), key_type, value_type, cmp)
+
+#define macro_bsearch_batch_kv_compare(name, key_type, value_type)    \
+    _macro_bsearch_batch_kv_compare(name, core, macro_bsearch_default(), key_type, value_type )
+
+#define macro_bsearch_batch_lower_bound_kv(name, key_type, value_type, cmp)    \
+    _macro_bsearch_batch_kv(name, lower_bound, macro_bsearch_default(), key_type, value_type, cmp)
+
+#define macro_bsearch_batch_lower_bound_kv_compare(name, key_type, value_type)    \
+    _macro_bsearch_batch_kv_compare(name, lower_bound, macro_bsearch_default(), key_type, value_type )
+
+#define macro_bsearch_batch_upper_bound_kv(name, key_type, value_type, cmp)    \
+    _macro_bsearch_batch_kv(name, upper_bound, macro_bsearch_default(), key_type, value_type, cmp)
+
+#define macro_bsearch_batch_upper_bound_kv_compare(name, key_type, value_type)    \
+    _macro_bsearch_batch_kv_compare(name, upper_bound, macro_bsearch_default(), key_type, value_type )
+
+#endif /* _macro_bsearch_batch_H */
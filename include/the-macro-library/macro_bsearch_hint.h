@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_bsearch_hint_H
+#define _macro_bsearch_hint_H
+
+/*
+    lower_bound and upper_bound searches which start from a position instead of the
+    whole range.  They gallop outward from the position and then binary search, so a
+    key which is d elements away costs O(log d) comparisons instead of O(log n).  This
+    suits merge-like scans and other lookups which move forward (or backward) a little
+    at a time.
+
+    macro_bsearch_lower_bound_hint(lower_bound_ints_hint, int, compare_int);
+    int *lower_bound_ints_hint(const int *key, const int *base, size_t n, size_t hint);
+
+    The cursor versions remember where the last search ended.
+
+    macro_bsearch_cursor_t cursor;
+    macro_bsearch_cursor_init(&cursor, base, n);
+
+    macro_bsearch_lower_bound_cursor(lower_bound_ints_cursor, int, compare_int);
+    int *lower_bound_ints_cursor(macro_bsearch_cursor_t *cursor, const int *key);
+
+    The results are the same as macro_bsearch_lower_bound and macro_bsearch_upper_bound
+    (lower_bound returns NULL if every element is less than key, and upper_bound can
+    return base + n).  The comparison styles and kv versions follow macro_bsearch.h.
+*/
+
+#include "the-macro-library/macro_bsearch.h"
+#include "the-macro-library/src/macro_bsearch_hint_code.h"
+
+typedef struct {
+    const void *base;
+    size_t n;
+    size_t pos;
+} macro_bsearch_cursor_t;
+
+static inline void macro_bsearch_cursor_init(macro_bsearch_cursor_t *cursor, const void *base, size_t n) {
+    cursor->base = base;
+    cursor->n = n;
+    cursor->pos = 0;
+}
+
+#define _macro_bsearch_hint_h(name, style, value_type)                          \
+    value_type *name(const value_type *key, const value_type *base, size_t n,   \
+                     macro_cmp_signature(size_t hint, style, value_type))
+
+#define _macro_bsearch_hint(name, bsearch_style, style, value_type, cmp)                             \
+    _macro_bsearch_hint_h(name, style, value_type) {                                                 \
+        __macro_bsearch_hint_ ## bsearch_style ## _code(style, value_type, cmp, key, base, n, hint); \
+    }
+
+#define _macro_bsearch_hint_kv_h(name, style, key_type, value_type)             \
+    value_type *name(const key_type *key, const value_type *base, size_t n,     \
+                     macro_cmp_kv_signature(size_t hint, style, key_type, value_type))
+
+#define _macro_bsearch_hint_kv(name, bsearch_style, style, key_type, value_type, cmp)            \
+    _macro_bsearch_hint_kv_h(name, style, key_type, value_type) {                                \
+        __macro_bsearch_hint_kv_ ## bsearch_style ## _code(style, key_type, value_type, cmp,     \
+                                                           key, base, n, hint);                  \
+    }
+
+#define _macro_bsearch_cursor_h(name, style, value_type)                        \
+    value_type *name(macro_bsearch_cursor_t *cursor,                            \
+                     macro_cmp_signature(const value_type *key, style, value_type))
+
+#define _macro_bsearch_cursor(name, bsearch_style, style, value_type, cmp)                           \
+    _macro_bsearch_cursor_h(name, style, value_type) {                                               \
+        __macro_bsearch_cursor_ ## bsearch_style ## _code(style, value_type, cmp, key, cursor);      \
+    }
+
+#define _macro_bsearch_cursor_kv_h(name, style, key_type, value_type)           \
+    value_type *name(macro_bsearch_cursor_t *cursor,                            \
+                     macro_cmp_kv_signature(const key_type *key, style, key_type, value_type))
+
+#define _macro_bsearch_cursor_kv(name, bsearch_style, style, key_type, value_type, cmp)          \
+    _macro_bsearch_cursor_kv_h(name, style, key_type, value_type) {                              \
+        __macro_bsearch_cursor_kv_ ## bsearch_style ## _code(style, key_type, value_type, cmp,   \
+                                                             key, cursor);                       \
+    }
+
+#define macro_bsearch_lower_bound_hint(name, value_type, cmp)    \
+    _macro_bsearch_hint(name, lower_bound, macro_bsearch_default(), value_type, cmp)
+
+#define macro_bsearch_upper_bound_hint(name, value_type, cmp)    \
+    _macro_bsearch_hint(name, upper_bound, macro_bsearch_default(), value_type, cmp)
+
+#define macro_bsearch_lower_bound_hint_kv(name, key_type, value_type, cmp)    \
+    _macro_bsearch_hint_kv(name, lower_bound, macro_bsearch_default(), key_type, value_type, cmp)
+
+#define macro_bsearch_upper_bound_hint_kv(name, key_type, value_type, cmp)    \
+    _macro_bsearch_hint_kv(name, upper_bound, macro_bsearch_default(), key_type, value_type, cmp)
+
+#define macro_bsearch_lower_bound_cursor(name, value_type, cmp)    \
+    _macro_bsearch_cursor(name, lower_bound, macro_bsearch_default(), value_type, cmp)
+
+#define macro_bsearch_upper_bound_cursor(name, value_type, cmp)    \
+    _macro_bsearch_cursor(name, upper_bound, macro_bsearch_default(), value_type, cmp)
+
+#define macro_bsearch_lower_bound_cursor_kv(name, key_type, value_type, cmp)    \
+    _macro_bsearch_cursor_kv(name, lower_bound, macro_bsearch_default(), key_type, value_type, cmp)
+
+#define macro_bsearch_upper_bound_cursor_kv(name, key_type, value_type, cmp)    \
+    _macro_bsearch_cursor_kv(name, upper_bound, macro_bsearch_default(), key_type, value_type, cmp)
+
+#endif /* _macro_bsearch_hint_H */
@@ -0,0 +1,194 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_btree_H
+#define _macro_btree_H
+
+/*
+    An ordered set stored in a B-tree whose nodes hold the elements themselves (not
+    pointers to them).  Each leaf is about MACRO_BTREE_NODE_SIZE bytes (256 by default,
+    or 4 cache lines), so a lookup in 10 million ints visits 4 or 5 nodes instead of
+    the ~25 nodes (each a likely cache miss) of a macro_map_t tree.  Internal nodes hold
+    as many elements plus a child pointer per element, and are a small fraction of the
+    nodes.
+
+    The find styles are the same as macro_map's (find, first, last, floor, ceiling,
+    lower_bound, upper_bound), as are the comparison styles and the kv versions.
+
+    macro_btree_t tree;
+    macro_btree_init(&tree);
+
+    macro_btree_insert(insert_int, int, compare_ints);
+    bool insert_int(macro_btree_t *t, const int *item);
+
+    macro_btree_find(find_int, int, compare_ints);
+    _macro_btree(lower_bound_int, lower_bound, macro_btree_default(), int, compare_ints);
+    int *find_int(const macro_btree_t *t, const int *key);
+
+    macro_btree_erase(erase_int, int, compare_ints);
+    bool erase_int(macro_btree_t *t, const int *key);
+
+    macro_btree_destroy(&tree);
+
+    insert copies the item into the tree and returns false if an equal element is
+    already present or a node can't be allocated (a find after the false return tells
+    these apart).  erase returns false if no element is equal to key.  Elements move
+    when the tree changes, so the pointers returned by the find functions are only
+    valid until the next insert or erase.  To keep larger objects in place, make the
+    element type a pointer to them.
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "the-macro-library/src/macro_btree_code.h"
+
+typedef struct {
+    void *root;
+    size_t size;
+    size_t height;
+    size_t children_offset;
+} macro_btree_t;
+
+static inline void macro_btree_init(macro_btree_t *t) {
+    t->root = NULL;
+    t->size = 0;
+    t->height = 0;
+    t->children_offset = 0;
+}
+
+#define macro_btree_size(t) ((t)->size)
+
+static void _macro_btree_free(void *node, size_t height, size_t children_offset) {
+    if (height) {
+        void **children = (void **)((char *)node + children_offset);
+        size_t i, num = *(size_t *)node;
+        for (i = 0; i <= num; i++)
+            _macro_btree_free(children[i], height - 1, children_offset);
+    }
+    free(node);
+}
+
+static inline void macro_btree_destroy(macro_btree_t *t) {
+    if (t->root)
+        _macro_btree_free(t->root, t->height, t->children_offset);
+    macro_btree_init(t);
+}
+
+#define _macro_btree_h(name, style, type)    \
+    type *name(const macro_btree_t *t, macro_cmp_signature(const type *key, style, type))
+
+#define _macro_btree(name, find_style, style, type, cmp)                           \
+    _macro_btree_h(name, style, type) {                                            \
+        __macro_btree_find_code(, find_style, style, type, type, cmp, t, key);     \
+    }
+
+#define _macro_btree_compare_h(name, style, type) __macro_btree_compare_h(name, style, type)
+#define __macro_btree_compare_h(name, style, type) _macro_btree_h(name, compare_ ## style, type)
+
+#define _macro_btree_compare(name, find_style, style, type)                        \
+    _macro_btree_compare_h(name, style, type) {                                    \
+        __macro_btree_find_code(, find_style, style, type, type, cmp, t, key);     \
+    }
+
+#define _macro_btree_kv_h(name, style, key_type, value_type)    \
+    value_type *name(const macro_btree_t *t, macro_cmp_kv_signature(const key_type *key, style, key_type, value_type))
+
+#define _macro_btree_kv(name, find_style, style, key_type, value_type, cmp)                    \
+    _macro_btree_kv_h(name, style, key_type, value_type) {                                     \
+        __macro_btree_find_code(_kv, find_style, style, key_type, value_type, cmp, t, key);    \
+    }
+
+#define _macro_btree_kv_compare_h(name, style, key_type, value_type)    \
+    __macro_btree_kv_compare_h(name, style, key_type, value_type)
+#define __macro_btree_kv_compare_h(name, style, key_type, value_type)    \
+    _macro_btree_kv_h(name, compare_ ## style, key_type, value_type)
+
+#define _macro_btree_kv_compare(name, find_style, style, key_type, value_type)                 \
+    _macro_btree_kv_compare_h(name, style, key_type, value_type) {                             \
+        __macro_btree_find_code(_kv, find_style, style, key_type, value_type, cmp, t, key);    \
+    }
+
+#define _macro_btree_insert_h(name, style, type)    \
+    bool name(macro_btree_t *t, macro_cmp_signature(const type *item, style, type))
+
+#define _macro_btree_insert(name, style, type, cmp)                  \
+    _macro_btree_insert_h(name, style, type) {                       \
+        __macro_btree_insert_code(style, type, cmp, t, item);        \
+    }
+
+#define _macro_btree_insert_compare_h(name, style, type) __macro_btree_insert_compare_h(name, style, type)
+#define __macro_btree_insert_compare_h(name, style, type) _macro_btree_insert_h(name, compare_ ## style, type)
+
+#define _macro_btree_insert_compare(name, style, type)               \
+    _macro_btree_insert_compare_h(name, style, type) {               \
+        __macro_btree_insert_code(style, type, cmp, t, item);        \
+    }
+
+#define _macro_btree_erase_h(name, style, type)    \
+    bool name(macro_btree_t *t, macro_cmp_signature(const type *key, style, type))
+
+#define _macro_btree_erase(name, style, type, cmp)                           \
+    _macro_btree_erase_h(name, style, type) {                                \
+        __macro_btree_erase_code(, style, type, type, cmp, t, key);          \
+    }
+
+#define _macro_btree_erase_compare_h(name, style, type) __macro_btree_erase_compare_h(name, style, type)
+#define __macro_btree_erase_compare_h(name, style, type) _macro_btree_erase_h(name, compare_ ## style, type)
+
+#define _macro_btree_erase_compare(name, style, type)                        \
+    _macro_btree_erase_compare_h(name, style, type) {                        \
+        __macro_btree_erase_code(, style, type, type, cmp, t, key);          \
+    }
+
+#define _macro_btree_erase_kv_h(name, style, key_type, value_type)    \
+    bool name(macro_btree_t *t, macro_cmp_kv_signature(const key_type *key, style, key_type, value_type))
+
+#define _macro_btree_erase_kv(name, style, key_type, value_type, cmp)                    \
+    _macro_btree_erase_kv_h(name, style, key_type, value_type) {                         \
+        __macro_btree_erase_code(_kv, style, key_type, value_type, cmp, t, key);         \
+    }
+
+#define _macro_btree_erase_kv_compare_h(name, style, key_type, value_type)    \
+    __macro_btree_erase_kv_compare_h(name, style, key_type, value_type)
+#define __macro_btree_erase_kv_compare_h(name, style, key_type, value_type)    \
+    _macro_btree_erase_kv_h(name, compare_ ## style, key_type, value_type)
+
+#define _macro_btree_erase_kv_compare(name, style, key_type, value_type)                 \
+    _macro_btree_erase_kv_compare_h(name, style, key_type, value_type) {                 \
+        __macro_btree_erase_code(_kv, style, key_type, value_type, cmp, t, key);         \
+    }
+
+/* defaults - cmp_no_arg */
+#define macro_btree_default() cmp_no_arg
+
+#define macro_btree_find_h(name, type) _macro_btree_h(name, macro_btree_default(), type)
+#define macro_btree_find(name, type, cmp) _macro_btree(name, find, macro_btree_default(), type, cmp)
+#define macro_btree_find_compare_h(name, type) _macro_btree_compare_h(name, macro_btree_default(), type)
+#define macro_btree_find_compare(name, type) _macro_btree_compare(name, find, macro_btree_default(), type)
+
+#define macro_btree_find_kv_h(name, key_type, value_type)    \
+    _macro_btree_kv_h(name, macro_btree_default(), key_type, value_type)
+#define macro_btree_find_kv(name, key_type, value_type, cmp)    \
+    _macro_btree_kv(name, find, macro_btree_default(), key_type, value_type, cmp)
+#define macro_btree_find_kv_compare_h(name, key_type, value_type)    \
+    _macro_btree_kv_compare_h(name, macro_btree_default(), key_type, value_type)
+#define macro_btree_find_kv_compare(name, key_type, value_type)    \
+    _macro_btree_kv_compare(name, find, macro_btree_default(), key_type, value_type)
+
+#define macro_btree_insert_h(name, type) _macro_btree_insert_h(name, macro_btree_default(), type)
+#define macro_btree_insert(name, type, cmp) _macro_btree_insert(name, macro_btree_default(), type, cmp)
+#define macro_btree_insert_compare_h(name, type) _macro_btree_insert_compare_h(name, macro_btree_default(), type)
+#define macro_btree_insert_compare(name, type) _macro_btree_insert_compare(name, macro_btree_default(), type)
+
+#define macro_btree_erase_h(name, type) _macro_btree_erase_h(name, macro_btree_default(), type)
+#define macro_btree_erase(name, type, cmp) _macro_btree_erase(name, macro_btree_default(), type, cmp)
+#define macro_btree_erase_compare_h(name, type) _macro_btree_erase_compare_h(name, macro_btree_default(), type)
+#define macro_btree_erase_compare(name, type) _macro_btree_erase_compare(name, macro_btree_default(), type)
+
+#define macro_btree_erase_kv_h(name, key_type, value_type)    \
+    _macro_btree_erase_kv_h(name, macro_btree_default(), key_type, value_type)
+#define macro_btree_erase_kv(name, key_type, value_type, cmp)    \
+    _macro_btree_erase_kv(name, macro_btree_default(), key_type, value_type, cmp)
+
+#endif /* _macro_btree_H */
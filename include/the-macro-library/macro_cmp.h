@@ -4,6 +4,7 @@
 #define _macro_cmp_H
 
 #include <stdbool.h>
+#include <string.h>
 
 /*
     macro_less, macro_equal makes it easier to define different styles of comparisons.
@@ -16,6 +17,8 @@
     arg_less     => bool less(void *arg, const type *a, const type *b);
     less         => no comparison, but expects *(a) < *(b) to function properly
     cmp          => no comparison, but expects *(a) < *(b) and *(a) == *(b) to function properly
+    bytes        => no comparison, cmp is the name of a fixed size unsigned char array field
+                    (see macro_key.h) and the field is compared with memcmp
 */
 #define macro_less_cmp_no_arg(type, cmp, a, b) (cmp((const type *)(a), (const type *)(b)) < 0)
 #define macro_less_cmp_arg(type, cmp, a, b) (cmp((const type *)(a), (const type *)(b), (arg)) < 0)
@@ -25,6 +28,7 @@
 #define macro_less_arg_less(type, cmp, a, b) cmp((arg), (const type *)(a), (const type *)(b))
 #define macro_less_less(type, cmp, a, b) (*(a) < *(b))
 #define macro_less_cmp(type, cmp, a, b) (*(a) < *(b))
+#define macro_less_bytes(type, cmp, a, b) (macro_cmp_bytes(type, cmp, a, b) < 0)
 
 #define macro_less(style, type, cmp, a, b) macro_less_ ## style(type, cmp, a, b)
 
@@ -37,6 +41,7 @@
 #define macro_equal_arg_less(type, cmp, a, b) (!macro_less_arg_less(type, cmp, a, b) && !macro_less_arg_less(type, cmp, b, a))
 #define macro_equal_less(type, cmp, a, b) (!macro_less_less(type, cmp, a, b) && !macro_less_less(type, cmp, b, a))
 #define macro_equal_cmp(type, cmp, a, b) (*(a) == *(b))
+#define macro_equal_bytes(type, cmp, a, b) (macro_cmp_bytes(type, cmp, a, b) == 0)
 
 #define macro_equal(style, type, cmp, a, b) macro_equal_ ## style(type, cmp, a, b)
 
@@ -52,6 +57,8 @@
 #define macro_cmp_arg_less(type, cmp, a, b) (macro_less_arg_less(type, cmp, a, b) ? -1 : macro_less_arg_less(type, cmp, b, a) ? 1 : 0)
 #define macro_cmp_less(type, cmp, a, b) (macro_less_less(type, cmp, a, b) ? -1 : macro_less_less(type, cmp, b, a) ? 1 : 0)
 #define macro_cmp_cmp(type, cmp, a, b) (macro_less_less(type, cmp, a, b) ? -1 : macro_less_less(type, cmp, b, a) ? 1 : 0)
+#define macro_cmp_bytes(type, cmp, a, b)    \
+    memcmp(((const type *)(a))->cmp, ((const type *)(b))->cmp, sizeof(((const type *)(a))->cmp))
 
 #define macro_cmp(style, type, cmp, a, b) macro_cmp_ ## style(type, cmp, a, b)
 
@@ -62,6 +69,10 @@
 #define macro_cmp_kv_cmp_arg(key_type, value_type, cmp, a, b) cmp((const key_type *)(a), (const value_type *)(b), (arg))
 #define macro_cmp_kv_arg_cmp(key_type, value_type, cmp, a, b) cmp((arg), (const key_type *)(a), (const value_type *)(b))
 
+/* for bytes, the key is expected to be an encoded key (const unsigned char *) */
+#define macro_cmp_kv_bytes(key_type, value_type, cmp, a, b)    \
+    memcmp((const unsigned char *)(a), ((const value_type *)(b))->cmp, sizeof(((const value_type *)(b))->cmp))
+
 #define macro_cmp_kv(style, key_type, value_type, cmp, a, b) macro_cmp_kv_ ## style(key_type, value_type, cmp, a, b)
 
 #define macro_equal_kv(style, key_type, value_type, cmp, a, b) (macro_cmp_kv_ ## style(key_type, value_type, cmp, (a), (b))==0)
@@ -73,6 +84,7 @@
 #define macro_cmp_kv_signature_cmp_no_arg(param, key_type, value_type) param
 #define macro_cmp_kv_signature_arg_cmp(param, key_type, value_type) param, void *arg
 #define macro_cmp_kv_signature_cmp_arg(param, key_type, value_type) param, void *arg
+#define macro_cmp_kv_signature_bytes(param, key_type, value_type) param
 #define macro_cmp_kv_signature_compare_cmp_no_arg(param, key_type, value_type)    \
     param, int (*cmp)(const key_type *, const value_type *)
 
@@ -101,6 +113,7 @@
 
 #define macro_cmp_signature_less_no_arg(param, type) param
 #define macro_cmp_signature_less(param, type) param
+#define macro_cmp_signature_bytes(param, type) param
 #define macro_cmp_signature_arg_less(param, type) param, void *arg
 #define macro_cmp_signature_less_arg(param, type) param, void *arg
 #define macro_cmp_signature_compare_less_no_arg(param, type)    \
@@ -0,0 +1,99 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_cmp_fields_H
+#define _macro_cmp_fields_H
+
+#include <stdbool.h>
+
+#include "the-macro-library/macro_cmp.h"
+#include "the-macro-library/src/macro_for_each.h"
+
+/*
+    macro_cmp_fields(name, type, (field, asc|desc), ...) generates a set of static inline
+    comparison functions which compare the fields in order (up to 16 fields).
+
+    cmp_no_arg   => int name_cmp(const type *a, const type *b);
+    cmp_arg      => int name_cmp_arg(const type *a, const type *b, void *arg);
+    arg_cmp      => int name_arg_cmp(void *arg, const type *a, const type *b);
+    less_no_arg  => bool name_less(const type *a, const type *b);
+    less_arg     => bool name_less_arg(const type *a, const type *b, void *arg);
+    arg_less     => bool name_arg_less(void *arg, const type *a, const type *b);
+
+    class item_t {
+        int key;
+        int key2;
+        ...
+    };
+
+    macro_cmp_fields(item, item_t, (key, asc), (key2, asc));
+    _macro_sort(sort_items, less_no_arg, item_t, item_less);
+    macro_bsearch(find_item, item_t, item_cmp);
+
+    A field which is compared with < is evaluated without branching.  Each field sets a
+    bit in a less than mask and a greater than mask (the first field being the most
+    significant bit), so the first field which differs decides how the masks compare.
+    This is a good fit for integral fields where a chain of if statements mispredicts.
+
+    A field can also be given a compare function (field, asc, fn) where fn is called as
+    fn(a->field, b->field) and returns an int (strcmp for example).  These fields are
+    only compared if all of the previous fields are equal.
+*/
+
+#define __macro_cmp_fields_asc(a, b, field)        \
+    lt = (lt << 1) | ((a)->field < (b)->field);    \
+    gt = (gt << 1) | ((b)->field < (a)->field);
+
+#define __macro_cmp_fields_desc(a, b, field) __macro_cmp_fields_asc(b, a, field)
+
+#define __macro_cmp_fields_fn_asc(a, b, field, fn) c = fn((a)->field, (b)->field);
+#define __macro_cmp_fields_fn_desc(a, b, field, fn) c = fn((b)->field, (a)->field);
+
+#define __macro_cmp_fields_field_3(type, field, order) __macro_cmp_fields_ ## order(a, b, field)
+
+#define __macro_cmp_fields_field_4(type, field, order, fn)    \
+    lt <<= 1;                                                 \
+    gt <<= 1;                                                 \
+    if(!(lt | gt)) {                                          \
+        __macro_cmp_fields_fn_ ## order(a, b, field, fn)      \
+        lt |= (c < 0);                                        \
+        gt |= (c > 0);                                        \
+    }
+
+#define __macro_cmp_fields_dispatch(...)    \
+    __macro_cat(__macro_cmp_fields_field_, __macro_nargs(__VA_ARGS__))(__VA_ARGS__)
+
+#define __macro_cmp_fields_field(type, t) __macro_apply(__macro_cmp_fields_dispatch, type, t)
+
+#define __macro_cmp_fields_code(type, ...)                             \
+    unsigned int lt = 0, gt = 0;                                       \
+    int c = 0;                                                         \
+    (void)c;                                                           \
+    __macro_for_each(__macro_cmp_fields_field, type, __VA_ARGS__)
+
+#define macro_cmp_fields(name, type, ...)                                               \
+    static inline int name ## _cmp(const type *a, const type *b) {                      \
+        __macro_cmp_fields_code(type, __VA_ARGS__)                                      \
+        return (int)(gt > lt) - (int)(gt < lt);                                         \
+    }                                                                                   \
+    static inline bool name ## _less(const type *a, const type *b) {                    \
+        __macro_cmp_fields_code(type, __VA_ARGS__)                                      \
+        return lt > gt;                                                                 \
+    }                                                                                   \
+    static inline int name ## _cmp_arg(const type *a, const type *b, void *arg) {       \
+        (void)arg;                                                                      \
+        return name ## _cmp(a, b);                                                      \
+    }                                                                                   \
+    static inline int name ## _arg_cmp(void *arg, const type *a, const type *b) {       \
+        (void)arg;                                                                      \
+        return name ## _cmp(a, b);                                                      \
+    }                                                                                   \
+    static inline bool name ## _less_arg(const type *a, const type *b, void *arg) {     \
+        (void)arg;                                                                      \
+        return name ## _less(a, b);                                                     \
+    }                                                                                   \
+    static inline bool name ## _arg_less(void *arg, const type *a, const type *b) {     \
+        (void)arg;                                                                      \
+        return name ## _less(a, b);                                                     \
+    }
+
+#endif /* _macro_cmp_fields_H */
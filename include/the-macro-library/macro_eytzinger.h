@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_eytzinger_H
+#define _macro_eytzinger_H
+
+/*
+    Search arrays stored in Eytzinger (breadth first) order.  A sorted array is copied
+    into Eytzinger order once with macro_eytzinger_build and then searched with the
+    lookup functions below.  For large arrays the lookups are several times faster than
+    a binary search over the sorted array since the search has no unpredictable branches
+    and the next few levels of the tree are prefetched while the current one is compared.
+
+    macro_eytzinger_build(build_ints, int);
+    void build_ints(int *dest, const int *src, size_t n);
+
+    dest must have room for n + 1 elements.  dest[0] is not used, so that node k of the
+    tree is dest[k] and the nodes which are prefetched together start at dest[k << d].
+    Allocating dest on a 64 byte boundary (for example with aligned_alloc) keeps each
+    group of prefetched nodes in a single cache line when the size of the element is
+    a power of two.  dest and src must not overlap.
+
+    The lookups are passed dest and n (not n + 1).
+
+    The lookup functions have the same signatures and comparison styles as the
+    macro_bsearch functions (including the kv versions) and return a pointer into the
+    Eytzinger array or NULL.
+
+    macro_eytzinger - an element equal to key (the first one in sorted order)
+    macro_eytzinger_lower_bound - the first element (in sorted order) >= key
+    macro_eytzinger_upper_bound - the first element (in sorted order) > key
+
+    The elements are not in sorted order, so the result can't be used to step to the
+    next or previous element with pointer arithmetic.
+*/
+
+#include "the-macro-library/macro_bsearch.h"
+#include "the-macro-library/src/macro_eytzinger_code.h"
+
+#define macro_eytzinger_build_h(name, type)    \
+    void name(type *dest, const type *src, size_t n)
+
+#define macro_eytzinger_build(name, type)                \
+    macro_eytzinger_build_h(name, type) {                \
+        __macro_eytzinger_build_code(dest, src, n);      \
+    }
+
+#define _macro_eytzinger(name, bsearch_style, style, value_type, cmp)                          \
+    _macro_bsearch_h(name, style, value_type) {                                                \
+        __macro_eytzinger_ ## bsearch_style ## _code(style, value_type, cmp, key, base, n);    \
+    }
+
+#define _macro_eytzinger_kv(name, bsearch_style, style, key_type, value_type, cmp)                          \
+    _macro_bsearch_kv_h(name, style, key_type, value_type) {                                                \
+        __macro_eytzinger_kv_ ## bsearch_style ## _code(style, key_type, value_type, cmp, key, base, n);    \
+    }
+
+#define _macro_eytzinger_compare(name, bsearch_style, style, value_type)                       \
+    _macro_bsearch_compare_h(name, style, value_type) {                                        \
+        __macro_eytzinger_ ## bsearch_style ## _code(style, value_type, cmp, key, base, n);    \
+    }
+
+#define _macro_eytzinger_kv_compare(name, bsearch_style, style, key_type, value_type)                       \
+    _macro_bsearch_kv_compare_h(name, style, key_type, value_type) {                                        \
+        __macro_eytzinger_kv_ ## bsearch_style ## _code(style, key_type, value_type, cmp, key, base, n);    \
+    }
+
+/* the style is expanded here before _macro_bsearch_compare_h pastes compare_ onto it */
+#define __macro_eytzinger_compare_h(name, style, value_type)    \
+    _macro_bsearch_compare_h(name, style, value_type)
+#define __macro_eytzinger_kv_compare_h(name, style, key_type, value_type)    \
+    _macro_bsearch_kv_compare_h(name, style, key_type, value_type)
+
+#define macro_eytzinger_h(name, value_type)    \
+    _macro_bsearch_h(name, macro_bsearch_default(), value_type )
+
+#define macro_eytzinger_compare_h(name, value_type)    \
+    __macro_eytzinger_compare_h(name, macro_bsearch_default(), value_type )
+
+#define macro_eytzinger(name, value_type, cmp)    \
+    _macro_eytzinger(name, core, macro_bsearch_default(), value_type, cmp)
+
+#define macro_eytzinger_compare(name, value_type)    \
+    _macro_eytzinger_compare(name, core, macro_bsearch_default(), value_type )
+
+#define macro_eytzinger_lower_bound(name, value_type, cmp)    \
+    _macro_eytzinger(name, lower_bound, macro_bsearch_default(), value_type, cmp)
+
+#define macro_eytzinger_lower_bound_compare(name, value_type)    \
+    _macro_eytzinger_compare(name, lower_bound, macro_bsearch_default(), value_type )
+
+#define macro_eytzinger_upper_bound(name, value_type, cmp)    \
+    _macro_eytzinger(name, upper_bound, macro_bsearch_default(), value_type, cmp)
+
+#define macro_eytzinger_upper_bound_compare(name, value_type)    \
+    _macro_eytzinger_compare(name, upper_bound, macro_bsearch_default(), value_type )
+
+/* kv version (accepts a different type of key) */
+
+#define macro_eytzinger_kv_h(name, key_type, value_type)    \
+    _macro_bsearch_kv_h(name, macro_bsearch_default(), key_type, value_type )
+
+#define macro_eytzinger_kv_compare_h(name, key_type, value_type)    \
+    __macro_eytzinger_kv_compare_h(name, macro_bsearch_default(), key_type, value_type )
+
+#define macro_eytzinger_kv(name, key_type, value_type, cmp)    \
+    _macro_eytzinger_kv(name, core, macro_bsearch_default(), key_type, value_type, cmp)
+
+#define macro_eytzinger_kv_compare(name, key_type, value_type)    \
+    _macro_eytzinger_kv_compare(name, core, macro_bsearch_default(), key_type, value_type )
+
+#define macro_eytzinger_lower_bound_kv(name, key_type, value_type, cmp)    \
+    _macro_eytzinger_kv(name, lower_bound, macro_bsearch_default(), key_type, value_type, cmp)
+
+#define macro_eytzinger_lower_bound_kv_compare(name, key_type, value_type)    \
+    _macro_eytzinger_kv_compare(name, lower_bound, macro_bsearch_default(), key_type, value_type )
+
+#define macro_eytzinger_upper_bound_kv(name, key_type, value_type, cmp)    \
+    _macro_eytzinger_kv(name, upper_bound, macro_bsearch_default(), key_type, value_type, cmp)
+
+#define macro_eytzinger_upper_bound_kv_compare(name, key_type, value_type)    \
+    _macro_eytzinger_kv_compare(name, upper_bound, macro_bsearch_default(), key_type, value_type )
+
+#endif /* _macro_eytzinger_H */
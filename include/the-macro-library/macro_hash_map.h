@@ -0,0 +1,234 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_hash_map_H
+#define _macro_hash_map_H
+
+/*
+    An unordered set (or map) in an open addressing hash table, for lookups which only
+    need an exact match.  A lookup is usually one probe of 8 control bytes and one
+    compare, instead of the ~log2(n) dependent loads of a macro_map_t tree.
+
+    Elements are stored by value in the table (like macro_btree.h).  To keep larger
+    objects (or intrusive nodes) in place, make the element type a pointer to them.
+    The equality test uses the same comparison styles as the rest of the library (0
+    means equal), and the hash function returns a uint64_t (it is mixed again by the
+    table, so a plain identity hash works for ints).
+
+    macro_hash_map_t table;
+    macro_hash_map_init(&table);
+
+    macro_hash_map_insert(insert_int, int, hash_int, compare_ints);
+    bool insert_int(macro_hash_map_t *h, const int *item);
+
+    macro_hash_map_find(find_int, int, hash_int, compare_ints);
+    int *find_int(const macro_hash_map_t *h, const int *key);
+
+    macro_hash_map_erase(erase_int, int, hash_int, compare_ints);
+    bool erase_int(macro_hash_map_t *h, const int *key);
+
+    for (size_t i = macro_hash_map_next(&table, 0); i < table.capacity;
+         i = macro_hash_map_next(&table, i + 1)) {
+        int *e = macro_hash_map_slot(&table, int, i);
+        ...
+    }
+
+    macro_hash_map_destroy(&table);
+
+    The _compare versions take the comparison function as a parameter of the generated
+    function, as with the rest of the library.
+
+    insert copies the item into the table and returns false if an equal element is
+    already present or memory can't be allocated.  The result doesn't say which, so a
+    caller which needs to know can call find after a false return (the element is
+    missing only if the allocation failed).  The kv versions of find and erase
+    take a key of another type, and their hash must agree with the element's hash.
+    Elements move when the table grows, so the pointers returned by find are only
+    valid until the next insert.  macro_hash_map_erase_at may be called while
+    iterating (erasing never moves other elements).
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "the-macro-library/src/macro_hash_map_code.h"
+
+typedef struct {
+    uint8_t *ctrl;
+    void *slots;
+    size_t capacity;
+    size_t size;
+    size_t growth_left;
+} macro_hash_map_t;
+
+static inline void macro_hash_map_init(macro_hash_map_t *h) {
+    memset(h, 0, sizeof(*h));
+}
+
+#define macro_hash_map_size(h) ((h)->size)
+
+static inline void macro_hash_map_destroy(macro_hash_map_t *h) {
+    free(h->ctrl);
+    macro_hash_map_init(h);
+}
+
+/* erases every element, but keeps the memory */
+static inline void macro_hash_map_clear(macro_hash_map_t *h) {
+    if (!h->capacity)
+        return;
+    memset(h->ctrl, __macro_hash_map_empty, h->capacity);
+    h->size = 0;
+    h->growth_left = h->capacity - (h->capacity >> 3);
+}
+
+/* returns the first full slot at or after i, or h->capacity if there isn't one */
+static inline size_t macro_hash_map_next(const macro_hash_map_t *h, size_t i) {
+    while (i < h->capacity && (h->ctrl[i] & 0x80))
+        i++;
+    return i;
+}
+
+#define macro_hash_map_slot(h, type, i) (((type *)(h)->slots) + (i))
+
+/* erases the element in the full slot i */
+static inline void macro_hash_map_erase_at(macro_hash_map_t *h, size_t i) {
+    if (_macro_hash_map_match_empty(_macro_hash_map_group(h->ctrl + (i & ~(size_t)7)))) {
+        h->ctrl[i] = __macro_hash_map_empty;
+        h->growth_left++;
+    } else
+        h->ctrl[i] = __macro_hash_map_deleted;
+    h->size--;
+}
+
+#define _macro_hash_map_find_h(name, style, type)    \
+    type *name(const macro_hash_map_t *h, macro_cmp_signature(const type *key, style, type))
+
+#define _macro_hash_map_find(name, style, type, hash, cmp)                             \
+    _macro_hash_map_find_h(name, style, type) {                                        \
+        __macro_hash_map_find_code(, style, type, type, hash, cmp, h, key)             \
+    }
+
+#define _macro_hash_map_find_compare_h(name, style, type) __macro_hash_map_find_compare_h(name, style, type)
+#define __macro_hash_map_find_compare_h(name, style, type) _macro_hash_map_find_h(name, compare_ ## style, type)
+
+#define _macro_hash_map_find_compare(name, style, type, hash)                          \
+    _macro_hash_map_find_compare_h(name, style, type) {                                \
+        __macro_hash_map_find_code(, style, type, type, hash, cmp, h, key)             \
+    }
+
+#define _macro_hash_map_find_kv_h(name, style, key_type, value_type)    \
+    value_type *name(const macro_hash_map_t *h, macro_cmp_kv_signature(const key_type *key, style, key_type, value_type))
+
+#define _macro_hash_map_find_kv(name, style, key_type, value_type, hash, cmp)                   \
+    _macro_hash_map_find_kv_h(name, style, key_type, value_type) {                              \
+        __macro_hash_map_find_code(_kv, style, key_type, value_type, hash, cmp, h, key)         \
+    }
+
+#define _macro_hash_map_find_kv_compare_h(name, style, key_type, value_type)    \
+    __macro_hash_map_find_kv_compare_h(name, style, key_type, value_type)
+#define __macro_hash_map_find_kv_compare_h(name, style, key_type, value_type)    \
+    _macro_hash_map_find_kv_h(name, compare_ ## style, key_type, value_type)
+
+#define _macro_hash_map_find_kv_compare(name, style, key_type, value_type, hash)                \
+    _macro_hash_map_find_kv_compare_h(name, style, key_type, value_type) {                      \
+        __macro_hash_map_find_code(_kv, style, key_type, value_type, hash, cmp, h, key)         \
+    }
+
+#define _macro_hash_map_insert_h(name, style, type)    \
+    bool name(macro_hash_map_t *h, macro_cmp_signature(const type *item, style, type))
+
+#define _macro_hash_map_insert(name, style, type, hash, cmp)                           \
+    _macro_hash_map_insert_h(name, style, type) {                                      \
+        __macro_hash_map_insert_code(style, type, hash, cmp, h, item)                  \
+    }
+
+#define _macro_hash_map_insert_compare_h(name, style, type) __macro_hash_map_insert_compare_h(name, style, type)
+#define __macro_hash_map_insert_compare_h(name, style, type) _macro_hash_map_insert_h(name, compare_ ## style, type)
+
+#define _macro_hash_map_insert_compare(name, style, type, hash)                        \
+    _macro_hash_map_insert_compare_h(name, style, type) {                              \
+        __macro_hash_map_insert_code(style, type, hash, cmp, h, item)                  \
+    }
+
+#define _macro_hash_map_erase_h(name, style, type)    \
+    bool name(macro_hash_map_t *h, macro_cmp_signature(const type *key, style, type))
+
+#define _macro_hash_map_erase(name, style, type, hash, cmp)                            \
+    _macro_hash_map_erase_h(name, style, type) {                                       \
+        __macro_hash_map_erase_code(, style, type, type, hash, cmp, h, key)            \
+    }
+
+#define _macro_hash_map_erase_compare_h(name, style, type) __macro_hash_map_erase_compare_h(name, style, type)
+#define __macro_hash_map_erase_compare_h(name, style, type) _macro_hash_map_erase_h(name, compare_ ## style, type)
+
+#define _macro_hash_map_erase_compare(name, style, type, hash)                         \
+    _macro_hash_map_erase_compare_h(name, style, type) {                               \
+        __macro_hash_map_erase_code(, style, type, type, hash, cmp, h, key)            \
+    }
+
+#define _macro_hash_map_erase_kv_h(name, style, key_type, value_type)    \
+    bool name(macro_hash_map_t *h, macro_cmp_kv_signature(const key_type *key, style, key_type, value_type))
+
+#define _macro_hash_map_erase_kv(name, style, key_type, value_type, hash, cmp)                  \
+    _macro_hash_map_erase_kv_h(name, style, key_type, value_type) {                             \
+        __macro_hash_map_erase_code(_kv, style, key_type, value_type, hash, cmp, h, key)        \
+    }
+
+#define _macro_hash_map_erase_kv_compare_h(name, style, key_type, value_type)    \
+    __macro_hash_map_erase_kv_compare_h(name, style, key_type, value_type)
+#define __macro_hash_map_erase_kv_compare_h(name, style, key_type, value_type)    \
+    _macro_hash_map_erase_kv_h(name, compare_ ## style, key_type, value_type)
+
+#define _macro_hash_map_erase_kv_compare(name, style, key_type, value_type, hash)               \
+    _macro_hash_map_erase_kv_compare_h(name, style, key_type, value_type) {                     \
+        __macro_hash_map_erase_code(_kv, style, key_type, value_type, hash, cmp, h, key)        \
+    }
+
+/* defaults - cmp_no_arg */
+#define macro_hash_map_default() cmp_no_arg
+
+#define macro_hash_map_find_h(name, type) _macro_hash_map_find_h(name, macro_hash_map_default(), type)
+#define macro_hash_map_find(name, type, hash, cmp)    \
+    _macro_hash_map_find(name, macro_hash_map_default(), type, hash, cmp)
+#define macro_hash_map_find_compare_h(name, type)    \
+    _macro_hash_map_find_compare_h(name, macro_hash_map_default(), type)
+#define macro_hash_map_find_compare(name, type, hash)    \
+    _macro_hash_map_find_compare(name, macro_hash_map_default(), type, hash)
+
+#define macro_hash_map_find_kv_h(name, key_type, value_type)    \
+    _macro_hash_map_find_kv_h(name, macro_hash_map_default(), key_type, value_type)
+#define macro_hash_map_find_kv(name, key_type, value_type, hash, cmp)    \
+    _macro_hash_map_find_kv(name, macro_hash_map_default(), key_type, value_type, hash, cmp)
+#define macro_hash_map_find_kv_compare_h(name, key_type, value_type)    \
+    _macro_hash_map_find_kv_compare_h(name, macro_hash_map_default(), key_type, value_type)
+#define macro_hash_map_find_kv_compare(name, key_type, value_type, hash)    \
+    _macro_hash_map_find_kv_compare(name, macro_hash_map_default(), key_type, value_type, hash)
+
+#define macro_hash_map_insert_h(name, type) _macro_hash_map_insert_h(name, macro_hash_map_default(), type)
+#define macro_hash_map_insert(name, type, hash, cmp)    \
+    _macro_hash_map_insert(name, macro_hash_map_default(), type, hash, cmp)
+#define macro_hash_map_insert_compare_h(name, type)    \
+    _macro_hash_map_insert_compare_h(name, macro_hash_map_default(), type)
+#define macro_hash_map_insert_compare(name, type, hash)    \
+    _macro_hash_map_insert_compare(name, macro_hash_map_default(), type, hash)
+
+#define macro_hash_map_erase_h(name, type) _macro_hash_map_erase_h(name, macro_hash_map_default(), type)
+#define macro_hash_map_erase(name, type, hash, cmp)    \
+    _macro_hash_map_erase(name, macro_hash_map_default(), type, hash, cmp)
+#define macro_hash_map_erase_compare_h(name, type)    \
+    _macro_hash_map_erase_compare_h(name, macro_hash_map_default(), type)
+#define macro_hash_map_erase_compare(name, type, hash)    \
+    _macro_hash_map_erase_compare(name, macro_hash_map_default(), type, hash)
+
+#define macro_hash_map_erase_kv_h(name, key_type, value_type)    \
+    _macro_hash_map_erase_kv_h(name, macro_hash_map_default(), key_type, value_type)
+#define macro_hash_map_erase_kv(name, key_type, value_type, hash, cmp)    \
+    _macro_hash_map_erase_kv(name, macro_hash_map_default(), key_type, value_type, hash, cmp)
+#define macro_hash_map_erase_kv_compare_h(name, key_type, value_type)    \
+    _macro_hash_map_erase_kv_compare_h(name, macro_hash_map_default(), key_type, value_type)
+#define macro_hash_map_erase_kv_compare(name, key_type, value_type, hash)    \
+    _macro_hash_map_erase_kv_compare(name, macro_hash_map_default(), key_type, value_type, hash)
+
+#endif /* _macro_hash_map_H */
@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_isearch_H
+#define _macro_isearch_H
+
+#include <stdbool.h>
+
+#include "the-macro-library/src/macro_isearch_code.h"
+
+/*
+    Searches for sorted arrays of numbers (integers, floats, timestamps, hashed ids)
+    which use the distribution of the keys to guess where the key is.  They return the
+    same element as macro_bsearch_lower_bound (the first element >= key, or NULL).
+
+    macro_isearch(isearch_u64, uint64_t);
+    uint64_t *isearch_u64(const uint64_t *key, const uint64_t *base, size_t n);
+
+    isearch interpolates once and then walks toward the key in doubling steps before
+    finishing with a binary search, so it needs no setup and falls back to about twice
+    the cost of a binary search when the keys aren't evenly spread out.
+
+    macro_learned_index_t(u64_index_t, uint64_t);
+    macro_learned_index_build(u64_index_build, uint64_t, u64_index_t);
+    macro_learned_index_lower_bound(u64_index_lower_bound, uint64_t, u64_index_t);
+
+    bool u64_index_build(u64_index_t *idx, const uint64_t *base, size_t n,
+                         size_t max_error);
+    uint64_t *u64_index_lower_bound(const u64_index_t *idx, const uint64_t *key);
+
+    The learned index fits a piecewise linear model to the array which predicts the
+    position of every key in the array within max_error (32 or 64 is typical).  The
+    array must not change (or move) while the index is in use.  macro_learned_index_destroy
+    frees the model.
+*/
+
+#define macro_isearch_h(name, value_type)    \
+    value_type *name(const value_type *key, const value_type *base, size_t n)
+
+#define macro_isearch(name, value_type)                   \
+    macro_isearch_h(name, value_type) {                   \
+        __macro_isearch_code(value_type, key, base, n)    \
+    }
+
+#define macro_learned_index_t(name, value_type)    \
+    typedef struct {                               \
+        value_type key;                            \
+        double slope;                              \
+        size_t pos;                                \
+    } name ## _segment_t;                          \
+                                                   \
+    typedef struct {                               \
+        const value_type *base;                    \
+        size_t n;                                  \
+        size_t max_error;                          \
+        name ## _segment_t *segments;              \
+        size_t num_segments;                       \
+    } name
+
+#define macro_learned_index_destroy(idx) free((idx)->segments)
+
+#define macro_learned_index_build_h(name, value_type, index_type)    \
+    bool name(index_type *idx, const value_type *base, size_t n, size_t max_error)
+
+#define macro_learned_index_build(name, value_type, index_type)                          \
+    macro_learned_index_build_h(name, value_type, index_type) {                          \
+        __macro_learned_index_build_code(value_type, index_type ## _segment_t,           \
+                                         idx, base, n, max_error)                        \
+    }
+
+#define macro_learned_index_lower_bound_h(name, value_type, index_type)    \
+    value_type *name(const index_type *idx, const value_type *key)
+
+#define macro_learned_index_lower_bound(name, value_type, index_type)     \
+    macro_learned_index_lower_bound_h(name, value_type, index_type) {     \
+        __macro_learned_index_lower_bound_code(value_type, idx, key)      \
+    }
+
+#endif /* _macro_isearch_H */
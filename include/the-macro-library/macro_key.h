@@ -0,0 +1,216 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_key_H
+#define _macro_key_H
+
+/*
+    macro_key normalizes a list of fields into an order preserving byte string.  Two
+    encoded keys compare with memcmp exactly as the fields would compare one after
+    the other, so a multi-field comparison becomes a single memcmp (or a radix sort).
+
+    Each field is described as (kind, field, order) where order is asc or desc and
+    kind is one of
+
+    u8, u16, u32, u64  => unsigned integers (big endian)
+    i8, i16, i32, i64  => signed integers (sign bit flipped)
+    f32, f64           => float / double (-0.0 sorts before 0.0, NaNs sort at the ends)
+    str                => a fixed size char array, zero padded (compares like strcmp)
+
+    typedef struct {
+        int key;
+        int key2;
+        char name[16];
+    } item_t;
+
+    macro_key(item_key, item_t, (i32, key, asc), (i32, key2, desc), (str, name, asc));
+    // size_t item_key(unsigned char *dest, const item_t *src);
+    // enum { item_key_size = 24 };
+
+    The key is typically stored alongside the item (or an index to the item).
+
+    typedef struct {
+        unsigned char key[item_key_size];
+        uint32_t index;
+    } item_rec_t;
+
+    macro_key_sort(sort_recs, item_rec_t, key);          // introsort + memcmp
+    macro_key_radix_sort(radix_sort_recs, item_rec_t, key); // stable LSD radix sort
+    macro_key_bsearch(find_rec, lower_bound, item_rec_t, key);
+    // item_rec_t *find_rec(const unsigned char *key, const item_rec_t *base, size_t n);
+
+    The bytes comparison style (see macro_cmp.h) is what makes this work, so any
+    other generator (macro_map, macro_heap, ...) can use it as well.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "the-macro-library/macro_cmp.h"
+#include "the-macro-library/macro_sort.h"
+#include "the-macro-library/macro_merge_sort.h"
+#include "the-macro-library/macro_bsearch.h"
+#include "the-macro-library/src/macro_for_each.h"
+#include "the-macro-library/src/macro_radix_sort.h"
+
+static inline unsigned char *macro_key_put_u8(unsigned char *dest, uint8_t v) {
+    dest[0] = v;
+    return dest + 1;
+}
+
+static inline unsigned char *macro_key_put_u16(unsigned char *dest, uint16_t v) {
+    dest[0] = (unsigned char)(v >> 8);
+    dest[1] = (unsigned char)v;
+    return dest + 2;
+}
+
+static inline unsigned char *macro_key_put_u32(unsigned char *dest, uint32_t v) {
+    dest[0] = (unsigned char)(v >> 24);
+    dest[1] = (unsigned char)(v >> 16);
+    dest[2] = (unsigned char)(v >> 8);
+    dest[3] = (unsigned char)v;
+    return dest + 4;
+}
+
+static inline unsigned char *macro_key_put_u64(unsigned char *dest, uint64_t v) {
+    macro_key_put_u32(dest, (uint32_t)(v >> 32));
+    return macro_key_put_u32(dest + 4, (uint32_t)v);
+}
+
+static inline unsigned char *macro_key_put_i8(unsigned char *dest, int8_t v) {
+    return macro_key_put_u8(dest, (uint8_t)v ^ 0x80);
+}
+
+static inline unsigned char *macro_key_put_i16(unsigned char *dest, int16_t v) {
+    return macro_key_put_u16(dest, (uint16_t)v ^ 0x8000);
+}
+
+static inline unsigned char *macro_key_put_i32(unsigned char *dest, int32_t v) {
+    return macro_key_put_u32(dest, (uint32_t)v ^ 0x80000000U);
+}
+
+static inline unsigned char *macro_key_put_i64(unsigned char *dest, int64_t v) {
+    return macro_key_put_u64(dest, (uint64_t)v ^ 0x8000000000000000ULL);
+}
+
+/* negative numbers have all of their bits flipped, positive numbers only the sign bit */
+static inline unsigned char *macro_key_put_f32(unsigned char *dest, float v) {
+    uint32_t u;
+    memcpy(&u, &v, sizeof(u));
+    u = (u & 0x80000000U) ? ~u : (u | 0x80000000U);
+    return macro_key_put_u32(dest, u);
+}
+
+static inline unsigned char *macro_key_put_f64(unsigned char *dest, double v) {
+    uint64_t u;
+    memcpy(&u, &v, sizeof(u));
+    u = (u & 0x8000000000000000ULL) ? ~u : (u | 0x8000000000000000ULL);
+    return macro_key_put_u64(dest, u);
+}
+
+/* copies up to len bytes of s and zero pads the rest */
+static inline unsigned char *macro_key_put_str(unsigned char *dest, const char *s, size_t len) {
+    size_t i = 0;
+    while (i < len && s[i]) {
+        dest[i] = (unsigned char)s[i];
+        i++;
+    }
+    if (i < len)
+        memset(dest + i, 0, len - i);
+    return dest + len;
+}
+
+/* used for descending fields */
+static inline void macro_key_invert(unsigned char *p, size_t len) {
+    unsigned char *ep = p + len;
+    while (p < ep) {
+        *p = (unsigned char)~*p;
+        p++;
+    }
+}
+
+#define __macro_key_width_u8(type, field) 1
+#define __macro_key_width_u16(type, field) 2
+#define __macro_key_width_u32(type, field) 4
+#define __macro_key_width_u64(type, field) 8
+#define __macro_key_width_i8(type, field) 1
+#define __macro_key_width_i16(type, field) 2
+#define __macro_key_width_i32(type, field) 4
+#define __macro_key_width_i64(type, field) 8
+#define __macro_key_width_f32(type, field) 4
+#define __macro_key_width_f64(type, field) 8
+#define __macro_key_width_str(type, field) sizeof(((type *)0)->field)
+
+#define __macro_key_put_u8(field) p = macro_key_put_u8(p, (uint8_t)src->field)
+#define __macro_key_put_u16(field) p = macro_key_put_u16(p, (uint16_t)src->field)
+#define __macro_key_put_u32(field) p = macro_key_put_u32(p, (uint32_t)src->field)
+#define __macro_key_put_u64(field) p = macro_key_put_u64(p, (uint64_t)src->field)
+#define __macro_key_put_i8(field) p = macro_key_put_i8(p, (int8_t)src->field)
+#define __macro_key_put_i16(field) p = macro_key_put_i16(p, (int16_t)src->field)
+#define __macro_key_put_i32(field) p = macro_key_put_i32(p, (int32_t)src->field)
+#define __macro_key_put_i64(field) p = macro_key_put_i64(p, (int64_t)src->field)
+#define __macro_key_put_f32(field) p = macro_key_put_f32(p, (float)src->field)
+#define __macro_key_put_f64(field) p = macro_key_put_f64(p, (double)src->field)
+#define __macro_key_put_str(field) p = macro_key_put_str(p, src->field, sizeof(src->field))
+
+#define __macro_key_order_asc(p, width)
+#define __macro_key_order_desc(p, width) macro_key_invert((p) - (width), (width));
+
+#define __macro_key_field(type, kind, field, order)    \
+    __macro_key_put_ ## kind(field);                   \
+    __macro_key_order_ ## order(p, __macro_key_width_ ## kind(type, field))
+
+#define __macro_key_field_width(type, kind, field, order) + __macro_key_width_ ## kind(type, field)
+
+#define __macro_key_put_field(type, t) __macro_apply(__macro_key_field, type, t)
+#define __macro_key_add_width(type, t) __macro_apply(__macro_key_field_width, type, t)
+
+/* the number of bytes the encoded key requires (a constant expression) */
+#define macro_key_size(type, ...) (0 __macro_for_each(__macro_key_add_width, type, __VA_ARGS__))
+
+#define macro_key_h(name, type) size_t name(unsigned char *dest, const type *src)
+
+/* defines the encoding function and name_size as an enum */
+#define macro_key(name, type, ...)                                     \
+    macro_key_h(name, type) {                                          \
+        unsigned char *p = dest;                                       \
+        __macro_for_each(__macro_key_put_field, type, __VA_ARGS__)     \
+        return p - dest;                                               \
+    }                                                                  \
+    enum { name ## _size = macro_key_size(type, __VA_ARGS__) }
+
+/* sort / search arrays of records which contain an encoded key field */
+#define macro_key_sort_h(name, type) _macro_sort_h(name, bytes, type)
+#define macro_key_sort(name, type, field) _macro_sort(name, bytes, type, field)
+
+#define macro_key_bsearch_h(name, type) _macro_bsearch_kv_h(name, bytes, unsigned char, type)
+#define macro_key_bsearch(name, bsearch_style, type, field)    \
+    _macro_bsearch_kv(name, bsearch_style, bytes, unsigned char, type, field)
+
+/*
+    The radix sort needs a scratch buffer of n elements.  Small arrays are sorted with an
+    insertion sort instead, and if the buffer can't be allocated the array is sorted with
+    the merge sort (which needs half as much scratch memory), so equal keys always keep
+    their order (unless the merge sort can't allocate its buffer either, in which case
+    it falls back to the introsort).
+*/
+#define macro_key_radix_sort_h(name, type) void name(type *base, size_t n)
+
+#define macro_key_radix_sort(name, type, field)                           \
+    macro_key_radix_sort_h(name, type) {                                  \
+        type *buf, *a, *b, *e;                                            \
+        type tmp;                                                         \
+        if(n < 256) {                                                     \
+            macro_isort(bytes, type, field, base, n, e, a, b, tmp);       \
+            return;                                                       \
+        }                                                                 \
+        buf = (type *)malloc(n * sizeof(type));                           \
+        if(!buf) {                                                        \
+            __macro_merge_sort_body(bytes, type, field);                  \
+            return;                                                       \
+        }                                                                 \
+        __macro_radix_sort_bytes_code(type, field, base, n, buf);         \
+        free(buf);                                                        \
+    }
+
+#endif /* _macro_key_H */
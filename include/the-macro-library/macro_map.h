@@ -34,9 +34,31 @@ typedef macro_map_t *(*macro_map_copy_node_cb)(macro_map_t *n, void *arg);
 
 static macro_map_t *macro_map_copy(macro_map_t *root, macro_map_copy_node_cb copy, void *arg);
 
-static bool macro_map_erase(macro_map_t **root, macro_map_t *node);
+static inline bool macro_map_erase(macro_map_t **root, macro_map_t *node);
 
-static void _macro_map_fix_insert(macro_map_t *node, macro_map_t *parent, macro_map_t **root);
+/*
+  macro_map_build_sorted links n nodes which are already in sorted order into a
+  balanced red black tree and returns the root.  It makes no comparisons and runs in
+  O(n), so it is much faster than inserting the nodes one at a time (the caller must
+  make sure the order matches the compare function used to search the tree).
+  macro_map_build_sorted_list does the same for a list of nodes linked through their
+  right pointers.
+*/
+static inline macro_map_t *macro_map_build_sorted(macro_map_t **nodes, size_t n);
+static inline macro_map_t *macro_map_build_sorted_list(macro_map_t *head);
+
+/*
+  macro_map_update_cb recomputes a summary kept in a node (such as the size of its
+  subtree) from the node and its children.  The balancing code below calls it on every
+  node whose subtree changes in the _update versions (see macro_map_augment.h).  Plain
+  maps use versions without the callback.
+*/
+typedef void (*macro_map_update_cb)(macro_map_t *n);
+
+static inline void _macro_map_fix_insert(macro_map_t *node, macro_map_t *parent,
+                                         macro_map_t **root);
+static inline void _macro_map_fix_insert_update(macro_map_t *node, macro_map_t *parent,
+                                                macro_map_t **root, macro_map_update_cb update);
 
 #define macro_map_color(n) ((n)->parent_color & 1)
 #define _macro_map_is_red(n) (((n)->parent_color & 1) == 0)
@@ -50,6 +72,15 @@ static void _macro_map_fix_insert(macro_map_t *node, macro_map_t *parent, macro_
 
 #define _macro_map_clear_black(n) (n)->parent_color = 1
 
+/* the links of a node in the tree are stored atomically (a plain store on the common
+   platforms), so that the readers of macro_map_concurrent.h can follow them while a
+   writer changes the tree */
+#ifdef __GNUC__
+#define _macro_map_set_link(link, n) __atomic_store_n(&(link), (macro_map_t *)(n), __ATOMIC_RELAXED)
+#else
+#define _macro_map_set_link(link, n) ((link) = (macro_map_t *)(n))
+#endif
+
 /* iteration */
 static inline macro_map_t *macro_map_first(macro_map_t *n) {
     if (!n)
@@ -145,145 +176,72 @@ static inline macro_map_t *macro_map_copy(macro_map_t *root, macro_map_copy_node
     return res;
 }
 
-static inline void _macro_map_rotate_left(macro_map_t *A, macro_map_t **root) {
-    macro_map_t *new_root = A->right;
-
-    size_t tmp_pc = A->parent_color;
-    A->parent_color = new_root->parent_color;
-    new_root->parent_color = tmp_pc;
-    macro_map_t *parent = _macro_map_parent(new_root);
-    if (parent) {
-        if (parent->left == A)
-            parent->left = new_root;
-        else
-            parent->right = new_root;
-    } else
-        *root = new_root;
+/* build from sorted nodes */
 
-    macro_map_t *tmp = new_root->left;
-    new_root->left = A;
-    _macro_map_set_parent(A, new_root);
-
-    A->right = tmp;
-    if (tmp)
-        _macro_map_set_parent(tmp, A);
+/* the tree is perfectly balanced, so if the last level isn't full, its nodes are
+   red and all of the other nodes are black */
+static inline size_t _macro_map_red_depth(size_t n) {
+    size_t levels = 0, m = n;
+    while (m) {
+        levels++;
+        m >>= 1;
+    }
+    if (((n + 1) & n) == 0)
+        return (size_t)-1;
+    return levels - 1;
 }
 
-static void _macro_map_rotate_right(macro_map_t *A, macro_map_t **root) {
-    macro_map_t *new_root = A->left;
-    size_t tmp_pc = A->parent_color;
-    A->parent_color = new_root->parent_color;
-    new_root->parent_color = tmp_pc;
-    macro_map_t *parent = _macro_map_parent(new_root);
-    if (parent) {
-        if (parent->left == A)
-            parent->left = new_root;
-        else
-            parent->right = new_root;
-    } else
-        *root = new_root;
-
-    macro_map_t *tmp = new_root->right;
-    new_root->right = A;
-    _macro_map_set_parent(A, new_root);
+static inline void _macro_map_link_children(macro_map_t *n, size_t depth, size_t red_depth) {
+    n->parent_color = depth == red_depth ? 0 : 1;
+    if (n->left)
+        _macro_map_set_parent(n->left, n);
+    if (n->right)
+        _macro_map_set_parent(n->right, n);
+}
 
-    A->left = tmp;
-    if (tmp)
-        _macro_map_set_parent(tmp, A);
+static macro_map_t *_macro_map_build_sorted(macro_map_t **nodes, size_t n, size_t depth,
+                                            size_t red_depth) {
+    if (!n)
+        return NULL;
+    size_t mid = n >> 1;
+    macro_map_t *r = nodes[mid];
+    r->left = _macro_map_build_sorted(nodes, mid, depth + 1, red_depth);
+    r->right = _macro_map_build_sorted(nodes + mid + 1, n - mid - 1, depth + 1, red_depth);
+    _macro_map_link_children(r, depth, red_depth);
+    return r;
 }
 
-static void _macro_map_fix_insert(macro_map_t *node, macro_map_t *parent, macro_map_t **root) {
-    _macro_map_set_red(node);
-    _macro_map_set_parent(node, parent);
-    node->left = node->right = NULL;
+static macro_map_t *_macro_map_build_sorted_list(macro_map_t **head, size_t n, size_t depth,
+                                                 size_t red_depth) {
+    if (!n)
+        return NULL;
+    size_t mid = n >> 1;
+    macro_map_t *left = _macro_map_build_sorted_list(head, mid, depth + 1, red_depth);
+    macro_map_t *r = *head;
+    *head = r->right;
+    r->left = left;
+    r->right = _macro_map_build_sorted_list(head, n - mid - 1, depth + 1, red_depth);
+    _macro_map_link_children(r, depth, red_depth);
+    return r;
+}
 
-    macro_map_t *grandparent, *uncle;
+static inline macro_map_t *macro_map_build_sorted(macro_map_t **nodes, size_t n) {
+    return _macro_map_build_sorted(nodes, n, 0, _macro_map_red_depth(n));
+}
 
-    while (true) {
-        parent = _macro_map_parent(node);
-        if (!parent) {
-            _macro_map_clear_black(node);
-            break;
-        }
-
-        if (_macro_map_is_black(parent))
-            break;
-
-        grandparent = _macro_map_parent(parent);
-        if (grandparent->left == parent) {
-            uncle = grandparent->right;
-            if (uncle && _macro_map_is_red(uncle)) {
-                _macro_map_set_red(grandparent);
-                _macro_map_set_black(parent);
-                _macro_map_set_black(uncle);
-                node = grandparent;
-                continue;
-            }
-            if (parent->right == node)
-                _macro_map_rotate_left(parent, NULL);
-            _macro_map_rotate_right(grandparent, root);
-            break;
-        } else {
-            uncle = grandparent->left;
-            if (uncle && _macro_map_is_red(uncle)) {
-                _macro_map_set_red(grandparent);
-                _macro_map_set_black(parent);
-                _macro_map_set_black(uncle);
-                node = grandparent;
-                continue;
-            }
-            if (parent->left == node)
-                _macro_map_rotate_right(parent, NULL);
-            _macro_map_rotate_left(grandparent, root);
-            break;
-        }
-    }
+static inline macro_map_t *macro_map_build_sorted_list(macro_map_t *head) {
+    size_t n = 0;
+    macro_map_t *p;
+    for (p = head; p; p = p->right)
+        n++;
+    return _macro_map_build_sorted_list(&head, n, 0, _macro_map_red_depth(n));
 }
 
-static inline
-void _fix_color_for_erase(macro_map_t *parent, macro_map_t *node,
-                          macro_map_t **root) {
-    macro_map_t *sibling;
-    if (parent->right != node) {
-        sibling = parent->right;
-        if (_macro_map_is_red(sibling)) {
-            _macro_map_rotate_left(parent, root);
-            sibling = parent->right;
-        }
-        if (sibling->right && _macro_map_is_red(sibling->right)) {
-            _macro_map_set_black(sibling->right);
-            _macro_map_rotate_left(parent, root);
-        } else if (sibling->left && _macro_map_is_red(sibling->left)) {
-            _macro_map_rotate_right(sibling, root);
-            _macro_map_rotate_left(parent, root);
-            _macro_map_set_black(sibling);
-        } else {
-            _macro_map_set_red(sibling);
-            if (_macro_map_parent(parent) && _macro_map_is_black(parent))
-                _fix_color_for_erase(_macro_map_parent(parent), parent, root);
-            else
-                _macro_map_set_black(parent);
-        }
-    } else {
-        sibling = parent->left;
-        if (_macro_map_is_red(sibling)) {
-            _macro_map_rotate_right(parent, root);
-            sibling = parent->left;
-        }
-        if (sibling->left && _macro_map_is_red(sibling->left)) {
-            _macro_map_set_black(sibling->left);
-            _macro_map_rotate_right(parent, root);
-        } else if (sibling->right && _macro_map_is_red(sibling->right)) {
-            _macro_map_rotate_left(sibling, root);
-            _macro_map_rotate_right(parent, root);
-            _macro_map_set_black(sibling);
-        } else {
-            _macro_map_set_red(sibling);
-            if (_macro_map_parent(parent) && _macro_map_is_black(parent))
-                _fix_color_for_erase(_macro_map_parent(parent), parent, root);
-            else
-                _macro_map_set_black(parent);
-        }
+/* calls update on n and each of its ancestors */
+static inline void _macro_map_update_path(macro_map_t *n, macro_map_update_cb update) {
+    while (n) {
+        update(n);
+        n = _macro_map_parent(n);
     }
 }
 
@@ -292,69 +250,249 @@ static inline void _replace_node_with_child(macro_map_t *child, macro_map_t *nod
     macro_map_t *parent = _macro_map_parent(node);
     if (parent) {
         if (parent->left == node)
-            parent->left = child;
+            _macro_map_set_link(parent->left, child);
         else
-            parent->right = child;
+            _macro_map_set_link(parent->right, child);
     } else
-        *root = child;
+        _macro_map_set_link(*root, child);
 
     child->parent_color = node->parent_color;
 }
 
-static bool macro_map_erase(macro_map_t **root, macro_map_t *node) {
-    macro_map_t *parent = _macro_map_parent(node);
-    if (!node->left) {
-        if (node->right)
-            _replace_node_with_child(node->right, node, root);
-        else {
-            if (parent) {
-                if (parent->left == node)
-                    parent->left = NULL;
-                else
-                    parent->right = NULL;
-                if (_macro_map_is_black(node))
-                    _fix_color_for_erase(parent, NULL, root);
-            } else
-                *root = NULL;
-        }
-    } else if (!node->right)
-        _replace_node_with_child(node->left, node, root);
-    else {
-        macro_map_t *successor = node->right;
-        if (!successor->left) {
-            bool black = _macro_map_is_black(successor);
-            _replace_node_with_child(successor, node, root);
-            successor->left = node->left;
-            _macro_map_set_parent(successor->left, successor);
-            if (successor->right)
-                _macro_map_set_black(successor->right);
-            else {
-                if (black)
-                    _fix_color_for_erase(successor, NULL, root);
-            }
-        } else {
-            while (successor->left)
-                successor = successor->left;
-
-            bool black = _macro_map_is_black(successor);
-            macro_map_t *right = successor->right;
-            macro_map_t *parent = _macro_map_parent(successor);
-            parent->left = right;
-            if (right) {
-                _macro_map_clear_black(right);
-                _macro_map_set_parent(right, parent);
-                black = false;
-            }
-            _replace_node_with_child(successor, node, root);
-            successor->left = node->left;
-            _macro_map_set_parent(successor->left, successor);
-            successor->right = node->right;
-            _macro_map_set_parent(successor->right, successor);
-            if (black)
-                _fix_color_for_erase(parent, NULL, root);
-        }
-    }
-    return true;
+/*
+  The balancing code is generated twice.  The plain functions are used by every map,
+  and the _update functions by macro_map_augment.h, which call update on each node
+  whose subtree changes.  param and arg add the callback to the signatures and calls,
+  update_node and update_path (n and its ancestors) call it.
+*/
+#define _macro_map_balance_code(sfx, param, arg, update_node, update_path)                       \
+static inline void _macro_map_rotate_left##sfx(macro_map_t *A, macro_map_t **root param()) {     \
+    macro_map_t *new_root = A->right;                                                            \
+                                                                                                 \
+    size_t tmp_pc = A->parent_color;                                                             \
+    A->parent_color = new_root->parent_color;                                                    \
+    new_root->parent_color = tmp_pc;                                                             \
+    macro_map_t *parent = _macro_map_parent(new_root);                                           \
+    if (parent) {                                                                                \
+        if (parent->left == A)                                                                   \
+            _macro_map_set_link(parent->left, new_root);                                         \
+        else                                                                                     \
+            _macro_map_set_link(parent->right, new_root);                                        \
+    } else                                                                                       \
+        _macro_map_set_link(*root, new_root);                                                    \
+                                                                                                 \
+    macro_map_t *tmp = new_root->left;                                                           \
+    _macro_map_set_link(new_root->left, A);                                                      \
+    _macro_map_set_parent(A, new_root);                                                          \
+                                                                                                 \
+    _macro_map_set_link(A->right, tmp);                                                          \
+    if (tmp)                                                                                     \
+        _macro_map_set_parent(tmp, A);                                                           \
+                                                                                                 \
+    update_node(A);                                                                              \
+    update_node(new_root);                                                                       \
+}                                                                                                \
+                                                                                                 \
+static inline void _macro_map_rotate_right##sfx(macro_map_t *A, macro_map_t **root param()) {    \
+    macro_map_t *new_root = A->left;                                                             \
+    size_t tmp_pc = A->parent_color;                                                             \
+    A->parent_color = new_root->parent_color;                                                    \
+    new_root->parent_color = tmp_pc;                                                             \
+    macro_map_t *parent = _macro_map_parent(new_root);                                           \
+    if (parent) {                                                                                \
+        if (parent->left == A)                                                                   \
+            _macro_map_set_link(parent->left, new_root);                                         \
+        else                                                                                     \
+            _macro_map_set_link(parent->right, new_root);                                        \
+    } else                                                                                       \
+        _macro_map_set_link(*root, new_root);                                                    \
+                                                                                                 \
+    macro_map_t *tmp = new_root->right;                                                          \
+    _macro_map_set_link(new_root->right, A);                                                     \
+    _macro_map_set_parent(A, new_root);                                                          \
+                                                                                                 \
+    _macro_map_set_link(A->left, tmp);                                                           \
+    if (tmp)                                                                                     \
+        _macro_map_set_parent(tmp, A);                                                           \
+                                                                                                 \
+    update_node(A);                                                                              \
+    update_node(new_root);                                                                       \
+}                                                                                                \
+                                                                                                 \
+static inline void _macro_map_fix_insert##sfx(macro_map_t *node, macro_map_t *parent,            \
+                                            macro_map_t **root param()) {                        \
+    _macro_map_set_red(node);                                                                    \
+    _macro_map_set_parent(node, parent);                                                         \
+    _macro_map_set_link(node->left, NULL);                                                       \
+    _macro_map_set_link(node->right, NULL);                                                      \
+    update_path(node);                                                                           \
+                                                                                                 \
+    macro_map_t *grandparent, *uncle;                                                            \
+                                                                                                 \
+    while (true) {                                                                               \
+        parent = _macro_map_parent(node);                                                        \
+        if (!parent) {                                                                           \
+            _macro_map_clear_black(node);                                                        \
+            break;                                                                               \
+        }                                                                                        \
+                                                                                                 \
+        if (_macro_map_is_black(parent))                                                         \
+            break;                                                                               \
+                                                                                                 \
+        grandparent = _macro_map_parent(parent);                                                 \
+        if (grandparent->left == parent) {                                                       \
+            uncle = grandparent->right;                                                          \
+            if (uncle && _macro_map_is_red(uncle)) {                                             \
+                _macro_map_set_red(grandparent);                                                 \
+                _macro_map_set_black(parent);                                                    \
+                _macro_map_set_black(uncle);                                                     \
+                node = grandparent;                                                              \
+                continue;                                                                        \
+            }                                                                                    \
+            if (parent->right == node)                                                           \
+                _macro_map_rotate_left##sfx(parent, NULL arg());                                 \
+            _macro_map_rotate_right##sfx(grandparent, root arg());                               \
+            break;                                                                               \
+        } else {                                                                                 \
+            uncle = grandparent->left;                                                           \
+            if (uncle && _macro_map_is_red(uncle)) {                                             \
+                _macro_map_set_red(grandparent);                                                 \
+                _macro_map_set_black(parent);                                                    \
+                _macro_map_set_black(uncle);                                                     \
+                node = grandparent;                                                              \
+                continue;                                                                        \
+            }                                                                                    \
+            if (parent->left == node)                                                            \
+                _macro_map_rotate_right##sfx(parent, NULL arg());                                \
+            _macro_map_rotate_left##sfx(grandparent, root arg());                                \
+            break;                                                                               \
+        }                                                                                        \
+    }                                                                                            \
+}                                                                                                \
+                                                                                                 \
+static inline                                                                                    \
+void _fix_color_for_erase##sfx(macro_map_t *parent, macro_map_t *node,                           \
+                               macro_map_t **root param()) {                                     \
+    macro_map_t *sibling;                                                                        \
+    if (parent->right != node) {                                                                 \
+        sibling = parent->right;                                                                 \
+        if (_macro_map_is_red(sibling)) {                                                        \
+            _macro_map_rotate_left##sfx(parent, root arg());                                     \
+            sibling = parent->right;                                                             \
+        }                                                                                        \
+        if (sibling->right && _macro_map_is_red(sibling->right)) {                               \
+            _macro_map_set_black(sibling->right);                                                \
+            _macro_map_rotate_left##sfx(parent, root arg());                                     \
+        } else if (sibling->left && _macro_map_is_red(sibling->left)) {                          \
+            _macro_map_rotate_right##sfx(sibling, root arg());                                   \
+            _macro_map_rotate_left##sfx(parent, root arg());                                     \
+            _macro_map_set_black(sibling);                                                       \
+        } else {                                                                                 \
+            _macro_map_set_red(sibling);                                                         \
+            if (_macro_map_parent(parent) && _macro_map_is_black(parent))                        \
+                _fix_color_for_erase##sfx(_macro_map_parent(parent), parent, root arg());        \
+            else                                                                                 \
+                _macro_map_set_black(parent);                                                    \
+        }                                                                                        \
+    } else {                                                                                     \
+        sibling = parent->left;                                                                  \
+        if (_macro_map_is_red(sibling)) {                                                        \
+            _macro_map_rotate_right##sfx(parent, root arg());                                    \
+            sibling = parent->left;                                                              \
+        }                                                                                        \
+        if (sibling->left && _macro_map_is_red(sibling->left)) {                                 \
+            _macro_map_set_black(sibling->left);                                                 \
+            _macro_map_rotate_right##sfx(parent, root arg());                                    \
+        } else if (sibling->right && _macro_map_is_red(sibling->right)) {                        \
+            _macro_map_rotate_left##sfx(sibling, root arg());                                    \
+            _macro_map_rotate_right##sfx(parent, root arg());                                    \
+            _macro_map_set_black(sibling);                                                       \
+        } else {                                                                                 \
+            _macro_map_set_red(sibling);                                                         \
+            if (_macro_map_parent(parent) && _macro_map_is_black(parent))                        \
+                _fix_color_for_erase##sfx(_macro_map_parent(parent), parent, root arg());        \
+            else                                                                                 \
+                _macro_map_set_black(parent);                                                    \
+        }                                                                                        \
+    }                                                                                            \
+}                                                                                                \
+                                                                                                 \
+/* the summaries are brought up to date from the lowest changed node before the */               \
+/* colors are fixed (the rotations rely on correct children) */                                  \
+static inline bool _macro_map_erase##sfx(macro_map_t **root, macro_map_t *node param()) {        \
+    macro_map_t *parent = _macro_map_parent(node);                                               \
+    macro_map_t *changed = parent, *fix = NULL;                                                  \
+    if (!node->left) {                                                                           \
+        if (node->right)                                                                         \
+            _replace_node_with_child(node->right, node, root);                                   \
+        else {                                                                                   \
+            if (parent) {                                                                        \
+                if (parent->left == node)                                                        \
+                    _macro_map_set_link(parent->left, NULL);                                     \
+                else                                                                             \
+                    _macro_map_set_link(parent->right, NULL);                                    \
+                if (_macro_map_is_black(node))                                                   \
+                    fix = parent;                                                                \
+            } else                                                                               \
+                _macro_map_set_link(*root, NULL);                                                \
+        }                                                                                        \
+    } else if (!node->right)                                                                     \
+        _replace_node_with_child(node->left, node, root);                                        \
+    else {                                                                                       \
+        macro_map_t *successor = node->right;                                                    \
+        if (!successor->left) {                                                                  \
+            bool black = _macro_map_is_black(successor);                                         \
+            _replace_node_with_child(successor, node, root);                                     \
+            _macro_map_set_link(successor->left, node->left);                                    \
+            _macro_map_set_parent(successor->left, successor);                                   \
+            if (successor->right)                                                                \
+                _macro_map_set_black(successor->right);                                          \
+            else if (black)                                                                      \
+                fix = successor;                                                                 \
+            changed = successor;                                                                 \
+        } else {                                                                                 \
+            while (successor->left)                                                              \
+                successor = successor->left;                                                     \
+                                                                                                 \
+            bool black = _macro_map_is_black(successor);                                         \
+            macro_map_t *right = successor->right;                                               \
+            macro_map_t *parent = _macro_map_parent(successor);                                  \
+            _macro_map_set_link(parent->left, right);                                            \
+            if (right) {                                                                         \
+                _macro_map_clear_black(right);                                                   \
+                _macro_map_set_parent(right, parent);                                            \
+                black = false;                                                                   \
+            }                                                                                    \
+            _replace_node_with_child(successor, node, root);                                     \
+            _macro_map_set_link(successor->left, node->left);                                    \
+            _macro_map_set_parent(successor->left, successor);                                   \
+            _macro_map_set_link(successor->right, node->right);                                  \
+            _macro_map_set_parent(successor->right, successor);                                  \
+            if (black)                                                                           \
+                fix = parent;                                                                    \
+            changed = parent;                                                                    \
+        }                                                                                        \
+    }                                                                                            \
+    update_path(changed);                                                                        \
+    if (fix)                                                                                     \
+        _fix_color_for_erase##sfx(fix, NULL, root arg());                                        \
+    return true;                                                                                 \
+}
+
+#define _macro_map_no_arg()
+#define _macro_map_no_update(n) (void)(n)
+#define _macro_map_update_param() , macro_map_update_cb update
+#define _macro_map_update_arg() , update
+#define _macro_map_call_update(n) update(n)
+#define _macro_map_call_update_path(n) _macro_map_update_path(n, update)
+
+_macro_map_balance_code(, _macro_map_no_arg, _macro_map_no_arg, _macro_map_no_update,
+                        _macro_map_no_update)
+_macro_map_balance_code(_update, _macro_map_update_param, _macro_map_update_arg,
+                        _macro_map_call_update, _macro_map_call_update_path)
+
+static inline bool macro_map_erase(macro_map_t **root, macro_map_t *node) {
+    return _macro_map_erase(root, node);
 }
 
 /*
@@ -579,10 +717,26 @@ static bool macro_map_erase(macro_map_t **root, macro_map_t *node) {
         else                                                                             \
             return false;                                                                \
     }                                                                                    \
-    *np = &node->field;                                                                  \
+    _macro_map_set_link(*np, &node->field);                                              \
     _macro_map_fix_insert(*np, parent, root);                                            \
     return true;
 
+#define _macro_map_insert_update_code(root, style, value_type, cmp, node, update)    \
+    macro_map_t **np = root, *parent = NULL;                                         \
+    while (*np) {                                                                    \
+        parent = *np;                                                                \
+        int n = macro_cmp(style, value_type, cmp, node, parent);                     \
+        if(n < 0)                                                                    \
+            np = &(parent->left);                                                    \
+        else if (n > 0)                                                              \
+            np = &(parent->right);                                                   \
+        else                                                                         \
+            return false;                                                            \
+    }                                                                                \
+    _macro_map_set_link(*np, node);                                                  \
+    _macro_map_fix_insert_update(*np, parent, root, update);                         \
+    return true;
+
 #define _macro_map_insert_code(root, style, value_type, cmp, node )    \
     macro_map_t **np = root, *parent = NULL;                           \
     while (*np) {                                                      \
@@ -595,7 +749,7 @@ static bool macro_map_erase(macro_map_t **root, macro_map_t *node) {
         else                                                           \
             return false;                                              \
     }                                                                  \
-    *np = (macro_map_t *)node;                                         \
+    _macro_map_set_link(*np, node);                                    \
     _macro_map_fix_insert(*np, parent, root);                          \
     return true;
 
@@ -618,10 +772,32 @@ static bool macro_map_erase(macro_map_t **root, macro_map_t *node) {
                 return false;                                                                 \
         }                                                                                     \
     }                                                                                         \
-    *np = &node->field;                                                                       \
+    _macro_map_set_link(*np, &node->field);                                                   \
     _macro_map_fix_insert(*np, parent, root);                                                 \
     return true;
 
+#define _macro_multimap_insert_update_code(root, style, value_type, cmp, node, update)    \
+    macro_map_t **np = root, *parent = NULL;                                              \
+    while (*np) {                                                                         \
+        parent = *np;                                                                     \
+        int n = macro_cmp(style, value_type, cmp, node, parent);                          \
+        if(n < 0)                                                                         \
+            np = &(parent->left);                                                         \
+        else if (n > 0)                                                                   \
+            np = &(parent->right);                                                        \
+        else {                                                                            \
+            if (node < (value_type *)parent)                                              \
+                np = &(parent->left);                                                     \
+            else if (node > (value_type *)parent)                                         \
+                np = &(parent->right);                                                    \
+            else                                                                          \
+                return false;                                                             \
+        }                                                                                 \
+    }                                                                                     \
+    _macro_map_set_link(*np, node);                                                       \
+    _macro_map_fix_insert_update(*np, parent, root, update);                              \
+    return true;
+
 #define _macro_multimap_insert_code(root, style, value_type, cmp, node )    \
     macro_map_t **np = root, *parent = NULL;                                \
     while (*np) {                                                           \
@@ -640,7 +816,7 @@ static bool macro_map_erase(macro_map_t **root, macro_map_t *node) {
                 return false;                                               \
         }                                                                   \
     }                                                                       \
-    *np = (macro_map_t *)node;                                              \
+    _macro_map_set_link(*np, node);                                         \
     _macro_map_fix_insert(*np, parent, root);                               \
     return true;
 
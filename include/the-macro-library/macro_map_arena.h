@@ -0,0 +1,172 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_map_arena_H
+#define _macro_map_arena_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "the-macro-library/macro_map.h"
+
+/*
+    An arena for intrusive macro_map_t nodes which are followed by a variable length
+    key (such as the nodes of macro_string_id_map.h and macro_string_string_map.h).
+    The node and its key are carved out of one contiguous piece of a large block, so
+    an insert costs a pointer bump instead of a malloc.
+
+    Sizes are rounded up to a multiple of 16 bytes, and each size up to
+    MACRO_MAP_ARENA_MAX has its own free list, so erased nodes are reused by later
+    inserts of a similar size.  Larger allocations get a block of their own, which is
+    only released by macro_map_arena_clear or macro_map_arena_destroy.
+
+    macro_map_arena_t arena;
+    macro_map_arena_init(&arena, 65536);
+
+    macro_string_id_map_t *node = (macro_string_id_map_t *)
+        macro_map_arena_alloc_key(&arena, sizeof(*node), key, strlen(key));
+    node->id = id;
+    _macro_string_id_insert(&root, node);
+
+    // when the tree is discarded, its nodes go back on the free lists
+    macro_map_arena_free_tree(&arena, root, macro_string_id_map_size, NULL);
+    // or, if the arena only holds this tree, release everything at once
+    macro_map_arena_destroy(&arena);
+
+    macro_map_arena_free and macro_map_arena_free_tree need the size which was
+    allocated, so the size callback computes it from the node (the node size plus the
+    key length and terminator).
+*/
+
+#ifndef MACRO_MAP_ARENA_MAX
+#define MACRO_MAP_ARENA_MAX 1024
+#endif
+
+#define __macro_map_arena_classes (MACRO_MAP_ARENA_MAX / 16)
+
+typedef struct macro_map_arena_block_s {
+    struct macro_map_arena_block_s *next;
+    size_t size;
+} macro_map_arena_block_t;
+
+typedef struct macro_map_arena_free_s {
+    struct macro_map_arena_free_s *next;
+} macro_map_arena_free_t;
+
+typedef struct {
+    macro_map_arena_block_t *blocks;
+    char *p;
+    char *ep;
+    size_t block_size;
+    macro_map_arena_free_t *free_lists[__macro_map_arena_classes];
+} macro_map_arena_t;
+
+/* returns the number of bytes allocated for the node n */
+typedef size_t (*macro_map_arena_size_cb)(const macro_map_t *n, void *arg);
+
+static inline void macro_map_arena_init(macro_map_arena_t *a, size_t block_size) {
+    memset(a, 0, sizeof(*a));
+    if(block_size < MACRO_MAP_ARENA_MAX)
+        block_size = MACRO_MAP_ARENA_MAX;
+    a->block_size = block_size;
+}
+
+/* releases every allocation, the arena can be used again */
+static inline void macro_map_arena_clear(macro_map_arena_t *a) {
+    macro_map_arena_block_t *b = a->blocks, *next;
+    while(b) {
+        next = b->next;
+        free(b);
+        b = next;
+    }
+    macro_map_arena_init(a, a->block_size);
+}
+
+static inline void macro_map_arena_destroy(macro_map_arena_t *a) {
+    macro_map_arena_clear(a);
+}
+
+static inline void *macro_map_arena_alloc(macro_map_arena_t *a, size_t size) {
+    size_t c = (size + 15) >> 4;
+    macro_map_arena_block_t *b;
+    void *r;
+    if(!c)
+        c = 1;
+    if(c <= __macro_map_arena_classes) {
+        if(a->free_lists[c - 1]) {
+            r = a->free_lists[c - 1];
+            a->free_lists[c - 1] = a->free_lists[c - 1]->next;
+            return r;
+        }
+        if((size_t)(a->ep - a->p) < (c << 4)) {
+            b = (macro_map_arena_block_t *)malloc(sizeof(*b) + a->block_size);
+            if(!b)
+                return NULL;
+            /* the rest of the old block is kept on its free list */
+            if(a->ep - a->p >= 16) {
+                macro_map_arena_free_t *f = (macro_map_arena_free_t *)a->p;
+                f->next = a->free_lists[((a->ep - a->p) >> 4) - 1];
+                a->free_lists[((a->ep - a->p) >> 4) - 1] = f;
+            }
+            b->next = a->blocks;
+            b->size = a->block_size;
+            a->blocks = b;
+            a->p = (char *)(b + 1);
+            a->ep = a->p + a->block_size;
+        }
+        r = a->p;
+        a->p += c << 4;
+        return r;
+    }
+    /* large allocations are put behind the current block */
+    b = (macro_map_arena_block_t *)malloc(sizeof(*b) + size);
+    if(!b)
+        return NULL;
+    b->size = size;
+    if(a->blocks) {
+        b->next = a->blocks->next;
+        a->blocks->next = b;
+    } else {
+        b->next = NULL;
+        a->blocks = b;
+    }
+    return b + 1;
+}
+
+/* size must be the size passed to macro_map_arena_alloc */
+static inline void macro_map_arena_free(macro_map_arena_t *a, void *p, size_t size) {
+    size_t c = (size + 15) >> 4;
+    macro_map_arena_free_t *f = (macro_map_arena_free_t *)p;
+    if(!c)
+        c = 1;
+    if(!p || c > __macro_map_arena_classes)
+        return;
+    f->next = a->free_lists[c - 1];
+    a->free_lists[c - 1] = f;
+}
+
+/* allocates node_size bytes followed by a copy of key and a zero terminator */
+static inline void *macro_map_arena_alloc_key(macro_map_arena_t *a, size_t node_size,
+                                              const void *key, size_t key_len) {
+    char *r = (char *)macro_map_arena_alloc(a, node_size + key_len + 1);
+    if(!r)
+        return NULL;
+    memcpy(r + node_size, key, key_len);
+    r[node_size + key_len] = 0;
+    return r;
+}
+
+/* returns every node of the tree to the free lists (the tree can't be used after) */
+static inline void macro_map_arena_free_tree(macro_map_arena_t *a, macro_map_t *root,
+                                             macro_map_arena_size_cb size, void *arg) {
+    macro_map_t *n = macro_map_postorder_first(root), *next;
+    while(n) {
+        /* the next node is found before n is overwritten by the free list */
+        next = macro_map_postorder_next(n);
+        macro_map_arena_free(a, n, size(n, arg));
+        n = next;
+    }
+}
+
+#endif /* _macro_map_arena_H */
@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_map_augment_H
+#define _macro_map_augment_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "the-macro-library/macro_map.h"
+
+/*
+    The red black tree of macro_map.h with a value per node which summarizes its
+    subtree (such as the number of nodes, or the largest end of a set of intervals).
+    The node type starts with a macro_map_t followed by the summary, and the update
+    callback recomputes the summary of one node from the node and its children.
+
+    Inserts and erases call update on every node from the change up to the root, and
+    on the two nodes of each rotation, so the summaries stay correct in O(log n).  The
+    tree can be searched and iterated with all of the macro_map.h functions, but must
+    only be changed through the functions below (macro_map_erase and the inserts of
+    macro_map.h don't call update).
+
+    macro_map_sized.h and macro_map_interval.h are built on this.
+*/
+
+/* calls update on n and each of its ancestors (after changing a summary in place) */
+static inline void macro_map_augment_path(macro_map_t *n, macro_map_update_cb update) {
+    _macro_map_update_path(n, update);
+}
+
+/* called once node is linked below parent (as with _macro_map_fix_insert_update) */
+static inline void macro_map_augment_fix_insert(macro_map_t *node, macro_map_t *parent,
+                                                macro_map_t **root, macro_map_update_cb update) {
+    _macro_map_fix_insert_update(node, parent, root, update);
+}
+
+static inline bool macro_map_augment_erase(macro_map_t **root, macro_map_t *node,
+                                           macro_map_update_cb update) {
+    return _macro_map_erase_update(root, node, update);
+}
+
+/* the inserts have the same signature as _macro_map_insert_h */
+#define _macro_map_augment_insert(name, style, type, cmp, update)                \
+    _macro_map_insert_h(name, style, type) {                                     \
+        _macro_map_insert_update_code(root, style, type, cmp, node, update);     \
+    }
+
+#define _macro_map_augment_insert_compare(name, style, type, update)             \
+    _macro_map_insert_compare_h(name, style, type) {                             \
+        _macro_map_insert_update_code(root, style, type, cmp, node, update);     \
+    }
+
+#define _macro_multimap_augment_insert(name, style, type, cmp, update)                \
+    _macro_map_insert_h(name, style, type) {                                          \
+        _macro_multimap_insert_update_code(root, style, type, cmp, node, update);     \
+    }
+
+#define _macro_multimap_augment_insert_compare(name, style, type, update)             \
+    _macro_map_insert_compare_h(name, style, type) {                                  \
+        _macro_multimap_insert_update_code(root, style, type, cmp, node, update);     \
+    }
+
+#endif /* _macro_map_augment_H */
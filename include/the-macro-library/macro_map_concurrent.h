@@ -0,0 +1,172 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_map_concurrent_H
+#define _macro_map_concurrent_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "the-macro-library/macro_map.h"
+
+/*
+    A macro_map_t tree which is shared by many readers and a few writers.  Readers
+    don't lock or write to shared memory.  They search the tree between two reads of a
+    sequence number, and retry if a writer changed the tree in between.  Writers take a
+    mutex and make the sequence number odd while they change the tree.
+
+    macro_map_concurrent_t map;
+    macro_map_concurrent_init(&map);
+
+    macro_map_concurrent_find_kv(find_id, char, macro_string_id_map_t,
+                                 compare_macro_string_id_map_for_find);
+    macro_string_id_map_t *find_id(const macro_map_concurrent_t *m, const char *key);
+
+    macro_map_concurrent_insert(insert_id, macro_string_id_map_t, _macro_string_id_insert);
+    bool insert_id(macro_map_concurrent_t *m, macro_string_id_map_t *node);
+
+    macro_map_concurrent_erase(&map, &node->node);
+
+    Several changes can be made as one update (readers see all of them or none) with
+    macro_map_concurrent_write_lock and macro_map_concurrent_write_unlock around calls
+    which take &map.root.  The node must start with its macro_map_t.
+
+    A reader may follow links which a writer is changing (a rotation can briefly form
+    a cycle), so the search loads each link atomically, gives up after
+    __macro_map_concurrent_max_steps steps (far more than the height of any red black
+    tree) and retries.
+
+    A reader can be walking through a node while it is erased, so erased nodes must
+    not be freed (or reused) until no reader can still reach them.  Free them in
+    batches when readers are known to be idle, or keep them in an arena which is
+    cleared later.  The same applies to the node returned by a find.
+*/
+
+#if defined(__x86_64__) || defined(__i386__)
+#define __mcro_cpu_relax() __builtin_ia32_pause()
+#else
+#define __mcro_cpu_relax() ((void)0)
+#endif
+
+typedef struct {
+    macro_map_t *root;
+    size_t seq;
+    pthread_mutex_t lock;
+} macro_map_concurrent_t;
+
+static inline void macro_map_concurrent_init(macro_map_concurrent_t *m) {
+    m->root = NULL;
+    m->seq = 0;
+    pthread_mutex_init(&m->lock, NULL);
+}
+
+static inline void macro_map_concurrent_destroy(macro_map_concurrent_t *m) {
+    pthread_mutex_destroy(&m->lock);
+}
+
+static inline void macro_map_concurrent_write_lock(macro_map_concurrent_t *m) {
+    pthread_mutex_lock(&m->lock);
+    __atomic_store_n(&m->seq, m->seq + 1, __ATOMIC_RELAXED);
+    /* the odd sequence number is visible before any change to the tree */
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void macro_map_concurrent_write_unlock(macro_map_concurrent_t *m) {
+    __atomic_store_n(&m->seq, m->seq + 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&m->lock);
+}
+
+/* returns the sequence number to validate against (waits while a write is running) */
+static inline size_t macro_map_concurrent_read_begin(const macro_map_concurrent_t *m) {
+    size_t seq;
+    while ((seq = __atomic_load_n(&m->seq, __ATOMIC_ACQUIRE)) & 1)
+        __mcro_cpu_relax();
+    return seq;
+}
+
+/* true if nothing changed since macro_map_concurrent_read_begin returned seq */
+static inline bool macro_map_concurrent_read_valid(const macro_map_concurrent_t *m, size_t seq) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&m->seq, __ATOMIC_RELAXED) == seq;
+}
+
+static inline bool macro_map_concurrent_erase(macro_map_concurrent_t *m, macro_map_t *node) {
+    bool r;
+    macro_map_concurrent_write_lock(m);
+    r = macro_map_erase(&m->root, node);
+    macro_map_concurrent_write_unlock(m);
+    return r;
+}
+
+#define __macro_map_concurrent_max_steps 128
+
+/* cmp_fn is an expression of key and n */
+#define __macro_map_concurrent_find_code(value_type, m, cmp_fn)                          \
+    const macro_map_t *n;                                                                \
+    size_t seq, steps;                                                                   \
+    int c;                                                                               \
+    while (true) {                                                                       \
+        seq = macro_map_concurrent_read_begin(m);                                        \
+        n = __atomic_load_n(&m->root, __ATOMIC_RELAXED);                                 \
+        for (steps = 0; n && steps < __macro_map_concurrent_max_steps; steps++) {        \
+            c = cmp_fn;                                                                  \
+            if (c < 0)                                                                   \
+                n = __atomic_load_n(&n->left, __ATOMIC_RELAXED);                         \
+            else if (c > 0)                                                              \
+                n = __atomic_load_n(&n->right, __ATOMIC_RELAXED);                        \
+            else                                                                         \
+                break;                                                                   \
+        }                                                                                \
+        if (steps < __macro_map_concurrent_max_steps &&                                  \
+            macro_map_concurrent_read_valid(m, seq))                                     \
+            return (value_type *)n;                                                      \
+    }
+
+#define _macro_map_concurrent_find_h(name, style, value_type)    \
+    value_type *name(const macro_map_concurrent_t *m, macro_cmp_signature(const value_type *key, style, value_type))
+
+#define _macro_map_concurrent_find(name, style, value_type, cmp)                  \
+    _macro_map_concurrent_find_h(name, style, value_type) {                       \
+        __macro_map_concurrent_find_code(value_type, m,                           \
+            macro_cmp(style, value_type, cmp, key, (const value_type *)n))        \
+    }
+
+#define _macro_map_concurrent_find_kv_h(name, style, key_type, value_type)    \
+    value_type *name(const macro_map_concurrent_t *m,                         \
+                     macro_cmp_kv_signature(const key_type *key, style, key_type, value_type))
+
+#define _macro_map_concurrent_find_kv(name, style, key_type, value_type, cmp)                  \
+    _macro_map_concurrent_find_kv_h(name, style, key_type, value_type) {                       \
+        __macro_map_concurrent_find_code(value_type, m,                                        \
+            macro_cmp_kv(style, key_type, value_type, cmp, key, (const value_type *)n))        \
+    }
+
+/* the links of a node are cleared before the lock is taken, so a reader which reaches
+   the node as soon as it is linked doesn't follow stale children */
+#define macro_map_concurrent_insert_h(name, type)    \
+    bool name(macro_map_concurrent_t *m, type *node)
+
+#define macro_map_concurrent_insert(name, type, insert)            \
+    macro_map_concurrent_insert_h(name, type) {                    \
+        bool r;                                                    \
+        _macro_map_set_link(((macro_map_t *)node)->left, NULL);    \
+        _macro_map_set_link(((macro_map_t *)node)->right, NULL);   \
+        ((macro_map_t *)node)->parent_color = 0;                   \
+        macro_map_concurrent_write_lock(m);                        \
+        r = insert(&m->root, node);                                \
+        macro_map_concurrent_write_unlock(m);                      \
+        return r;                                                  \
+    }
+
+/* defaults - cmp_no_arg */
+#define macro_map_concurrent_find_h(name, value_type)    \
+    _macro_map_concurrent_find_h(name, macro_map_default(), value_type)
+#define macro_map_concurrent_find(name, value_type, cmp)    \
+    _macro_map_concurrent_find(name, macro_map_default(), value_type, cmp)
+
+#define macro_map_concurrent_find_kv_h(name, key_type, value_type)    \
+    _macro_map_concurrent_find_kv_h(name, macro_map_default(), key_type, value_type)
+#define macro_map_concurrent_find_kv(name, key_type, value_type, cmp)    \
+    _macro_map_concurrent_find_kv(name, macro_map_default(), key_type, value_type, cmp)
+
+#endif /* _macro_map_concurrent_H */
@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_map_interval_H
+#define _macro_map_interval_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "the-macro-library/macro_map_augment.h"
+
+/*
+    An interval tree on the red black tree of macro_map.h.  Nodes are ordered by the
+    start of their interval and each node keeps the largest end in its subtree, so the
+    intervals which overlap [lo, hi] (or contain a point p, with lo = hi = p) are found
+    without scanning.  Intervals are closed, and the points can be any type which can
+    be compared with < (such as ints, IP addresses or times).
+
+    typedef struct {
+        macro_map_t node;
+        uint32_t max_end;
+        uint32_t start, end;
+    } ip_range_t;
+
+    macro_map_interval_update(ip_range_update, ip_range_t, end, max_end);
+    macro_map_interval_insert(ip_range_insert, ip_range_t, start, ip_range_update);
+    macro_map_interval_first(ip_range_first, ip_range_t, uint32_t, start, end, max_end);
+    macro_map_interval_next(ip_range_next, ip_range_t, uint32_t, start, end, max_end);
+
+    ip_range_insert(&root, range);
+    for (ip_range_t *r = ip_range_first(root, ip, ip); r; r = ip_range_next(r, ip, ip))
+        ...  // every range which contains ip, in order of start
+    macro_map_interval_erase(&root, &range->node, ip_range_update);
+
+    The node must start with the macro_map_t.  Several nodes can have the same
+    interval (insert only fails if node is already in the tree).  A query which finds
+    k intervals costs O(log n + k) when the results are next to each other in order of
+    start, and up to O(k log n) when they are scattered through the tree (the walk
+    passes through the ancestors of each result, skipping any subtree whose largest end
+    is before lo).
+*/
+
+#define macro_map_interval_erase(root, node, update) macro_map_augment_erase(root, node, update)
+
+#define macro_map_interval_update_h(name) void name(macro_map_t *n)
+
+#define macro_map_interval_update(name, type, end, max_end)                     \
+    macro_map_interval_update_h(name) {                                         \
+        type *v = (type *)n, *c;                                                \
+        v->max_end = v->end;                                                    \
+        if (n->left && v->max_end < (c = (type *)n->left)->max_end)             \
+            v->max_end = c->max_end;                                            \
+        if (n->right && v->max_end < (c = (type *)n->right)->max_end)           \
+            v->max_end = c->max_end;                                            \
+    }
+
+/* equal starts are ordered by address, so only a node which is already in the tree
+   is rejected */
+#define macro_map_interval_insert_h(name, type) bool name(macro_map_t **root, type *node)
+
+#define macro_map_interval_insert(name, type, start, update)                    \
+    macro_map_interval_insert_h(name, type) {                                   \
+        macro_map_t **np = root, *parent = NULL;                                \
+        while (*np) {                                                           \
+            parent = *np;                                                       \
+            type *value = (type *)parent;                                       \
+            if (node->start < value->start)                                     \
+                np = &(parent->left);                                           \
+            else if (value->start < node->start)                                \
+                np = &(parent->right);                                          \
+            else if (node < value)                                              \
+                np = &(parent->left);                                           \
+            else if (node > value)                                              \
+                np = &(parent->right);                                          \
+            else                                                                \
+                return false;                                                   \
+        }                                                                       \
+        _macro_map_set_link(*np, node);                                         \
+        macro_map_augment_fix_insert(*np, parent, root, update);                \
+        return true;                                                            \
+    }
+
+/* The leftmost overlap in the subtree s.  If the left subtree reaches lo, it holds
+   the answer or nothing at or after it can overlap (its intervals which reach lo
+   start after hi), so the walk never backtracks. */
+#define __macro_map_interval_first_code(type, start, end, max_end, s, lo, hi)   \
+    while (s) {                                                                 \
+        if (s->left && !(((type *)s->left)->max_end < lo))                      \
+            s = s->left;                                                        \
+        else if (hi < ((type *)s)->start)                                       \
+            return NULL;                                                        \
+        else if (!(((type *)s)->end < lo))                                      \
+            return (type *)s;                                                   \
+        else                                                                    \
+            s = s->right;                                                       \
+    }                                                                           \
+    return NULL;
+
+#define macro_map_interval_first_h(name, type, point_type)    \
+    type *name(const macro_map_t *root, point_type lo, point_type hi)
+
+#define macro_map_interval_first(name, type, point_type, start, end, max_end)       \
+    macro_map_interval_first_h(name, type, point_type) {                            \
+        const macro_map_t *s = root;                                                \
+        __macro_map_interval_first_code(type, start, end, max_end, s, lo, hi)       \
+    }
+
+/* the next overlap after node (which must overlap [lo, hi]) in order of start */
+#define macro_map_interval_next_h(name, type, point_type)    \
+    type *name(const type *node, point_type lo, point_type hi)
+
+#define macro_map_interval_next(name, type, point_type, start, end, max_end)       \
+    macro_map_interval_next_h(name, type, point_type) {                            \
+        const macro_map_t *s = (const macro_map_t *)node, *parent;                 \
+        while (true) {                                                             \
+            if (s->right && !(((type *)s->right)->max_end < lo)) {                 \
+                s = s->right;                                                      \
+                break;                                                             \
+            }                                                                      \
+            while ((parent = _macro_map_parent(s)) != NULL && parent->right == s)  \
+                s = parent;                                                        \
+            if (!parent || hi < ((type *)parent)->start)                           \
+                return NULL;                                                       \
+            s = parent;                                                            \
+            if (!(((type *)s)->end < lo))                                          \
+                return (type *)s;                                                  \
+        }                                                                          \
+        __macro_map_interval_first_code(type, start, end, max_end, s, lo, hi)      \
+    }
+
+#endif /* _macro_map_interval_H */
@@ -0,0 +1,470 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_map_persistent_H
+#define _macro_map_persistent_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "the-macro-library/macro_map.h"
+
+/*
+    A persistent (copy on write) macro_map_t tree for maps which are read far more
+    often than they change.  insert and erase never modify a node which readers can
+    see.  Each node on the path from the root to the change (and the few siblings
+    which are recolored or rotated) is copied with the macro_map_copy_node_cb callback,
+    and the new root is published atomically.  A reader takes a snapshot of the root
+    and searches it with any function generated by _macro_map or _macro_map_kv, without
+    locks and without seeing a partial update.
+
+    The nodes which a write replaces are retired, and freed with the free callback once
+    no reader can still be in a snapshot which contains them (an epoch scheme).  Each
+    reader thread has its own slot, numbered from 0 to num_readers-1.
+
+    macro_map_persistent_t map;
+    macro_map_persistent_init(&map, num_reader_threads, copy_node, free_node, pool);
+
+    macro_map_persistent_insert(insert_id, macro_string_id_map_t, compare_for_insert);
+    bool insert_id(macro_map_persistent_t *p, macro_string_id_map_t *node);
+
+    macro_map_persistent_erase_kv(erase_id, char, macro_string_id_map_t, compare_for_find);
+    bool erase_id(macro_map_persistent_t *p, const char *key);
+
+    // reader thread number r
+    macro_map_t *root = macro_map_persistent_read_begin(&map, r);
+    macro_string_id_map_t *node = macro_string_id_find_node(root, "key");
+    ...
+    macro_map_persistent_read_end(&map, r);
+
+    Only one write may run at a time (writers must be serialized by the caller).  The
+    copy callback must copy the whole node (including any trailing key) and must not
+    fail.  insert returns false if an equal node is already in the tree or the list of
+    retired nodes can't grow, and erase if no node is equal to key or the list can't
+    grow.  Searching the tree after a false return tells the two apart.
+
+    The tree is kept as a left leaning red black tree, and the bits which hold the
+    parent in a macro_map_t hold a write counter instead (a node can be shared by
+    several versions of the tree, so it has no single parent).  The find functions,
+    macro_map_first and macro_map_last work on a snapshot, but functions which use the
+    parent (macro_map_next, macro_map_previous, the postorder iteration and
+    macro_map_erase) don't.
+*/
+
+#define __macro_map_persistent_depth 128
+
+typedef void (*macro_map_free_node_cb)(macro_map_t *n, void *arg);
+
+typedef struct {
+    size_t epoch;
+    char pad[64 - sizeof(size_t)];
+} macro_map_epoch_slot_t;
+
+typedef struct {
+    macro_map_t *root;
+    size_t stamp;
+    size_t epoch;
+
+    macro_map_epoch_slot_t *readers;
+    size_t num_readers;
+
+    macro_map_t **retired;
+    size_t *retired_epoch;
+    size_t num_retired;
+    size_t retired_size;
+
+    macro_map_copy_node_cb copy;
+    macro_map_free_node_cb free_node;
+    void *arg;
+} macro_map_persistent_t;
+
+static inline bool macro_map_persistent_init(macro_map_persistent_t *p, size_t num_readers,
+                                             macro_map_copy_node_cb copy,
+                                             macro_map_free_node_cb free_node, void *arg) {
+    memset(p, 0, sizeof(*p));
+    p->epoch = 1;
+    p->num_readers = num_readers;
+    p->copy = copy;
+    p->free_node = free_node;
+    p->arg = arg;
+    if (num_readers) {
+        p->readers = (macro_map_epoch_slot_t *)calloc(num_readers, sizeof(macro_map_epoch_slot_t));
+        if (!p->readers)
+            return false;
+    }
+    return true;
+}
+
+/* the snapshot is valid until macro_map_persistent_read_end */
+static inline macro_map_t *macro_map_persistent_read_begin(macro_map_persistent_t *p, size_t reader) {
+    __atomic_store_n(&p->readers[reader].epoch, __atomic_load_n(&p->epoch, __ATOMIC_SEQ_CST),
+                     __ATOMIC_SEQ_CST);
+    return __atomic_load_n(&p->root, __ATOMIC_SEQ_CST);
+}
+
+static inline void macro_map_persistent_read_end(macro_map_persistent_t *p, size_t reader) {
+    __atomic_store_n(&p->readers[reader].epoch, 0, __ATOMIC_RELEASE);
+}
+
+/* frees the retired nodes which no reader can reach (called after every write) */
+static inline void macro_map_persistent_reclaim(macro_map_persistent_t *p) {
+    size_t i, j, e, min_epoch = __atomic_load_n(&p->epoch, __ATOMIC_SEQ_CST);
+    for (i = 0; i < p->num_readers; i++) {
+        e = __atomic_load_n(&p->readers[i].epoch, __ATOMIC_SEQ_CST);
+        if (e && e < min_epoch)
+            min_epoch = e;
+    }
+    for (i = 0, j = 0; i < p->num_retired; i++) {
+        if (p->retired_epoch[i] < min_epoch)
+            p->free_node(p->retired[i], p->arg);
+        else {
+            p->retired[j] = p->retired[i];
+            p->retired_epoch[j] = p->retired_epoch[i];
+            j++;
+        }
+    }
+    p->num_retired = j;
+}
+
+static void _macro_map_persistent_free_tree(macro_map_persistent_t *p, macro_map_t *n) {
+    if (n->left)
+        _macro_map_persistent_free_tree(p, n->left);
+    if (n->right)
+        _macro_map_persistent_free_tree(p, n->right);
+    p->free_node(n, p->arg);
+}
+
+/* frees every node, no readers may be active */
+static inline void macro_map_persistent_destroy(macro_map_persistent_t *p) {
+    size_t i;
+    for (i = 0; i < p->num_retired; i++)
+        p->free_node(p->retired[i], p->arg);
+    if (p->root)
+        _macro_map_persistent_free_tree(p, p->root);
+    free(p->retired);
+    free(p->retired_epoch);
+    free(p->readers);
+    memset(p, 0, sizeof(*p));
+}
+
+/* a write can retire at most a few nodes per level */
+static inline bool _macro_map_persistent_begin(macro_map_persistent_t *p) {
+    size_t need = p->num_retired + 4 * __macro_map_persistent_depth;
+    if (need > p->retired_size) {
+        size_t size = need * 2;
+        macro_map_t **retired = (macro_map_t **)realloc(p->retired, size * sizeof(macro_map_t *));
+        if (!retired)
+            return false;
+        p->retired = retired;
+        size_t *retired_epoch = (size_t *)realloc(p->retired_epoch, size * sizeof(size_t));
+        if (!retired_epoch)
+            return false;
+        p->retired_epoch = retired_epoch;
+        p->retired_size = size;
+    }
+    p->stamp++;
+    return true;
+}
+
+#define _macro_map_persistent_is_red(n) ((n) && !((n)->parent_color & 1))
+#define _macro_map_persistent_fresh(p, n) (((n)->parent_color >> 1) == (p)->stamp)
+
+/* returns a copy of n which this write may change (n itself if it was created by this
+   write), and retires n */
+static inline macro_map_t *_macro_map_persistent_own(macro_map_persistent_t *p, macro_map_t *n) {
+    if (_macro_map_persistent_fresh(p, n))
+        return n;
+    macro_map_t *c = p->copy(n, p->arg);
+    c->left = n->left;
+    c->right = n->right;
+    c->parent_color = (p->stamp << 1) | (n->parent_color & 1);
+    p->retired[p->num_retired] = n;
+    p->retired_epoch[p->num_retired] = p->epoch;
+    p->num_retired++;
+    return c;
+}
+
+/* n is no longer in the tree */
+static inline void _macro_map_persistent_drop(macro_map_persistent_t *p, macro_map_t *n) {
+    if (_macro_map_persistent_fresh(p, n))
+        p->free_node(n, p->arg);
+    else {
+        p->retired[p->num_retired] = n;
+        p->retired_epoch[p->num_retired] = p->epoch;
+        p->num_retired++;
+    }
+}
+
+/* h is owned by the caller for the following */
+static inline macro_map_t *_macro_map_persistent_rotate_left(macro_map_persistent_t *p, macro_map_t *h) {
+    macro_map_t *x = _macro_map_persistent_own(p, h->right);
+    h->right = x->left;
+    x->left = h;
+    x->parent_color = (x->parent_color & ~(size_t)1) | (h->parent_color & 1);
+    h->parent_color &= ~(size_t)1;
+    return x;
+}
+
+static inline macro_map_t *_macro_map_persistent_rotate_right(macro_map_persistent_t *p, macro_map_t *h) {
+    macro_map_t *x = _macro_map_persistent_own(p, h->left);
+    h->left = x->right;
+    x->right = h;
+    x->parent_color = (x->parent_color & ~(size_t)1) | (h->parent_color & 1);
+    h->parent_color &= ~(size_t)1;
+    return x;
+}
+
+static inline void _macro_map_persistent_flip(macro_map_persistent_t *p, macro_map_t *h) {
+    h->left = _macro_map_persistent_own(p, h->left);
+    h->right = _macro_map_persistent_own(p, h->right);
+    h->parent_color ^= 1;
+    h->left->parent_color ^= 1;
+    h->right->parent_color ^= 1;
+}
+
+static inline macro_map_t *_macro_map_persistent_balance(macro_map_persistent_t *p, macro_map_t *h) {
+    if (_macro_map_persistent_is_red(h->right) && !_macro_map_persistent_is_red(h->left))
+        h = _macro_map_persistent_rotate_left(p, h);
+    if (_macro_map_persistent_is_red(h->left) && _macro_map_persistent_is_red(h->left->left))
+        h = _macro_map_persistent_rotate_right(p, h);
+    if (_macro_map_persistent_is_red(h->left) && _macro_map_persistent_is_red(h->right))
+        _macro_map_persistent_flip(p, h);
+    return h;
+}
+
+/* these own h */
+static inline macro_map_t *_macro_map_persistent_move_red_left(macro_map_persistent_t *p, macro_map_t *h) {
+    h = _macro_map_persistent_own(p, h);
+    _macro_map_persistent_flip(p, h);
+    if (_macro_map_persistent_is_red(h->right->left)) {
+        h->right = _macro_map_persistent_rotate_right(p, h->right);
+        h = _macro_map_persistent_rotate_left(p, h);
+        _macro_map_persistent_flip(p, h);
+    }
+    return h;
+}
+
+static inline macro_map_t *_macro_map_persistent_move_red_right(macro_map_persistent_t *p, macro_map_t *h) {
+    h = _macro_map_persistent_own(p, h);
+    _macro_map_persistent_flip(p, h);
+    if (_macro_map_persistent_is_red(h->left->left)) {
+        h = _macro_map_persistent_rotate_right(p, h);
+        _macro_map_persistent_flip(p, h);
+    }
+    return h;
+}
+
+static inline macro_map_t *_macro_map_persistent_red_root(macro_map_persistent_t *p, macro_map_t *h) {
+    if (!_macro_map_persistent_is_red(h->left) && !_macro_map_persistent_is_red(h->right)) {
+        h = _macro_map_persistent_own(p, h);
+        h->parent_color &= ~(size_t)1;
+    }
+    return h;
+}
+
+/* link h back into the (copied) path and rebalance on the way up, then publish the
+   new root */
+static inline void _macro_map_persistent_finish(macro_map_persistent_t *p, macro_map_t *h,
+                                                macro_map_t **stack, unsigned char *dirs,
+                                                size_t depth) {
+    macro_map_t *parent;
+    while (depth--) {
+        parent = _macro_map_persistent_own(p, stack[depth]);
+        if (dirs[depth])
+            parent->right = h;
+        else
+            parent->left = h;
+        h = _macro_map_persistent_balance(p, parent);
+    }
+    if (h) {
+        h = _macro_map_persistent_own(p, h);
+        h->parent_color |= 1;
+    }
+    __atomic_store_n(&p->root, h, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&p->epoch, p->epoch + 1, __ATOMIC_SEQ_CST);
+    macro_map_persistent_reclaim(p);
+}
+
+#define __macro_map_persistent_insert_code(style, type, cmp, p, node)      \
+    macro_map_t *stack[__macro_map_persistent_depth], *h;                  \
+    unsigned char dirs[__macro_map_persistent_depth];                      \
+    size_t depth = 0;                                                      \
+    int n;                                                                 \
+    h = p->root;                                                           \
+    while (h) {                                                            \
+        n = macro_cmp(style, type, cmp, node, (const type *)h);            \
+        if (!n)                                                            \
+            return false;                                                  \
+        stack[depth] = h;                                                  \
+        dirs[depth++] = n > 0;                                             \
+        h = n < 0 ? h->left : h->right;                                    \
+    }                                                                      \
+    if (!_macro_map_persistent_begin(p))                                   \
+        return false;                                                      \
+    h = (macro_map_t *)node;                                               \
+    h->left = h->right = NULL;                                             \
+    h->parent_color = p->stamp << 1;                                       \
+    _macro_map_persistent_finish(p, h, stack, dirs, depth);                \
+    return true;
+
+#define __macro_map_persistent_compare(style, key_type, type, cmp, key, n)    \
+    macro_cmp(style, type, cmp, key, (const type *)(n))
+#define __macro_map_persistent_compare_kv(style, key_type, type, cmp, key, n)    \
+    macro_cmp_kv(style, key_type, type, cmp, key, (const type *)(n))
+#define __macro_map_persistent_cmp(kv, style, key_type, type, cmp, key, n)    \
+    __macro_map_persistent_compare ## kv(style, key_type, type, cmp, key, n)
+
+/* the left leaning red black tree delete, with the recursion unrolled onto a stack */
+#define __macro_map_persistent_erase_code(kv, style, key_type, value_type, cmp, p, key)                        \
+    macro_map_t *stack[__macro_map_persistent_depth], *h, *x, *target;                                         \
+    unsigned char dirs[__macro_map_persistent_depth];                                                          \
+    size_t depth = 0, rep;                                                                                     \
+    int n;                                                                                                     \
+    for (x = p->root; x; x = n < 0 ? x->left : x->right) {                                                     \
+        n = __macro_map_persistent_cmp(kv, style, key_type, value_type, cmp, key, x);                          \
+        if (!n)                                                                                                \
+            break;                                                                                             \
+    }                                                                                                          \
+    if (!x || !_macro_map_persistent_begin(p))                                                                 \
+        return false;                                                                                          \
+    h = _macro_map_persistent_red_root(p, p->root);                                                            \
+    while (true) {                                                                                             \
+        n = __macro_map_persistent_cmp(kv, style, key_type, value_type, cmp, key, h);                          \
+        if (n < 0) {                                                                                           \
+            if (!_macro_map_persistent_is_red(h->left) && !_macro_map_persistent_is_red(h->left->left))        \
+                h = _macro_map_persistent_move_red_left(p, h);                                                 \
+            stack[depth] = h;                                                                                  \
+            dirs[depth++] = 0;                                                                                 \
+            h = h->left;                                                                                       \
+            continue;                                                                                          \
+        }                                                                                                      \
+        if (_macro_map_persistent_is_red(h->left)) {                                                           \
+            h = _macro_map_persistent_rotate_right(p, _macro_map_persistent_own(p, h));                        \
+            n = __macro_map_persistent_cmp(kv, style, key_type, value_type, cmp, key, h);                      \
+        }                                                                                                      \
+        if (!n && !h->right) {                                                                                 \
+            _macro_map_persistent_drop(p, h);                                                                  \
+            h = NULL;                                                                                          \
+            break;                                                                                             \
+        }                                                                                                      \
+        if (!_macro_map_persistent_is_red(h->right) && !_macro_map_persistent_is_red(h->right->left)) {        \
+            h = _macro_map_persistent_move_red_right(p, h);                                                    \
+            n = __macro_map_persistent_cmp(kv, style, key_type, value_type, cmp, key, h);                      \
+        }                                                                                                      \
+        if (!n) {                                                                                              \
+            /* replace h with the smallest node of its right subtree */                                        \
+            rep = depth;                                                                                       \
+            stack[depth] = h;                                                                                  \
+            dirs[depth++] = 1;                                                                                 \
+            x = h->right;                                                                                      \
+            while (x->left) {                                                                                  \
+                if (!_macro_map_persistent_is_red(x->left) && !_macro_map_persistent_is_red(x->left->left))    \
+                    x = _macro_map_persistent_move_red_left(p, x);                                             \
+                stack[depth] = x;                                                                              \
+                dirs[depth++] = 0;                                                                             \
+                x = x->left;                                                                                   \
+            }                                                                                                  \
+            h = x->right;                                                                                      \
+            while (depth > rep + 1) {                                                                          \
+                depth--;                                                                                       \
+                stack[depth] = _macro_map_persistent_own(p, stack[depth]);                                     \
+                stack[depth]->left = h;                                                                        \
+                h = _macro_map_persistent_balance(p, stack[depth]);                                            \
+            }                                                                                                  \
+            depth--;                                                                                           \
+            target = stack[depth];                                                                             \
+            x = _macro_map_persistent_own(p, x);                                                               \
+            x->left = target->left;                                                                            \
+            x->right = h;                                                                                      \
+            x->parent_color = (x->parent_color & ~(size_t)1) | (target->parent_color & 1);                     \
+            _macro_map_persistent_drop(p, target);                                                             \
+            h = _macro_map_persistent_balance(p, x);                                                           \
+            break;                                                                                             \
+        }                                                                                                      \
+        stack[depth] = h;                                                                                      \
+        dirs[depth++] = 1;                                                                                     \
+        h = h->right;                                                                                          \
+    }                                                                                                          \
+    _macro_map_persistent_finish(p, h, stack, dirs, depth);                                                    \
+    return true;
+
+#define _macro_map_persistent_insert_h(name, style, type)    \
+    bool name(macro_map_persistent_t *p, macro_cmp_signature(type *node, style, type))
+
+#define _macro_map_persistent_insert(name, style, type, cmp)             \
+    _macro_map_persistent_insert_h(name, style, type) {                  \
+        __macro_map_persistent_insert_code(style, type, cmp, p, node)    \
+    }
+
+#define _macro_map_persistent_insert_compare_h(name, style, type)    \
+    __macro_map_persistent_insert_compare_h(name, style, type)
+#define __macro_map_persistent_insert_compare_h(name, style, type)    \
+    _macro_map_persistent_insert_h(name, compare_ ## style, type)
+
+#define _macro_map_persistent_insert_compare(name, style, type)          \
+    _macro_map_persistent_insert_compare_h(name, style, type) {          \
+        __macro_map_persistent_insert_code(style, type, cmp, p, node)    \
+    }
+
+#define _macro_map_persistent_erase_h(name, style, type)    \
+    bool name(macro_map_persistent_t *p, macro_cmp_signature(const type *key, style, type))
+
+#define _macro_map_persistent_erase(name, style, type, cmp)                            \
+    _macro_map_persistent_erase_h(name, style, type) {                                 \
+        __macro_map_persistent_erase_code(, style, type, type, cmp, p, key)            \
+    }
+
+#define _macro_map_persistent_erase_compare_h(name, style, type)    \
+    __macro_map_persistent_erase_compare_h(name, style, type)
+#define __macro_map_persistent_erase_compare_h(name, style, type)    \
+    _macro_map_persistent_erase_h(name, compare_ ## style, type)
+
+#define _macro_map_persistent_erase_compare(name, style, type)                         \
+    _macro_map_persistent_erase_compare_h(name, style, type) {                         \
+        __macro_map_persistent_erase_code(, style, type, type, cmp, p, key)            \
+    }
+
+#define _macro_map_persistent_erase_kv_h(name, style, key_type, value_type)    \
+    bool name(macro_map_persistent_t *p, macro_cmp_kv_signature(const key_type *key, style, key_type, value_type))
+
+#define _macro_map_persistent_erase_kv(name, style, key_type, value_type, cmp)                    \
+    _macro_map_persistent_erase_kv_h(name, style, key_type, value_type) {                         \
+        __macro_map_persistent_erase_code(_kv, style, key_type, value_type, cmp, p, key)          \
+    }
+
+#define _macro_map_persistent_erase_kv_compare_h(name, style, key_type, value_type)    \
+    __macro_map_persistent_erase_kv_compare_h(name, style, key_type, value_type)
+#define __macro_map_persistent_erase_kv_compare_h(name, style, key_type, value_type)    \
+    _macro_map_persistent_erase_kv_h(name, compare_ ## style, key_type, value_type)
+
+#define _macro_map_persistent_erase_kv_compare(name, style, key_type, value_type)                 \
+    _macro_map_persistent_erase_kv_compare_h(name, style, key_type, value_type) {                 \
+        __macro_map_persistent_erase_code(_kv, style, key_type, value_type, cmp, p, key)          \
+    }
+
+/* defaults - cmp_no_arg */
+#define macro_map_persistent_insert_h(name, type)    \
+    _macro_map_persistent_insert_h(name, macro_map_default(), type)
+#define macro_map_persistent_insert(name, type, cmp)    \
+    _macro_map_persistent_insert(name, macro_map_default(), type, cmp)
+#define macro_map_persistent_insert_compare_h(name, type)    \
+    _macro_map_persistent_insert_compare_h(name, macro_map_default(), type)
+#define macro_map_persistent_insert_compare(name, type)    \
+    _macro_map_persistent_insert_compare(name, macro_map_default(), type)
+
+#define macro_map_persistent_erase_h(name, type)    \
+    _macro_map_persistent_erase_h(name, macro_map_default(), type)
+#define macro_map_persistent_erase(name, type, cmp)    \
+    _macro_map_persistent_erase(name, macro_map_default(), type, cmp)
+#define macro_map_persistent_erase_compare_h(name, type)    \
+    _macro_map_persistent_erase_compare_h(name, macro_map_default(), type)
+#define macro_map_persistent_erase_compare(name, type)    \
+    _macro_map_persistent_erase_compare(name, macro_map_default(), type)
+
+#define macro_map_persistent_erase_kv_h(name, key_type, value_type)    \
+    _macro_map_persistent_erase_kv_h(name, macro_map_default(), key_type, value_type)
+#define macro_map_persistent_erase_kv(name, key_type, value_type, cmp)    \
+    _macro_map_persistent_erase_kv(name, macro_map_default(), key_type, value_type, cmp)
+
+#endif /* _macro_map_persistent_H */
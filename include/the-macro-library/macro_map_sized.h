@@ -0,0 +1,163 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_map_sized_H
+#define _macro_map_sized_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "the-macro-library/macro_map_augment.h"
+
+/*
+    A map which keeps the size of each subtree, so that the k-th smallest node
+    (macro_map_select) and the number of nodes less than a key (macro_map_rank) are
+    found in O(log n) instead of walking the tree with macro_map_next.
+
+    typedef struct {
+        macro_map_sized_t node;
+        int key;
+    } int_node_t;
+
+    macro_map_sized_insert(insert_int, int_node_t, compare_ints);
+    bool insert_int(macro_map_t **root, int_node_t *node);
+
+    macro_map_rank_kv(rank_int, int, int_node_t, compare_key_to_node);
+    size_t rank_int(const macro_map_t *root, const int *key);
+
+    int_node_t *third = (int_node_t *)macro_map_select(root, 2);
+    size_t index = macro_map_rank_of(&third->node.node);  // 2
+    macro_map_sized_erase(&root, &third->node.node);
+
+    The node must start with macro_map_sized_t.  The find functions of macro_map.h work
+    on the tree, but it must only be changed with the inserts and the erase below.
+*/
+
+typedef struct {
+    macro_map_t node;
+    size_t size;
+} macro_map_sized_t;
+
+#define macro_map_size_of(n) ((n) ? ((const macro_map_sized_t *)(n))->size : 0)
+
+static inline void macro_map_sized_update(macro_map_t *n) {
+    ((macro_map_sized_t *)n)->size = macro_map_size_of(n->left) + macro_map_size_of(n->right) + 1;
+}
+
+static inline bool macro_map_sized_erase(macro_map_t **root, macro_map_t *node) {
+    return macro_map_augment_erase(root, node, macro_map_sized_update);
+}
+
+/* returns the k-th smallest node (counting from 0), or NULL if k >= the size of the tree */
+static inline macro_map_t *macro_map_select(const macro_map_t *root, size_t k) {
+    size_t left;
+    while (root) {
+        left = macro_map_size_of(root->left);
+        if (k < left)
+            root = root->left;
+        else if (k > left) {
+            k -= left + 1;
+            root = root->right;
+        } else
+            return (macro_map_t *)root;
+    }
+    return NULL;
+}
+
+/* returns the number of nodes before n */
+static inline size_t macro_map_rank_of(const macro_map_t *n) {
+    size_t r = macro_map_size_of(n->left);
+    const macro_map_t *parent;
+    while ((parent = _macro_map_parent(n)) != NULL) {
+        if (parent->right == n)
+            r += macro_map_size_of(parent->left) + 1;
+        n = parent;
+    }
+    return r;
+}
+
+/* rank counts the nodes which are less than key */
+#define __macro_map_rank_code(cmp_fn, root)             \
+    size_t r = 0;                                       \
+    while (root) {                                      \
+        if (cmp_fn > 0) {                               \
+            r += macro_map_size_of(root->left) + 1;     \
+            root = root->right;                         \
+        } else                                          \
+            root = root->left;                          \
+    }                                                   \
+    return r;
+
+#define _macro_map_rank_h(name, style, type)    \
+    size_t name(const macro_map_t *root, macro_cmp_signature(const type *key, style, type))
+
+#define _macro_map_rank(name, style, type, cmp)                                                 \
+    _macro_map_rank_h(name, style, type) {                                                      \
+        __macro_map_rank_code(macro_cmp(style, type, cmp, key, (const type *)root), root)       \
+    }
+
+#define _macro_map_rank_compare_h(name, style, type) __macro_map_rank_compare_h(name, style, type)
+#define __macro_map_rank_compare_h(name, style, type) _macro_map_rank_h(name, compare_ ## style, type)
+
+#define _macro_map_rank_compare(name, style, type)                                              \
+    _macro_map_rank_compare_h(name, style, type) {                                              \
+        __macro_map_rank_code(macro_cmp(style, type, cmp, key, (const type *)root), root)       \
+    }
+
+#define _macro_map_rank_kv_h(name, style, key_type, value_type)    \
+    size_t name(const macro_map_t *root, macro_cmp_kv_signature(const key_type *key, style, key_type, value_type))
+
+#define _macro_map_rank_kv(name, style, key_type, value_type, cmp)                              \
+    _macro_map_rank_kv_h(name, style, key_type, value_type) {                                   \
+        __macro_map_rank_code(macro_cmp_kv(style, key_type, value_type, cmp, key,               \
+                                           (const value_type *)root), root)                     \
+    }
+
+#define _macro_map_rank_kv_compare_h(name, style, key_type, value_type)    \
+    __macro_map_rank_kv_compare_h(name, style, key_type, value_type)
+#define __macro_map_rank_kv_compare_h(name, style, key_type, value_type)    \
+    _macro_map_rank_kv_h(name, compare_ ## style, key_type, value_type)
+
+#define _macro_map_rank_kv_compare(name, style, key_type, value_type)                           \
+    _macro_map_rank_kv_compare_h(name, style, key_type, value_type) {                           \
+        __macro_map_rank_code(macro_cmp_kv(style, key_type, value_type, cmp, key,               \
+                                           (const value_type *)root), root)                     \
+    }
+
+#define _macro_map_sized_insert_h(name, style, type) _macro_map_insert_h(name, style, type)
+#define _macro_map_sized_insert_compare_h(name, style, type) _macro_map_insert_compare_h(name, style, type)
+
+#define _macro_map_sized_insert(name, style, type, cmp)    \
+    _macro_map_augment_insert(name, style, type, cmp, macro_map_sized_update)
+#define _macro_map_sized_insert_compare(name, style, type)    \
+    _macro_map_augment_insert_compare(name, style, type, macro_map_sized_update)
+#define _macro_multimap_sized_insert(name, style, type, cmp)    \
+    _macro_multimap_augment_insert(name, style, type, cmp, macro_map_sized_update)
+#define _macro_multimap_sized_insert_compare(name, style, type)    \
+    _macro_multimap_augment_insert_compare(name, style, type, macro_map_sized_update)
+
+/* defaults - cmp_no_arg */
+#define macro_map_rank_h(name, type) _macro_map_rank_h(name, macro_map_default(), type)
+#define macro_map_rank(name, type, cmp) _macro_map_rank(name, macro_map_default(), type, cmp)
+#define macro_map_rank_compare_h(name, type) _macro_map_rank_compare_h(name, macro_map_default(), type)
+#define macro_map_rank_compare(name, type) _macro_map_rank_compare(name, macro_map_default(), type)
+
+#define macro_map_rank_kv_h(name, key_type, value_type)    \
+    _macro_map_rank_kv_h(name, macro_map_default(), key_type, value_type)
+#define macro_map_rank_kv(name, key_type, value_type, cmp)    \
+    _macro_map_rank_kv(name, macro_map_default(), key_type, value_type, cmp)
+#define macro_map_rank_kv_compare_h(name, key_type, value_type)    \
+    _macro_map_rank_kv_compare_h(name, macro_map_default(), key_type, value_type)
+#define macro_map_rank_kv_compare(name, key_type, value_type)    \
+    _macro_map_rank_kv_compare(name, macro_map_default(), key_type, value_type)
+
+#define macro_map_sized_insert_h(name, type) _macro_map_sized_insert_h(name, macro_map_default(), type)
+#define macro_map_sized_insert(name, type, cmp) _macro_map_sized_insert(name, macro_map_default(), type, cmp)
+#define macro_map_sized_insert_compare_h(name, type) _macro_map_sized_insert_compare_h(name, macro_map_default(), type)
+#define macro_map_sized_insert_compare(name, type) _macro_map_sized_insert_compare(name, macro_map_default(), type)
+
+#define macro_multimap_sized_insert(name, type, cmp)    \
+    _macro_multimap_sized_insert(name, macro_map_default(), type, cmp)
+#define macro_multimap_sized_insert_compare(name, type)    \
+    _macro_multimap_sized_insert_compare(name, macro_map_default(), type)
+
+#endif /* _macro_map_sized_H */
@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_merge_sort_H
+#define _macro_merge_sort_H
+
+#include <stdlib.h>
+
+#include "the-macro-library/macro_sort.h"
+#include "the-macro-library/src/macro_merge_sort.h"
+
+/*
+    A stable sort which minimizes the number of comparisons.  macro_sort (introsort) is
+    the better choice when comparisons are cheap, but when the compare function is
+    expensive (strings, collation, a lookup per comparison, a remote call), the number
+    of comparisons dominates and this sort does about a third fewer of them on random
+    input and far fewer on input which is already partially sorted.  macro_sort makes
+    fewer comparisons when there are only a few unique keys (its three way partition
+    drops every element equal to the pivot), such as 87 thousand against 153 thousand
+    for 20,000 elements with 8 distinct keys.
+
+    macro_merge_sort(sort_names, name_t, compare_names);
+
+    void sort_names(name_t *base, size_t n);
+
+    The generators follow the same pattern as macro_sort (_macro_merge_sort with a
+    style, _h and _compare variants).  A scratch buffer of n/2 elements is allocated
+    for each call.  If the allocation fails, the array is sorted with macro_sort's
+    introsort instead (which is not stable).
+*/
+
+#define __macro_merge_sort_body(style, type, cmp)                            \
+    type *buf = NULL;                                                        \
+    if(n < 2)                                                                \
+        return;                                                              \
+    if(n > __macro_merge_sort_run)                                           \
+        buf = (type *)malloc(((n >> 1) + 1) * sizeof(type));                 \
+    if(!buf && n > __macro_merge_sort_run) {                                 \
+        __macro_introsort_code(style, type, cmp);                            \
+    }                                                                        \
+    __macro_merge_sort_code(style, type, cmp, base, n, buf);                 \
+    free(buf);
+
+#define _macro_merge_sort_h(name, style, type)    \
+void name(type *base,                             \
+          macro_cmp_signature(size_t n, style, type))
+
+#define _macro_merge_sort(name, style, type, cmp)    \
+_macro_merge_sort_h(name, style, type) {             \
+    __macro_merge_sort_body(style, type, cmp);       \
+}
+
+#define _macro_merge_sort_compare_h(name, style, type)    \
+    __macro_merge_sort_compare_h(name, style, type)
+
+#define __macro_merge_sort_compare_h(name, style, type)    \
+    _macro_merge_sort_h(name, compare_ ## style, type)
+
+#define _macro_merge_sort_compare(name, style, type)    \
+_macro_merge_sort_compare_h(name, style, type) {        \
+    __macro_merge_sort_body(style, type, cmp);          \
+}
+
+#define macro_merge_sort_h(name, type) _macro_merge_sort_h(name, macro_sort_default(), type)
+#define macro_merge_sort(name, type, cmp) _macro_merge_sort(name, macro_sort_default(), type, cmp)
+
+#define macro_merge_sort_compare_h(name, type) _macro_merge_sort_compare_h(name, macro_sort_default(), type)
+#define macro_merge_sort_compare(name, type) _macro_merge_sort_compare(name, macro_sort_default(), type)
+
+#endif /* _macro_merge_sort_H */
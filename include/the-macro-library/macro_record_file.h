@@ -0,0 +1,230 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_record_file_H
+#define _macro_record_file_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "the-macro-library/macro_bsearch.h"
+
+/*
+    A read-only file of sorted fixed width records which is searched in place through
+    mmap, so opening it costs nothing and only the pages that lookups touch are read.
+
+    The file is a 64 byte header, the records, and a fence index (a copy of every
+    fence_every'th record).  A lookup binary searches the fence index (which is small
+    enough to stay cached) to pick a block of fence_every records, and then runs the
+    macro_bsearch code for the chosen style over that block, so a lookup touches one
+    or two pages of records.  The file uses the byte order of the machine which wrote it.
+
+    macro_record_file_write("ids.dat", records, n, sizeof(record_t), 256);
+
+    macro_record_file_t f;
+    if(!macro_record_file_open(&f, "ids.dat", sizeof(record_t)))
+        ...
+    macro_record_file_lower_bound(lower_bound_ids, record_t, compare_records);
+    record_t *r = lower_bound_ids(&f, &key);
+    macro_record_file_close(&f);
+
+    Any bsearch style (core, first, last, floor, ceiling, lower_bound, upper_bound) and
+    comparison style can be used with _macro_record_file, and the kv versions search
+    with a different key type.  The pointers returned point into the mapping and are
+    valid until the file is closed.
+*/
+
+#define MACRO_RECORD_FILE_MAGIC "mcrorec1"
+
+typedef struct {
+    char magic[8];
+    uint64_t record_size;
+    uint64_t num_records;
+    uint64_t fence_every;
+    uint64_t num_fences;
+    uint64_t records_offset;
+    uint64_t fences_offset;
+    uint64_t file_size;
+} macro_record_file_header_t;
+
+typedef struct {
+    void *map;
+    size_t map_size;
+    const void *records;
+    size_t num_records;
+    size_t record_size;
+    const void *fences;
+    size_t num_fences;
+    size_t fence_every;
+} macro_record_file_t;
+
+static inline bool macro_record_file_write(const char *filename, const void *records, size_t n,
+                                           size_t record_size, size_t fence_every) {
+    static const char zeros[64] = {0}; /* padding before the fence index */
+    macro_record_file_header_t h;
+    const char *p = (const char *)records;
+    size_t i, pad;
+    FILE *out;
+    if(!fence_every || !record_size)
+        return false;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, MACRO_RECORD_FILE_MAGIC, 8);
+    h.record_size = record_size;
+    h.num_records = n;
+    h.fence_every = fence_every;
+    h.num_fences = (n + fence_every - 1) / fence_every;
+    h.records_offset = sizeof(h);
+    h.fences_offset = (h.records_offset + n * record_size + 63) & ~(uint64_t)63;
+    h.file_size = h.fences_offset + h.num_fences * record_size;
+    out = fopen(filename, "wb");
+    if(!out)
+        return false;
+    pad = h.fences_offset - (h.records_offset + n * record_size);
+    if(fwrite(&h, sizeof(h), 1, out) != 1 ||
+       (n && fwrite(p, record_size, n, out) != n) ||
+       (pad && fwrite(zeros, pad, 1, out) != 1)) {
+        fclose(out);
+        return false;
+    }
+    for(i = 0; i < n; i += fence_every) {
+        if(fwrite(p + i * record_size, record_size, 1, out) != 1) {
+            fclose(out);
+            return false;
+        }
+    }
+    return fclose(out) == 0;
+}
+
+/* returns false if the file can't be mapped or isn't a record file of record_size
+   byte records */
+static inline bool macro_record_file_open(macro_record_file_t *f, const char *filename,
+                                          size_t record_size) {
+    macro_record_file_header_t h;
+    struct stat st;
+    int fd;
+    memset(f, 0, sizeof(*f));
+    fd = open(filename, O_RDONLY);
+    if(fd < 0)
+        return false;
+    if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(h)) {
+        close(fd);
+        return false;
+    }
+    f->map_size = (size_t)st.st_size;
+    f->map = mmap(NULL, f->map_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(f->map == MAP_FAILED) {
+        f->map = NULL;
+        return false;
+    }
+    memcpy(&h, f->map, sizeof(h));
+    /* the records and the fences must be inside the mapping (the sizes are compared
+       by division so that a corrupt count can't overflow) */
+    if(memcmp(h.magic, MACRO_RECORD_FILE_MAGIC, 8) || !record_size || h.record_size != record_size ||
+       h.file_size != f->map_size || !h.fence_every ||
+       h.num_fences != (h.num_records + h.fence_every - 1) / h.fence_every ||
+       h.records_offset < sizeof(h) || h.records_offset > h.file_size ||
+       h.num_records > (h.file_size - h.records_offset) / h.record_size ||
+       h.fences_offset > h.file_size ||
+       h.num_fences > (h.file_size - h.fences_offset) / h.record_size) {
+        munmap(f->map, f->map_size);
+        f->map = NULL;
+        return false;
+    }
+    f->records = (const char *)f->map + h.records_offset;
+    f->num_records = h.num_records;
+    f->record_size = h.record_size;
+    f->fences = (const char *)f->map + h.fences_offset;
+    f->num_fences = h.num_fences;
+    f->fence_every = h.fence_every;
+    return true;
+}
+
+static inline void macro_record_file_close(macro_record_file_t *f) {
+    if(f->map)
+        munmap(f->map, f->map_size);
+    memset(f, 0, sizeof(*f));
+}
+
+/* the styles which look for the first element >= key pick the block after the last
+   fence < key, and the others after the last fence <= key */
+#define __macro_record_file_fence_core(less, greater) greater
+#define __macro_record_file_fence_first(less, greater) greater
+#define __macro_record_file_fence_floor(less, greater) greater
+#define __macro_record_file_fence_lower_bound(less, greater) greater
+#define __macro_record_file_fence_last(less, greater) !(less)
+#define __macro_record_file_fence_ceiling(less, greater) !(less)
+#define __macro_record_file_fence_upper_bound(less, greater) !(less)
+
+/* sets base and n to the block that the bsearch code should search (the fences are
+   searched with the branchless bsearch code, so go_right is an expression of mid) */
+#define __macro_record_file_block(value_type, f, go_right)                       \
+    size_t c, start, stop;                                                       \
+    {                                                                            \
+        __macro_bsearch_branchless_code(value_type, f->fences, f->num_fences,    \
+                                        go_right);                               \
+        c = (size_t)(b - (value_type *)f->fences);                               \
+    }                                                                            \
+    start = c ? (c - 1) * f->fence_every : 0;                                    \
+    stop = c ? c * f->fence_every + 1 : 1;                                       \
+    if(stop > f->num_records)                                                    \
+        stop = f->num_records;                                                   \
+    const value_type *base = (const value_type *)f->records + start;             \
+    size_t n = stop - start
+
+#define __macro_record_file_code(bsearch_style, style, value_type, cmp, key, f)                      \
+    __macro_record_file_block(value_type, f,                                                         \
+        __macro_record_file_fence_ ## bsearch_style(macro_less(style, value_type, cmp, key, mid),    \
+                                                    macro_greater(style, value_type, cmp, key, mid))); \
+    __macro_bsearch_ ## bsearch_style ## _code(style, value_type, cmp, key, base, n)
+
+#define __macro_record_file_kv_code(bsearch_style, style, key_type, value_type, cmp, key, f)                 \
+    __macro_record_file_block(value_type, f,                                                                 \
+        __macro_record_file_fence_ ## bsearch_style(                                                         \
+            macro_less_kv(style, key_type, value_type, cmp, key, mid),                                       \
+            macro_greater_kv(style, key_type, value_type, cmp, key, mid)));                                \
+    __macro_bsearch_kv_ ## bsearch_style ## _code(style, key_type, value_type, cmp, key, base, n)
+
+#define _macro_record_file_h(name, style, value_type)    \
+    value_type *name(const macro_record_file_t *f, macro_cmp_signature(const value_type *key, style, value_type))
+
+#define _macro_record_file(name, bsearch_style, style, value_type, cmp)                 \
+    _macro_record_file_h(name, style, value_type) {                                     \
+        __macro_record_file_code(bsearch_style, style, value_type, cmp, key, f);        \
+    }
+
+#define _macro_record_file_kv_h(name, style, key_type, value_type)    \
+    value_type *name(const macro_record_file_t *f,                    \
+                     macro_cmp_kv_signature(const key_type *key, style, key_type, value_type))
+
+#define _macro_record_file_kv(name, bsearch_style, style, key_type, value_type, cmp)               \
+    _macro_record_file_kv_h(name, style, key_type, value_type) {                                   \
+        __macro_record_file_kv_code(bsearch_style, style, key_type, value_type, cmp, key, f);      \
+    }
+
+#define macro_record_file(name, value_type, cmp)    \
+    _macro_record_file(name, core, macro_bsearch_default(), value_type, cmp)
+
+#define macro_record_file_lower_bound(name, value_type, cmp)    \
+    _macro_record_file(name, lower_bound, macro_bsearch_default(), value_type, cmp)
+
+#define macro_record_file_upper_bound(name, value_type, cmp)    \
+    _macro_record_file(name, upper_bound, macro_bsearch_default(), value_type, cmp)
+
+#define macro_record_file_kv(name, key_type, value_type, cmp)    \
+    _macro_record_file_kv(name, core, macro_bsearch_default(), key_type, value_type, cmp)
+
+#define macro_record_file_lower_bound_kv(name, key_type, value_type, cmp)    \
+    _macro_record_file_kv(name, lower_bound, macro_bsearch_default(), key_type, value_type, cmp)
+
+#define macro_record_file_upper_bound_kv(name, key_type, value_type, cmp)    \
+    _macro_record_file_kv(name, upper_bound, macro_bsearch_default(), key_type, value_type, cmp)
+
+#endif /* _macro_record_file_H */
@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_set_ops_H
+#define _macro_set_ops_H
+
+#include "the-macro-library/macro_sort.h"
+#include "the-macro-library/src/macro_set_ops_code.h"
+
+/*
+    Set operations over sorted arrays (posting lists, sorted ids, ...) using the
+    macro_cmp styles.
+
+    macro_intersect(intersect_ints, int, int_less);
+    size_t intersect_ints(int *dest, const int *a, size_t na, const int *b, size_t nb);
+
+    macro_union(union_ints, int, int_less);
+    macro_difference(difference_ints, int, int_less);    (the elements of a not in b)
+
+    Each returns the number of elements written to dest.  dest must hold min(na, nb)
+    elements for the intersection, na + nb for the union and na for the difference.
+    Lopsided arrays are searched with galloping (see src/macro_set_ops_code.h).
+
+    macro_intersect_multi(intersect_many, int, int_less);
+    size_t intersect_many(int *dest, const int **lists, const size_t *sizes,
+                          size_t num_lists);
+
+    intersects any number of lists, starting with the shortest.
+
+    macro_intersect_uint32(dest, a, na, b, nb) is a function (not a generator) for
+    strictly increasing uint32_t lists which uses AVX2 when compiled with -mavx2.
+*/
+
+#define __macro_set_op_h(name, style, type)                                     \
+    size_t name(type *dest, const type *a, size_t na, const type *b,            \
+                macro_cmp_signature(size_t nb, style, type))
+
+#define __macro_set_op(name, op, signature_style, style, type, cmp)             \
+    __macro_set_op_h(name, signature_style, type) {                             \
+        size_t r;                                                               \
+        __macro_ ## op ## _code(style, type, cmp, dest, a, na, b, nb, r);       \
+        return r;                                                               \
+    }
+
+/* the extra level lets a style such as macro_sort_default() expand before compare_ is pasted */
+#define __macro_set_op_compare_h(name, style, type) __macro_set_op_h(name, compare_ ## style, type)
+#define __macro_set_op_compare(name, op, style, type)    \
+    __macro_set_op(name, op, compare_ ## style, style, type, cmp)
+
+#define _macro_intersect_h(name, style, type) __macro_set_op_h(name, style, type)
+#define _macro_intersect(name, style, type, cmp) __macro_set_op(name, intersect, style, style, type, cmp)
+#define _macro_intersect_compare_h(name, style, type) __macro_set_op_compare_h(name, style, type)
+#define _macro_intersect_compare(name, style, type) __macro_set_op_compare(name, intersect, style, type)
+
+#define _macro_union_h(name, style, type) __macro_set_op_h(name, style, type)
+#define _macro_union(name, style, type, cmp) __macro_set_op(name, union, style, style, type, cmp)
+#define _macro_union_compare_h(name, style, type) __macro_set_op_compare_h(name, style, type)
+#define _macro_union_compare(name, style, type) __macro_set_op_compare(name, union, style, type)
+
+#define _macro_difference_h(name, style, type) __macro_set_op_h(name, style, type)
+#define _macro_difference(name, style, type, cmp) __macro_set_op(name, difference, style, style, type, cmp)
+#define _macro_difference_compare_h(name, style, type) __macro_set_op_compare_h(name, style, type)
+#define _macro_difference_compare(name, style, type) __macro_set_op_compare(name, difference, style, type)
+
+#define _macro_intersect_multi_h(name, style, type)                             \
+    size_t name(type *dest, const type **lists, const size_t *sizes,            \
+                macro_cmp_signature(size_t num_lists, style, type))
+
+#define _macro_intersect_multi(name, style, type, cmp)                                  \
+    _macro_intersect_multi_h(name, style, type) {                                       \
+        __macro_intersect_multi_code(style, type, cmp, dest, lists, sizes, num_lists)   \
+    }
+
+#define _macro_intersect_multi_compare_h(name, style, type)    \
+    __macro_intersect_multi_compare_h(name, style, type)
+
+#define __macro_intersect_multi_compare_h(name, style, type)    \
+    _macro_intersect_multi_h(name, compare_ ## style, type)
+
+#define _macro_intersect_multi_compare(name, style, type)                               \
+    _macro_intersect_multi_compare_h(name, style, type) {                               \
+        __macro_intersect_multi_code(style, type, cmp, dest, lists, sizes, num_lists)   \
+    }
+
+#define macro_intersect_h(name, type) _macro_intersect_h(name, macro_sort_default(), type)
+#define macro_intersect(name, type, cmp) _macro_intersect(name, macro_sort_default(), type, cmp)
+#define macro_intersect_compare_h(name, type) _macro_intersect_compare_h(name, macro_sort_default(), type)
+#define macro_intersect_compare(name, type) _macro_intersect_compare(name, macro_sort_default(), type)
+
+#define macro_union_h(name, type) _macro_union_h(name, macro_sort_default(), type)
+#define macro_union(name, type, cmp) _macro_union(name, macro_sort_default(), type, cmp)
+#define macro_union_compare_h(name, type) _macro_union_compare_h(name, macro_sort_default(), type)
+#define macro_union_compare(name, type) _macro_union_compare(name, macro_sort_default(), type)
+
+#define macro_difference_h(name, type) _macro_difference_h(name, macro_sort_default(), type)
+#define macro_difference(name, type, cmp) _macro_difference(name, macro_sort_default(), type, cmp)
+#define macro_difference_compare_h(name, type) _macro_difference_compare_h(name, macro_sort_default(), type)
+#define macro_difference_compare(name, type) _macro_difference_compare(name, macro_sort_default(), type)
+
+#define macro_intersect_multi_h(name, type) _macro_intersect_multi_h(name, macro_sort_default(), type)
+#define macro_intersect_multi(name, type, cmp) _macro_intersect_multi(name, macro_sort_default(), type, cmp)
+#define macro_intersect_multi_compare_h(name, type)    \
+    _macro_intersect_multi_compare_h(name, macro_sort_default(), type)
+#define macro_intersect_multi_compare(name, type)    \
+    _macro_intersect_multi_compare(name, macro_sort_default(), type)
+
+#endif /* _macro_set_ops_H */
@@ -0,0 +1,138 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_sort_iter_H
+#define _macro_sort_iter_H
+
+#include "the-macro-library/macro_sort.h"
+
+/*
+    An iterator which returns the elements of an array in sorted order while only
+    sorting as much of the array as has been consumed (incremental quicksort).  This
+    is useful for "show the first N results, then maybe more" queries where sorting
+    everything up front is wasted work.  Getting the first k elements costs
+    O(n + k log k) comparisons.
+
+    macro_sort_iter_next(next_int, int, compare_ints);
+
+    macro_sort_iter_t iter;
+    macro_sort_iter_init(&iter, arr, n);
+    int *p;
+    while((p = next_int(&iter)) != NULL) {
+        // p points into arr, everything before p is sorted
+    }
+
+    type *name(macro_sort_iter_t *iter);
+
+    The stack holds the boundaries of the partitions to the right of the current
+    position.  Only the leftmost unsorted segment is partitioned (using the same
+    pivot selection and dutch flag partition as macro_sort).  The range equal to the
+    pivot is marked as sorted, and segments under MACRO_SORT_SMALL elements are
+    insertion sorted.  If the stack gets deep (bad pivots), the leftmost segment is heap
+    sorted.
+
+    The array must not be modified while it is being iterated.
+*/
+
+typedef struct {
+    size_t end;
+    size_t sorted;
+} __macro_sort_iter_stack_t;
+
+typedef struct {
+    void *base;
+    size_t pos;
+    size_t n;
+    int top;
+    __macro_sort_iter_stack_t stack[128];
+} macro_sort_iter_t;
+
+static inline void macro_sort_iter_init(macro_sort_iter_t *iter, void *base, size_t n) {
+    iter->base = base;
+    iter->pos = 0;
+    iter->n = n;
+    iter->top = 1;
+    iter->stack[0].end = n;
+    iter->stack[0].sorted = n < 2 ? 1 : 0;
+}
+
+#define __macro_sort_iter_push(iter, end_p, is_sorted)     \
+    iter->stack[iter->top].end = (end_p) - base;           \
+    iter->stack[iter->top].sorted = is_sorted;             \
+    iter->top++
+
+#define __macro_sort_iter_next_code(style, type, cmp)                          \
+    type *base = (type *)iter->base;                                           \
+    type *lo, *mid, *hi, *a, *b, *c, *d, *e, *f, *res;                          \
+    type tmp;                                                                  \
+    ssize_t n, delta, left_n, right_n, tmp_n;                                  \
+    size_t end;                                                                \
+    if(iter->pos >= iter->n)                                                   \
+        return NULL;                                                           \
+    while(true) {                                                              \
+        end = iter->stack[iter->top - 1].end;                                  \
+        if(iter->stack[iter->top - 1].sorted)                                  \
+            break;                                                             \
+        n = end - iter->pos;                                                   \
+        lo = base + iter->pos;                                                 \
+        if(n < MACRO_SORT_SMALL) {                                             \
+            macro_isort(style, type, cmp, lo, n, e, a, b, tmp);                \
+            iter->stack[iter->top - 1].sorted = 1;                             \
+            break;                                                             \
+        }                                                                      \
+        if(iter->top > 125) {                                                  \
+            a = lo;                                                            \
+            macro_heap_sort(style, type, cmp, lo, n, a, b, c, d, e, f)         \
+            iter->stack[iter->top - 1].sorted = 1;                             \
+            break;                                                             \
+        }                                                                      \
+        hi = lo + (n - 1);                                                     \
+        mid = lo + (n >> 1);                                                   \
+        if(n > MACRO_SORT_NINTHER) {                                           \
+            __macro_pivot_ninther(style, type, cmp);                           \
+        } else {                                                               \
+            __macro_pivot_5ther(style, type, cmp);                             \
+        }                                                                      \
+        macro_dutch_flag_partition(iq, style, type, cmp,                       \
+                                   lo, mid, hi,                                \
+                                   a, b, c, d,                                 \
+                                   left_n, right_n, tmp_n)                     \
+        if(right_n) {                                                          \
+            __macro_sort_iter_push(iter, c, 1);                                \
+        } else                                                                 \
+            iter->stack[iter->top - 1].sorted = 1;                             \
+        if(left_n > 0) {                                                       \
+            __macro_sort_iter_push(iter, lo + left_n, 0);                      \
+        }                                                                      \
+    }                                                                          \
+    res = base + iter->pos;                                                    \
+    iter->pos++;                                                               \
+    if(iter->pos == end)                                                       \
+        iter->top--;                                                           \
+    return res;
+
+#define _macro_sort_iter_next_h(name, style, type)    \
+    type *name(macro_cmp_signature(macro_sort_iter_t *iter, style, type))
+
+#define _macro_sort_iter_next(name, style, type, cmp)    \
+    _macro_sort_iter_next_h(name, style, type) {         \
+        __macro_sort_iter_next_code(style, type, cmp);   \
+    }
+
+#define _macro_sort_iter_next_compare_h(name, style, type)    \
+    __macro_sort_iter_next_compare_h(name, style, type)
+
+#define __macro_sort_iter_next_compare_h(name, style, type)    \
+    _macro_sort_iter_next_h(name, compare_ ## style, type)
+
+#define _macro_sort_iter_next_compare(name, style, type)    \
+    _macro_sort_iter_next_compare_h(name, style, type) {    \
+        __macro_sort_iter_next_code(style, type, cmp);      \
+    }
+
+#define macro_sort_iter_next_h(name, type) _macro_sort_iter_next_h(name, macro_sort_default(), type)
+#define macro_sort_iter_next(name, type, cmp) _macro_sort_iter_next(name, macro_sort_default(), type, cmp)
+
+#define macro_sort_iter_next_compare_h(name, type) _macro_sort_iter_next_compare_h(name, macro_sort_default(), type)
+#define macro_sort_iter_next_compare(name, type) _macro_sort_iter_next_compare(name, macro_sort_default(), type)
+
+#endif /* _macro_sort_iter_H */
@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_sort_resumable_H
+#define _macro_sort_resumable_H
+
+#include "the-macro-library/macro_sort.h"
+#include "the-macro-library/src/macro_introsort_step.h"
+
+/*
+    A resumable sort for when a large array must be sorted without blocking for long
+    (an event loop for example).  The state holds the introsort stack, so the sort can
+    stop in the middle and continue with the next call.
+
+    macro_sort_resumable(sort_ints_step, int, compare_ints);
+
+    macro_sort_state_t state;
+    macro_sort_state_init(&state, arr, n);
+    while(!sort_ints_step(&state, 200000, 0)) {
+        // do other work, call again later
+    }
+
+    bool name(macro_sort_state_t *state, uint64_t budget_ns, size_t budget_comparisons);
+
+    The step returns true once the array is sorted.  budget_ns is measured with
+    macro_now() and budget_comparisons counts calls to the compare function (the
+    insertion sort, pivot selection, and heap sort are counted approximately).  Zero
+    means no limit for either budget.  Each step does at least a little work, so a
+    step may run slightly over budget.
+
+    The array must not be modified between steps.
+*/
+
+#define _macro_sort_resumable_h(name, style, type)               \
+    bool name(macro_sort_state_t *state, uint64_t budget_ns,     \
+              macro_cmp_signature(size_t budget_comparisons, style, type))
+
+#define _macro_sort_resumable(name, style, type, cmp)    \
+    _macro_sort_resumable_h(name, style, type) {         \
+        __macro_sort_step_code(style, type, cmp);        \
+    }
+
+#define _macro_sort_resumable_compare_h(name, style, type)    \
+    __macro_sort_resumable_compare_h(name, style, type)
+
+#define __macro_sort_resumable_compare_h(name, style, type)    \
+    _macro_sort_resumable_h(name, compare_ ## style, type)
+
+#define _macro_sort_resumable_compare(name, style, type)    \
+    _macro_sort_resumable_compare_h(name, style, type) {    \
+        __macro_sort_step_code(style, type, cmp);           \
+    }
+
+#define macro_sort_resumable_h(name, type) _macro_sort_resumable_h(name, macro_sort_default(), type)
+#define macro_sort_resumable(name, type, cmp) _macro_sort_resumable(name, macro_sort_default(), type, cmp)
+
+#define macro_sort_resumable_compare_h(name, type) _macro_sort_resumable_compare_h(name, macro_sort_default(), type)
+#define macro_sort_resumable_compare(name, type) _macro_sort_resumable_compare(name, macro_sort_default(), type)
+
+#endif /* _macro_sort_resumable_H */
@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_sort_soa_H
+#define _macro_sort_soa_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "the-macro-library/macro_cmp.h"
+#include "the-macro-library/macro_sort.h"
+#include "the-macro-library/src/macro_for_each.h"
+#include "the-macro-library/src/macro_merge_sort.h"
+
+/*
+    macro_sort_soa sorts a key array and applies the same permutation to one or more
+    payload arrays (structure of arrays / columnar data).  Each payload column is given
+    as (type, name), and name becomes the parameter name.
+
+    macro_sort_soa(sort_by_id, uint32_t, compare_ids, (double, price), (char *, label));
+
+    bool sort_by_id(uint32_t *keys, double *price, char **label, size_t n);
+
+    The keys are copied into (key, index) pairs which are sorted with the merge sort
+    from macro_merge_sort.h (so the sort is stable and equal keys keep their order).
+    The keys are then written back and each column is permuted one at a time through a
+    scratch buffer (shared with the merge sort), so every column is gathered once and
+    written back sequentially.
+
+    false is returned (and the arrays are left as is) if the scratch memory can't be
+    allocated.  The comparison styles are the same as macro_sort's (_macro_sort_soa,
+    _h and _compare variants), with the arg (if any) following n.
+*/
+
+/* compares the key of two (key, index) pairs, cmp is (style, key_type, cmp) */
+#define macro_less_soa(type, cmp, a, b) __macro_soa_less(__macro_strip cmp, a, b)
+#define __macro_soa_less(...) __macro_soa_less_(__VA_ARGS__)
+#define __macro_soa_less_(style, key_type, cmp, a, b)    \
+    macro_less_ ## style(key_type, cmp, &(a)->key, &(b)->key)
+
+#define __macro_soa_param(ctx, t) __macro_apply(__macro_soa_param_, ctx, t)
+#define __macro_soa_param_(ctx, type, name) type *name,
+
+#define __macro_soa_width(ctx, t) __macro_apply(__macro_soa_width_, ctx, t)
+#define __macro_soa_width_(ctx, type, name)    \
+    if(sizeof(type) > width)                   \
+        width = sizeof(type);
+
+#define __macro_soa_permute(ctx, t) __macro_apply(__macro_soa_permute_, ctx, t)
+#define __macro_soa_permute_(ctx, type, name)    \
+    {                                            \
+        type *dst = (type *)scratch;             \
+        for(i = 0; i < n; i++)                   \
+            dst[i] = name[pairs[i].index];       \
+        for(i = 0; i < n; i++)                   \
+            name[i] = dst[i];                    \
+    }
+
+#define __macro_sort_soa_code(style, key_type, cmp, ...)                                 \
+    typedef struct {                                                                     \
+        key_type key;                                                                    \
+        size_t index;                                                                    \
+    } __macro_soa_pair_t;                                                                \
+    __macro_soa_pair_t *pairs;                                                           \
+    void *scratch;                                                                       \
+    size_t i, width = 0, merge_size = ((n >> 1) + 1) * sizeof(__macro_soa_pair_t);       \
+    if(n < 2)                                                                            \
+        return true;                                                                     \
+    __macro_for_each(__macro_soa_width, _, __VA_ARGS__)                                  \
+    pairs = (__macro_soa_pair_t *)malloc(n * sizeof(__macro_soa_pair_t));                \
+    scratch = malloc(n * width > merge_size ? n * width : merge_size);                   \
+    if(!pairs || !scratch) {                                                             \
+        free(pairs);                                                                     \
+        free(scratch);                                                                   \
+        return false;                                                                    \
+    }                                                                                    \
+    for(i = 0; i < n; i++) {                                                             \
+        pairs[i].key = keys[i];                                                          \
+        pairs[i].index = i;                                                              \
+    }                                                                                    \
+    __macro_merge_sort_code(soa, __macro_soa_pair_t, (style, key_type, cmp),             \
+                            pairs, n, (__macro_soa_pair_t *)scratch);                    \
+    for(i = 0; i < n; i++)                                                               \
+        keys[i] = pairs[i].key;                                                          \
+    __macro_for_each(__macro_soa_permute, _, __VA_ARGS__)                                \
+    free(scratch);                                                                       \
+    free(pairs);                                                                         \
+    return true;
+
+#define _macro_sort_soa_h(name, style, key_type, ...)                                    \
+    bool name(key_type *keys, __macro_for_each(__macro_soa_param, _, __VA_ARGS__)        \
+              macro_cmp_signature(size_t n, style, key_type))
+
+#define _macro_sort_soa(name, style, key_type, cmp, ...)                 \
+    _macro_sort_soa_h(name, style, key_type, __VA_ARGS__) {              \
+        __macro_sort_soa_code(style, key_type, cmp, __VA_ARGS__)         \
+    }
+
+#define _macro_sort_soa_compare_h(name, style, key_type, ...)    \
+    __macro_sort_soa_compare_h(name, style, key_type, __VA_ARGS__)
+
+#define __macro_sort_soa_compare_h(name, style, key_type, ...)    \
+    _macro_sort_soa_h(name, compare_ ## style, key_type, __VA_ARGS__)
+
+#define _macro_sort_soa_compare(name, style, key_type, ...)              \
+    _macro_sort_soa_compare_h(name, style, key_type, __VA_ARGS__) {      \
+        __macro_sort_soa_code(style, key_type, cmp, __VA_ARGS__)         \
+    }
+
+#define macro_sort_soa_h(name, key_type, ...)    \
+    _macro_sort_soa_h(name, macro_sort_default(), key_type, __VA_ARGS__)
+#define macro_sort_soa(name, key_type, cmp, ...)    \
+    _macro_sort_soa(name, macro_sort_default(), key_type, cmp, __VA_ARGS__)
+
+#define macro_sort_soa_compare_h(name, key_type, ...)    \
+    _macro_sort_soa_compare_h(name, macro_sort_default(), key_type, __VA_ARGS__)
+#define macro_sort_soa_compare(name, key_type, ...)    \
+    _macro_sort_soa_compare(name, macro_sort_default(), key_type, __VA_ARGS__)
+
+#endif /* _macro_sort_soa_H */
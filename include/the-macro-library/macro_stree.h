@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_stree_H
+#define _macro_stree_H
+
+#include <stdbool.h>
+
+#include "the-macro-library/src/macro_stree_code.h"
+
+/*
+    A read-only static B+ tree (S-tree) for sorted arrays of 32 or 64 bit integers
+    (int32_t, uint32_t, int64_t, uint64_t, int, ...).  Each node is a 64 byte cache line
+    holding 16 (or 8) keys, so a lookup touches one cache line per level (about
+    log17(n) lines) instead of one per step of a binary search, and each node is
+    searched with an AVX2 compare and movemask when compiled with -mavx2.
+
+    macro_stree_t(uint32_stree_t, uint32_t);
+    macro_stree_build(uint32_stree_build, uint32_t, uint32_stree_t);
+    macro_stree_lower_bound(uint32_stree_lower_bound, uint32_t, uint32_stree_t);
+    macro_stree_upper_bound(uint32_stree_upper_bound, uint32_t, uint32_stree_t);
+
+    bool uint32_stree_build(uint32_stree_t *t, const uint32_t *sorted, size_t n);
+    size_t uint32_stree_lower_bound(const uint32_stree_t *t, uint32_t key);
+    size_t uint32_stree_upper_bound(const uint32_stree_t *t, uint32_t key);
+
+    build copies the keys (sorted is not referenced afterwards) and returns false if
+    the memory can't be allocated.  lower_bound returns the position in sorted of the
+    first key >= key and upper_bound the first key > key (n if there isn't one).
+    macro_stree_destroy(t) frees the tree.
+*/
+
+#define macro_stree_t(name, key_type)                  \
+    typedef struct {                                   \
+        key_type *tree;                                \
+        size_t n;                                      \
+        size_t height;                                 \
+        size_t offset[__macro_stree_max_height];       \
+    } name
+
+#define macro_stree_destroy(t) free((t)->tree)
+
+#define macro_stree_build_h(name, key_type, stree_type)    \
+    bool name(stree_type *t, const key_type *sorted, size_t n)
+
+#define macro_stree_build(name, key_type, stree_type)               \
+    macro_stree_build_h(name, key_type, stree_type) {               \
+        __macro_stree_build_code(key_type, t, sorted, n)            \
+    }
+
+#define macro_stree_lower_bound_h(name, key_type, stree_type)    \
+    size_t name(const stree_type *t, key_type key)
+
+#define macro_stree_lower_bound(name, key_type, stree_type)         \
+    macro_stree_lower_bound_h(name, key_type, stree_type) {         \
+        __macro_stree_lower_bound_code(key_type, t, key)            \
+    }
+
+#define macro_stree_upper_bound_h(name, key_type, stree_type)    \
+    size_t name(const stree_type *t, key_type key)
+
+#define macro_stree_upper_bound(name, key_type, stree_type)         \
+    macro_stree_upper_bound_h(name, key_type, stree_type) {         \
+        __macro_stree_upper_bound_code(key_type, t, key)            \
+    }
+
+#endif /* _macro_stree_H */
@@ -10,26 +10,30 @@
 
    This also can serve as an example for building a new map type.
 
-   The caller is expected to allocate the macro_string_id_map_t structure prior to insert.
+   The caller is expected to allocate the macro_string_id_map_t structure prior to insert.  macro_map_arena.h
+   allocates the node and the string together (other allocators can be used).
 
-   #include "a-memory-library/aml_pool.h" // other allocators can be used
+   #include "the-macro-library/macro_map_arena.h"
    #include <stdio.h>
    #include <string.h>
 
-   aml_pool_t *pool = aml_pool_init(16384);
+   macro_map_arena_t arena;
+   macro_map_arena_init(&arena, 65536);
    macro_map_t *root = NULL;
 
-   void macro_string_id_insert(aml_pool_t *pool, macro_map_t **root, const char *key, size_t value) {
+   void macro_string_id_insert(macro_map_arena_t *arena, macro_map_t **root, const char *key, size_t value) {
        // assuming that the str/id doesn't already exist!
-       macro_string_id_map_t* node = (macro_string_id_map_t*)aml_pool_alloc(pool, sizeof(*node) + strlen(key)+1);
-       strcpy((char *)(node+1), str);
+       macro_string_id_map_t* node =
+           (macro_string_id_map_t*)macro_map_arena_alloc_key(arena, sizeof(*node), key, strlen(key));
        node->id = value;
        _macro_string_id_insert(root, node); // notice the underscore!
     }
 
-    macro_string_id_insert(pool, &root, "Hello", 1);
-    macro_string_id_insert(pool, &root, "World", 2);
+    macro_string_id_insert(&arena, &root, "Hello", 1);
+    macro_string_id_insert(&arena, &root, "World", 2);
     printf( "World == %zu\n", macro_string_id_find(root, "World")); // should print 2
+
+    macro_map_arena_free_tree(&arena, root, macro_string_id_map_size, NULL); // or macro_map_arena_destroy(&arena)
 */
 
 #include "the-macro-library/macro_map.h"
@@ -62,11 +66,17 @@ static inline
 macro_map_find_kv(macro_string_id_find_node, char,  macro_string_id_map_t, compare_macro_string_id_map_for_find);
 // macro_string_id_map_t* macro_string_id_find_node(const macro_map_t *root, const char *str);
 
+/* the number of bytes used by the node and its string (a macro_map_arena_size_cb) */
+static inline size_t macro_string_id_map_size(const macro_map_t *n, void *arg) {
+    (void)arg;
+    return sizeof(macro_string_id_map_t) + strlen((const char *)((const macro_string_id_map_t *)n + 1)) + 1;
+}
+
 static inline size_t macro_string_id_find(const macro_map_t *root, const char *str) {
     if(!str)
         return 0;
 
-    macro_string_id_map_t* r = _macro_string_id_find(root, str);
+    macro_string_id_map_t* r = macro_string_id_find_node(root, str);
     if(r) return r->id;
     return 0;
 }
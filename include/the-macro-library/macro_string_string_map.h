@@ -9,26 +9,31 @@
 
    This also can serve as an example for building a new map type.
 
-   The caller is expected to allocate the macro_map_t structure prior to insert.
+   The caller is expected to allocate the macro_map_t structure prior to insert.  macro_map_arena.h allocates the
+   node and the strings together (other allocators can be used).
 
-   #include "a-memory-library/aml_pool.h" // other allocators can be used
+   #include "the-macro-library/macro_map_arena.h"
    #include <stdio.h>
    #include <string.h>
 
-   aml_pool_t *pool = aml_pool_init(16384);
+   macro_map_arena_t arena;
+   macro_map_arena_init(&arena, 65536);
    macro_map_t *root = NULL;
 
-   void macro_string_string_insert(aml_pool_t *pool, macro_map_t **root, const char *key, const char *value) {
+   void macro_string_string_insert(macro_map_arena_t *arena, macro_map_t **root, const char *key, const char *value) {
        // assuming that the str/id doesn't already exist!
-       macro_map_t* node = (macro_map_t*)aml_pool_alloc(pool, sizeof(*node) + strlen(key)+strlen(value)+2);
+       size_t key_len = strlen(key);
+       macro_map_t* node = (macro_map_t*)macro_map_arena_alloc(arena, sizeof(*node) + key_len+strlen(value)+2);
        strcpy((char *)(node+1), key);
-       strcpy(key+strlen(key)+1, value);
+       strcpy((char *)(node+1)+key_len+1, value);
        _macro_string_string_insert(root, node); // notice the underscore!
     }
 
-    macro_string_string_insert(pool, &root, "Hello", "World");
-    macro_string_string_insert(pool, &root, "Good", "Bye);
-    printf( "World == %s\n", macro_string_id_find(root, "Good")); // should print Bye
+    macro_string_string_insert(&arena, &root, "Hello", "World");
+    macro_string_string_insert(&arena, &root, "Good", "Bye");
+    printf( "Good == %s\n", macro_string_string_find(root, "Good")); // should print Bye
+
+    macro_map_arena_free_tree(&arena, root, macro_string_string_map_size, NULL); // or macro_map_arena_destroy(&arena)
 */
 
 #include "the-macro-library/macro_map.h"
@@ -53,6 +58,14 @@ static macro_map_insert(_macro_string_string_insert, macro_map_t, compare_macro_
 static macro_map_find_kv(_macro_string_string_find, char,  macro_map_t, compare_macro_string_string_map_for_find);
 // macro_map_t* _macro_string_string_find(const macro_map_t *root, const char *key);
 
+/* the number of bytes used by the node and its strings (a macro_map_arena_size_cb) */
+static inline size_t macro_string_string_map_size(const macro_map_t *n, void *arg) {
+    const char *k = (const char *)(n+1);
+    size_t key_len = strlen(k);
+    (void)arg;
+    return sizeof(macro_map_t) + key_len + strlen(k+key_len+1) + 2;
+}
+
 static inline const char *macro_string_string_find(const macro_map_t *root, const char *key) {
     if(!key)
         return NULL;
@@ -0,0 +1,129 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_bsearch_batch_code_H
+#define _macro_bsearch_batch_code_H
+
+#include <stddef.h>
+
+#include "the-macro-library/macro_cmp.h"
+#include "the-macro-library/src/macro_prefetch.h"
+
+/*
+    The batched search runs the branchless search (see macro_bsearch_code.h) for a
+    group of MACRO_BSEARCH_BATCH keys at a time.  The length sequence of the branchless
+    search only depends on n, so every search in the group takes its step together.
+    After a search takes its step, the midpoint of its next step is prefetched.  By
+    the time the group comes back to it, the line is (hopefully) in cache, so up to
+    MACRO_BSEARCH_BATCH misses are outstanding instead of one.
+*/
+#ifndef MACRO_BSEARCH_BATCH
+#define MACRO_BSEARCH_BATCH 16
+#endif
+
+/* go_right is an expression of key and mid, finish an expression of key and p (the
+   first element for which go_right is false or end, which is lo for an empty array) */
+#define __macro_bsearch_batch_code(key_type, value_type, go_right, finish)        \
+    value_type *b[MACRO_BSEARCH_BATCH];                                           \
+    value_type *lo = (value_type *)base;                                          \
+    value_type *end = lo + n;                                                     \
+    value_type *mid, *p;                                                          \
+    const key_type *key;                                                          \
+    size_t i, j, g, len, half;                                                    \
+    for(i = 0; i < num_keys; i += g) {                                            \
+        g = num_keys - i < MACRO_BSEARCH_BATCH ? num_keys - i : MACRO_BSEARCH_BATCH; \
+        if(!n) {                                                                  \
+            for(j = 0; j < g; j++) {                                              \
+                key = keys + i + j;                                               \
+                p = lo;                                                           \
+                results[i + j] = (finish);                                        \
+            }                                                                     \
+            continue;                                                             \
+        }                                                                         \
+        for(j = 0; j < g; j++)                                                    \
+            b[j] = lo;                                                            \
+        __mcro_prefetch(lo + (n >> 1));                                           \
+        len = n;                                                                  \
+        while(len > 1) {                                                          \
+            half = len >> 1;                                                      \
+            len -= half;                                                          \
+            for(j = 0; j < g; j++) {                                              \
+                key = keys + i + j;                                               \
+                mid = b[j] + half - 1;                                            \
+                b[j] += (size_t)(go_right) * half;                                \
+                __mcro_prefetch(b[j] + (len >> 1));                               \
+            }                                                                     \
+        }                                                                         \
+        for(j = 0; j < g; j++) {                                                  \
+            key = keys + i + j;                                                   \
+            mid = b[j];                                                           \
+            p = b[j] + (size_t)(go_right);                                        \
+            results[i + j] = (finish);                                            \
+        }                                                                         \
+    }                                                                             \
+    (void)end;
+
+#define __macro_bsearch_batch_lower(style, value_type, cmp, finish)                \
+    __macro_bsearch_batch_code(value_type, value_type,                             \
+                               macro_greater(style, value_type, cmp, key, mid), finish)
+
+#define __macro_bsearch_batch_upper(style, value_type, cmp, finish)                \
+    __macro_bsearch_batch_code(value_type, value_type,                             \
+                               !macro_less(style, value_type, cmp, key, mid), finish)
+
+#define __macro_bsearch_batch_kv_lower(style, key_type, value_type, cmp, finish)   \
+    __macro_bsearch_batch_code(key_type, value_type,                               \
+                               macro_greater_kv(style, key_type, value_type, cmp, key, mid), finish)
+
+#define __macro_bsearch_batch_kv_upper(style, key_type, value_type, cmp, finish)   \
+    __macro_bsearch_batch_code(key_type, value_type,                               \
+                               !macro_less_kv(style, key_type, value_type, cmp, key, mid), finish)
+
+#define __macro_bsearch_batch_core_code(style, value_type, cmp)                        \
+    __macro_bsearch_batch_lower(style, value_type, cmp,                                \
+        p < end && macro_equal(style, value_type, cmp, key, p) ? p : NULL)
+
+#define __macro_bsearch_batch_first_code(style, value_type, cmp)                       \
+    __macro_bsearch_batch_core_code(style, value_type, cmp)
+
+#define __macro_bsearch_batch_last_code(style, value_type, cmp)                        \
+    __macro_bsearch_batch_upper(style, value_type, cmp,                                \
+        p > lo && macro_equal(style, value_type, cmp, key, p - 1) ? p - 1 : NULL)
+
+#define __macro_bsearch_batch_floor_code(style, value_type, cmp)                       \
+    __macro_bsearch_batch_lower(style, value_type, cmp,                                \
+        p < end && macro_equal(style, value_type, cmp, key, p) ? p : (p > lo ? p - 1 : NULL))
+
+#define __macro_bsearch_batch_ceiling_code(style, value_type, cmp)                     \
+    __macro_bsearch_batch_upper(style, value_type, cmp, p > lo ? p - 1 : NULL)
+
+#define __macro_bsearch_batch_lower_bound_code(style, value_type, cmp)                 \
+    __macro_bsearch_batch_lower(style, value_type, cmp, p < end ? p : NULL)
+
+#define __macro_bsearch_batch_upper_bound_code(style, value_type, cmp)                 \
+    __macro_bsearch_batch_upper(style, value_type, cmp, p)
+
+#define __macro_bsearch_batch_kv_core_code(style, key_type, value_type, cmp)                     \
+    __macro_bsearch_batch_kv_lower(style, key_type, value_type, cmp,                             \
+        p < end && macro_equal_kv(style, key_type, value_type, cmp, key, p) ? p : NULL)
+
+#define __macro_bsearch_batch_kv_first_code(style, key_type, value_type, cmp)                    \
+    __macro_bsearch_batch_kv_core_code(style, key_type, value_type, cmp)
+
+#define __macro_bsearch_batch_kv_last_code(style, key_type, value_type, cmp)                     \
+    __macro_bsearch_batch_kv_upper(style, key_type, value_type, cmp,                             \
+        p > lo && macro_equal_kv(style, key_type, value_type, cmp, key, p - 1) ? p - 1 : NULL)
+
+#define __macro_bsearch_batch_kv_floor_code(style, key_type, value_type, cmp)                    \
+    __macro_bsearch_batch_kv_lower(style, key_type, value_type, cmp,                             \
+        p < end && macro_equal_kv(style, key_type, value_type, cmp, key, p) ? p : (p > lo ? p - 1 : NULL))
+
+#define __macro_bsearch_batch_kv_ceiling_code(style, key_type, value_type, cmp)                  \
+    __macro_bsearch_batch_kv_upper(style, key_type, value_type, cmp, p > lo ? p - 1 : NULL)
+
+#define __macro_bsearch_batch_kv_lower_bound_code(style, key_type, value_type, cmp)              \
+    __macro_bsearch_batch_kv_lower(style, key_type, value_type, cmp, p < end ? p : NULL)
+
+#define __macro_bsearch_batch_kv_upper_bound_code(style, key_type, value_type, cmp)              \
+    __macro_bsearch_batch_kv_upper(style, key_type, value_type, cmp, p)
+
+#endif /* _macro_bsearch_batch_code_H */
@@ -3,6 +3,7 @@
 #include <stdio.h>
 
 #include "the-macro-library/macro_cmp.h"
+#include "the-macro-library/src/macro_prefetch.h"
 
 /* TODO: consider reducing the amount of repeated logic as was done in macro_map.h */
 
@@ -207,6 +208,7 @@
     return lo < high ? lo : NULL;
 
 #define __macro_bsearch_upper_bound_code(style, value_type, cmp, key, base, n)    \
+    if(!n) return (value_type *)base;                                             \
     __macro_bsearch_vars(value_type, base, n);                                    \
     while(lo < hi) {                                                              \
         mid = lo + ((hi - lo) >> 1);                                              \
@@ -218,6 +220,7 @@
     return lo;
 
 #define __macro_bsearch_kv_upper_bound_code(style, key_type, value_type, cmp, key, base, n)    \
+    if(!n) return (value_type *)base;                                                          \
     __macro_bsearch_vars(value_type, base, n);                                                 \
     while(lo < hi) {                                                                           \
         mid = lo + ((hi - lo) >> 1);                                                           \
@@ -227,3 +230,129 @@
             lo = mid + 1;                                                                      \
     }                                                                                          \
     return lo;
+
+/*
+    The branchless family (select with bsearch_style branchless_core, branchless_first,
+    ...).  The search keeps a base and a length which is halved each step, and the only
+    decision is whether base moves forward by half (which compiles to a conditional
+    move), so there are no mispredicted branches and the number of steps only depends
+    on n.  Both possible midpoints of the next step are prefetched (define
+    MACRO_BSEARCH_PREFETCH to 0 to turn this off, which is better for arrays that fit
+    in L1).
+
+    Each flavor finds the lower bound (the first element >= key) or the upper bound
+    (the first element > key) and returns the same element as its branchy version, except
+    that branchless_core always returns the first of several equal elements.
+*/
+#ifndef MACRO_BSEARCH_PREFETCH
+#define MACRO_BSEARCH_PREFETCH 1
+#endif
+
+#if MACRO_BSEARCH_PREFETCH
+#define __mcro_bsearch_prefetch(p) __mcro_prefetch(p)
+#else
+#define __mcro_bsearch_prefetch(p) ((void)0)
+#endif
+
+/* sets b to the first element for which go_right (an expression of mid) is false
+   (or end, which is base for an empty array) */
+#define __macro_bsearch_branchless_code(value_type, base, n, go_right)    \
+    value_type *b = (value_type *)base;                                   \
+    value_type *end = b + n;                                              \
+    value_type *mid;                                                      \
+    size_t len = n, half;                                                 \
+    if(n) {                                                               \
+        while(len > 1) {                                                  \
+            half = len >> 1;                                              \
+            len -= half;                                                  \
+            __mcro_bsearch_prefetch(b + (len >> 1));                      \
+            __mcro_bsearch_prefetch(b + half + (len >> 1));               \
+            mid = b + half - 1;                                           \
+            b += (size_t)(go_right) * half;                               \
+        }                                                                 \
+        mid = b;                                                          \
+        b += (size_t)(go_right);                                          \
+    }                                                                     \
+    (void)end
+
+#define __macro_bsearch_branchless_lower(style, value_type, cmp, key, base, n)    \
+    __macro_bsearch_branchless_code(value_type, base, n,                          \
+                                    macro_greater(style, value_type, cmp, key, mid))
+
+#define __macro_bsearch_branchless_upper(style, value_type, cmp, key, base, n)    \
+    __macro_bsearch_branchless_code(value_type, base, n,                          \
+                                    !macro_less(style, value_type, cmp, key, mid))
+
+#define __macro_bsearch_kv_branchless_lower(style, key_type, value_type, cmp, key, base, n)    \
+    __macro_bsearch_branchless_code(value_type, base, n,                                       \
+                                    macro_greater_kv(style, key_type, value_type, cmp, key, mid))
+
+#define __macro_bsearch_kv_branchless_upper(style, key_type, value_type, cmp, key, base, n)    \
+    __macro_bsearch_branchless_code(value_type, base, n,                                       \
+                                    !macro_less_kv(style, key_type, value_type, cmp, key, mid))
+
+#define __macro_bsearch_branchless_core_code(style, value_type, cmp, key, base, n)    \
+    __macro_bsearch_branchless_lower(style, value_type, cmp, key, base, n);           \
+    if(b < end && macro_equal(style, value_type, cmp, key, b))                        \
+        return b;                                                                     \
+    return NULL;
+
+#define __macro_bsearch_kv_branchless_core_code(style, key_type, value_type, cmp, key, base, n)    \
+    __macro_bsearch_kv_branchless_lower(style, key_type, value_type, cmp, key, base, n);           \
+    if(b < end && macro_equal_kv(style, key_type, value_type, cmp, key, b))                        \
+        return b;                                                                                  \
+    return NULL;
+
+#define __macro_bsearch_branchless_first_code(style, value_type, cmp, key, base, n)    \
+    __macro_bsearch_branchless_core_code(style, value_type, cmp, key, base, n)
+
+#define __macro_bsearch_kv_branchless_first_code(style, key_type, value_type, cmp, key, base, n)    \
+    __macro_bsearch_kv_branchless_core_code(style, key_type, value_type, cmp, key, base, n)
+
+#define __macro_bsearch_branchless_last_code(style, value_type, cmp, key, base, n)    \
+    __macro_bsearch_branchless_upper(style, value_type, cmp, key, base, n);           \
+    if(b > (value_type *)base && macro_equal(style, value_type, cmp, key, b - 1))     \
+        return b - 1;                                                                 \
+    return NULL;
+
+#define __macro_bsearch_kv_branchless_last_code(style, key_type, value_type, cmp, key, base, n)    \
+    __macro_bsearch_kv_branchless_upper(style, key_type, value_type, cmp, key, base, n);           \
+    if(b > (value_type *)base && macro_equal_kv(style, key_type, value_type, cmp, key, b - 1))     \
+        return b - 1;                                                                              \
+    return NULL;
+
+#define __macro_bsearch_branchless_floor_code(style, value_type, cmp, key, base, n)    \
+    __macro_bsearch_branchless_lower(style, value_type, cmp, key, base, n);            \
+    if(b < end && macro_equal(style, value_type, cmp, key, b))                         \
+        return b;                                                                      \
+    return b > (value_type *)base ? b - 1 : NULL;
+
+#define __macro_bsearch_kv_branchless_floor_code(style, key_type, value_type, cmp, key, base, n)    \
+    __macro_bsearch_kv_branchless_lower(style, key_type, value_type, cmp, key, base, n);            \
+    if(b < end && macro_equal_kv(style, key_type, value_type, cmp, key, b))                         \
+        return b;                                                                                   \
+    return b > (value_type *)base ? b - 1 : NULL;
+
+#define __macro_bsearch_branchless_ceiling_code(style, value_type, cmp, key, base, n)    \
+    __macro_bsearch_branchless_upper(style, value_type, cmp, key, base, n);              \
+    return b > (value_type *)base ? b - 1 : NULL;
+
+#define __macro_bsearch_kv_branchless_ceiling_code(style, key_type, value_type, cmp, key, base, n)    \
+    __macro_bsearch_kv_branchless_upper(style, key_type, value_type, cmp, key, base, n);              \
+    return b > (value_type *)base ? b - 1 : NULL;
+
+#define __macro_bsearch_branchless_lower_bound_code(style, value_type, cmp, key, base, n)    \
+    __macro_bsearch_branchless_lower(style, value_type, cmp, key, base, n);                  \
+    return b < end ? b : NULL;
+
+#define __macro_bsearch_kv_branchless_lower_bound_code(style, key_type, value_type, cmp, key, base, n)    \
+    __macro_bsearch_kv_branchless_lower(style, key_type, value_type, cmp, key, base, n);                  \
+    return b < end ? b : NULL;
+
+#define __macro_bsearch_branchless_upper_bound_code(style, value_type, cmp, key, base, n)    \
+    __macro_bsearch_branchless_upper(style, value_type, cmp, key, base, n);                  \
+    return b;
+
+#define __macro_bsearch_kv_branchless_upper_bound_code(style, key_type, value_type, cmp, key, base, n)    \
+    __macro_bsearch_kv_branchless_upper(style, key_type, value_type, cmp, key, base, n);                  \
+    return b;
@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_bsearch_hint_code_H
+#define _macro_bsearch_hint_code_H
+
+#include <stddef.h>
+
+#include "the-macro-library/macro_cmp.h"
+
+/*
+    Finger (exponential) search.  The search starts at hint and probes hint + 1, + 2,
+    + 4, ... (or - 1, - 2, - 4, ...) until the key is bracketed, and then binary
+    searches the bracket.  Finding an element which is d positions from hint costs
+    about 2 log2(d) comparisons, regardless of n.
+
+    go_right is an expression of mid which is true for the elements before the answer
+    (mid < key for lower_bound, mid <= key for upper_bound).  l is set to the position
+    of the answer (n if every element goes right).  empty is returned when n is 0
+    (NULL for lower_bound and base for upper_bound, as in macro_bsearch.h).
+*/
+#define __macro_bsearch_hint_code(value_type, base, n, hint, go_right, empty)     \
+    value_type *a = (value_type *)base, *mid;                                     \
+    size_t l, h, step = 1, probe;                                                 \
+    if(!n) return empty;                                                          \
+    if(hint >= n)                                                                 \
+        hint = n - 1;                                                             \
+    mid = a + hint;                                                               \
+    if(go_right) {                                                                \
+        l = hint + 1;                                                             \
+        while(1) {                                                                \
+            probe = l + step - 1;                                                 \
+            if(probe >= n) {                                                      \
+                h = n;                                                            \
+                break;                                                            \
+            }                                                                     \
+            mid = a + probe;                                                      \
+            if(!(go_right)) {                                                     \
+                h = probe;                                                        \
+                break;                                                            \
+            }                                                                     \
+            l = probe + 1;                                                        \
+            step <<= 1;                                                           \
+        }                                                                         \
+    } else {                                                                      \
+        h = hint;                                                                 \
+        while(1) {                                                                \
+            if(h < step) {                                                        \
+                l = 0;                                                            \
+                break;                                                            \
+            }                                                                     \
+            probe = h - step;                                                     \
+            mid = a + probe;                                                      \
+            if(go_right) {                                                        \
+                l = probe + 1;                                                    \
+                break;                                                            \
+            }                                                                     \
+            h = probe;                                                            \
+            step <<= 1;                                                           \
+        }                                                                         \
+    }                                                                             \
+    while(l < h) {                                                                \
+        probe = l + ((h - l) >> 1);                                               \
+        mid = a + probe;                                                          \
+        if(go_right)                                                              \
+            l = probe + 1;                                                        \
+        else                                                                      \
+            h = probe;                                                            \
+    }
+
+#define __macro_bsearch_hint_lower_bound_code(style, value_type, cmp, key, base, n, hint)    \
+    __macro_bsearch_hint_code(value_type, base, n, hint,                                     \
+                              macro_greater(style, value_type, cmp, key, mid), NULL);        \
+    return l < n ? a + l : NULL;
+
+#define __macro_bsearch_hint_upper_bound_code(style, value_type, cmp, key, base, n, hint)    \
+    __macro_bsearch_hint_code(value_type, base, n, hint,                                     \
+                              !macro_less(style, value_type, cmp, key, mid), a);             \
+    return a + l;
+
+#define __macro_bsearch_hint_kv_lower_bound_code(style, key_type, value_type, cmp, key, base, n, hint)    \
+    __macro_bsearch_hint_code(value_type, base, n, hint,                                                  \
+                              macro_greater_kv(style, key_type, value_type, cmp, key, mid), NULL);        \
+    return l < n ? a + l : NULL;
+
+#define __macro_bsearch_hint_kv_upper_bound_code(style, key_type, value_type, cmp, key, base, n, hint)    \
+    __macro_bsearch_hint_code(value_type, base, n, hint,                                                  \
+                              !macro_less_kv(style, key_type, value_type, cmp, key, mid), a);             \
+    return a + l;
+
+/* the cursor versions search from the cursor's last position and then move it to
+   the answer */
+#define __macro_bsearch_cursor_code(value_type, cursor, go_right, empty)          \
+    size_t n = cursor->n, hint = cursor->pos;                                     \
+    __macro_bsearch_hint_code(value_type, cursor->base, n, hint, go_right, empty); \
+    cursor->pos = l
+
+#define __macro_bsearch_cursor_lower_bound_code(style, value_type, cmp, key, cursor)    \
+    __macro_bsearch_cursor_code(value_type, cursor,                                     \
+                                macro_greater(style, value_type, cmp, key, mid), NULL); \
+    return l < n ? a + l : NULL;
+
+#define __macro_bsearch_cursor_upper_bound_code(style, value_type, cmp, key, cursor)    \
+    __macro_bsearch_cursor_code(value_type, cursor,                                     \
+                                !macro_less(style, value_type, cmp, key, mid), a);      \
+    return a + l;
+
+#define __macro_bsearch_cursor_kv_lower_bound_code(style, key_type, value_type, cmp, key, cursor)    \
+    __macro_bsearch_cursor_code(value_type, cursor,                                                  \
+                                macro_greater_kv(style, key_type, value_type, cmp, key, mid), NULL); \
+    return l < n ? a + l : NULL;
+
+#define __macro_bsearch_cursor_kv_upper_bound_code(style, key_type, value_type, cmp, key, cursor)    \
+    __macro_bsearch_cursor_code(value_type, cursor,                                                  \
+                                !macro_less_kv(style, key_type, value_type, cmp, key, mid), a);      \
+    return a + l;
+
+#endif /* _macro_bsearch_hint_code_H */
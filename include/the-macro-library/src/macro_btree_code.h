@@ -0,0 +1,367 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_btree_code_H
+#define _macro_btree_code_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "the-macro-library/macro_cmp.h"
+
+/*
+    A B-tree of minimum degree T, where every node holds between T-1 and 2T-1 elements
+    (the root may hold fewer) and every internal node with k elements has k+1 children.
+    All of the leaves are at the same depth (the tree's height), so the nodes don't
+    need a leaf flag and leaves are allocated without the children array.
+
+    Insert splits full nodes on the way down and erase makes sure each node it steps
+    into has at least T elements, so both are a single pass from the root.
+*/
+
+#ifndef MACRO_BTREE_NODE_SIZE
+#define MACRO_BTREE_NODE_SIZE 256
+#endif
+
+/* the number of elements per node (odd, so a full node splits evenly) */
+#define __macro_btree_cap(type)                                                   \
+    (sizeof(type) * 4 + sizeof(size_t) > MACRO_BTREE_NODE_SIZE ? 3 :              \
+     ((MACRO_BTREE_NODE_SIZE - sizeof(size_t)) / sizeof(type) - 1) | 1)
+
+#define __macro_btree_min(type) ((__macro_btree_cap(type) + 1) >> 1)
+
+#define __macro_btree_node(type)                       \
+    struct {                                           \
+        size_t num;                                    \
+        type keys[__macro_btree_cap(type)];            \
+        void *children[__macro_btree_cap(type) + 1];   \
+    }
+
+/* leaves are allocated as the first two fields */
+#define __macro_btree_leaf(type)                       \
+    struct {                                           \
+        size_t num;                                    \
+        type keys[__macro_btree_cap(type)];            \
+    }
+
+#define __macro_btree_node_vars(type)                                                    \
+    typedef __macro_btree_node(type) __macro_btree_node_t;                               \
+    typedef __macro_btree_leaf(type) __macro_btree_leaf_t;                               \
+    const size_t __macro_btree_leaf_size = sizeof(__macro_btree_leaf_t)
+
+/* the comparisons which send a search to the right of e.  lower stops at the first
+   element >= key and upper at the first element > key */
+#define __macro_btree_right_lower(style, key_type, type, cmp, key, e) macro_less(style, type, cmp, e, key)
+#define __macro_btree_right_upper(style, key_type, type, cmp, key, e) !macro_less(style, type, cmp, key, e)
+#define __macro_btree_equal(style, key_type, type, cmp, key, e) macro_equal(style, type, cmp, key, e)
+
+#define __macro_btree_right_kv_lower(style, key_type, type, cmp, key, e)    \
+    macro_greater_kv(style, key_type, type, cmp, key, e)
+#define __macro_btree_right_kv_upper(style, key_type, type, cmp, key, e)    \
+    !macro_less_kv(style, key_type, type, cmp, key, e)
+#define __macro_btree_equal_kv(style, key_type, type, cmp, key, e)    \
+    macro_equal_kv(style, key_type, type, cmp, key, e)
+
+/* sets i to the number of elements in node which go_right */
+#define __macro_btree_search(right, style, key_type, type, cmp, key, node, i, len, half)    \
+    i = 0;                                                                                 \
+    len = node->num;                                                                       \
+    while(len > 0) {                                                                       \
+        half = len >> 1;                                                                   \
+        if(right(style, key_type, type, cmp, key, node->keys + i + half)) {                \
+            i += half + 1;                                                                 \
+            len -= half + 1;                                                               \
+        } else                                                                             \
+            len = half;                                                                    \
+    }
+
+/* the find styles, which follow the map's (each node is searched for the first element
+   >= key, or > key, and the search continues into the child before it) */
+#define __macro_btree_right_find __macro_btree_right_lower
+#define __macro_btree_right_first __macro_btree_right_lower
+#define __macro_btree_right_floor __macro_btree_right_lower
+#define __macro_btree_right_lower_bound __macro_btree_right_lower
+#define __macro_btree_right_last __macro_btree_right_upper
+#define __macro_btree_right_ceiling __macro_btree_right_upper
+#define __macro_btree_right_upper_bound __macro_btree_right_upper
+#define __macro_btree_right_kv_find __macro_btree_right_kv_lower
+#define __macro_btree_right_kv_first __macro_btree_right_kv_lower
+#define __macro_btree_right_kv_floor __macro_btree_right_kv_lower
+#define __macro_btree_right_kv_lower_bound __macro_btree_right_kv_lower
+#define __macro_btree_right_kv_last __macro_btree_right_kv_upper
+#define __macro_btree_right_kv_ceiling __macro_btree_right_kv_upper
+#define __macro_btree_right_kv_upper_bound __macro_btree_right_kv_upper
+
+#define __macro_btree_eq(kv, style, key_type, type, cmp, key, e)    \
+    __macro_btree_equal ## kv(style, key_type, type, cmp, key, e)
+
+#define __macro_btree_find_head(type)
+#define __macro_btree_find_inner(kv, style, key_type, type, cmp, key, node, i)          \
+    if(i < node->num && __macro_btree_eq(kv, style, key_type, type, cmp, key, node->keys + i)) \
+        return node->keys + i;
+#define __macro_btree_find_tail(kv, style, key_type, type, cmp, key) return NULL;
+
+#define __macro_btree_first_head(type) type *res = NULL;
+#define __macro_btree_first_inner(kv, style, key_type, type, cmp, key, node, i)    \
+    if(i < node->num)                                                            \
+        res = node->keys + i;
+#define __macro_btree_first_tail(kv, style, key_type, type, cmp, key)                        \
+    return res && __macro_btree_eq(kv, style, key_type, type, cmp, key, res) ? res : NULL;
+
+#define __macro_btree_lower_bound_head(type) __macro_btree_first_head(type)
+#define __macro_btree_lower_bound_inner(kv, style, key_type, type, cmp, key, node, i)    \
+    __macro_btree_first_inner(kv, style, key_type, type, cmp, key, node, i)
+#define __macro_btree_lower_bound_tail(kv, style, key_type, type, cmp, key) return res;
+
+#define __macro_btree_upper_bound_head(type) __macro_btree_first_head(type)
+#define __macro_btree_upper_bound_inner(kv, style, key_type, type, cmp, key, node, i)    \
+    __macro_btree_first_inner(kv, style, key_type, type, cmp, key, node, i)
+#define __macro_btree_upper_bound_tail(kv, style, key_type, type, cmp, key) return res;
+
+#define __macro_btree_last_head(type) __macro_btree_first_head(type)
+#define __macro_btree_last_inner(kv, style, key_type, type, cmp, key, node, i)    \
+    if(i)                                                                       \
+        res = node->keys + i - 1;
+#define __macro_btree_last_tail(kv, style, key_type, type, cmp, key)    \
+    __macro_btree_first_tail(kv, style, key_type, type, cmp, key)
+
+/* the first equal element, else the last element < key */
+#define __macro_btree_floor_head(type) type *res = NULL, *other = NULL;
+#define __macro_btree_floor_inner(kv, style, key_type, type, cmp, key, node, i)    \
+    if(i < node->num)                                                            \
+        res = node->keys + i;                                                    \
+    if(i)                                                                        \
+        other = node->keys + i - 1;
+#define __macro_btree_floor_tail(kv, style, key_type, type, cmp, key)                         \
+    return res && __macro_btree_eq(kv, style, key_type, type, cmp, key, res) ? res : other;
+
+/* the last equal element, else the first element > key */
+#define __macro_btree_ceiling_head(type) __macro_btree_floor_head(type)
+#define __macro_btree_ceiling_inner(kv, style, key_type, type, cmp, key, node, i)    \
+    __macro_btree_floor_inner(kv, style, key_type, type, cmp, key, node, i)
+#define __macro_btree_ceiling_tail(kv, style, key_type, type, cmp, key)                           \
+    return other && __macro_btree_eq(kv, style, key_type, type, cmp, key, other) ? other : res;
+
+#define __macro_btree_find_code(kv, find_style, style, key_type, type, cmp, t, key)              \
+    __macro_btree_node_vars(type);                                                              \
+    __macro_btree_node_t *node = (__macro_btree_node_t *)t->root;                               \
+    size_t h = t->height, i, len, half;                                                         \
+    __macro_btree_ ## find_style ## _head(type)                                                 \
+    (void)__macro_btree_leaf_size;                                                              \
+    if(!node)                                                                                   \
+        return NULL;                                                                            \
+    while(true) {                                                                               \
+        __macro_btree_search(__macro_btree_right ## kv ## _ ## find_style, style, key_type,      \
+                             type, cmp, key, node, i, len, half);                                \
+        __macro_btree_ ## find_style ## _inner(kv, style, key_type, type, cmp, key, node, i)    \
+        if(!h)                                                                                  \
+            break;                                                                              \
+        node = (__macro_btree_node_t *)node->children[i];                                       \
+        h--;                                                                                    \
+    }                                                                                           \
+    __macro_btree_ ## find_style ## _tail(kv, style, key_type, type, cmp, key)
+
+/* move the upper half of the full child i of node into a new sibling and the middle
+   element up into node.  s is NULL (and nothing changes) if the sibling can't be
+   allocated */
+#define __macro_btree_split(type, node, i, child_is_leaf, c, s, min_keys)                \
+    c = (__macro_btree_node_t *)node->children[i];                                       \
+    s = (__macro_btree_node_t *)malloc(child_is_leaf ? __macro_btree_leaf_size           \
+                                                     : sizeof(__macro_btree_node_t));    \
+    if(s) {                                                                              \
+        s->num = min_keys - 1;                                                           \
+        memcpy(s->keys, c->keys + min_keys, (min_keys - 1) * sizeof(type));              \
+        if(!(child_is_leaf))                                                             \
+            memcpy(s->children, c->children + min_keys, min_keys * sizeof(void *));      \
+        c->num = min_keys - 1;                                                           \
+        memmove(node->keys + i + 1, node->keys + i, (node->num - i) * sizeof(type));     \
+        memmove(node->children + i + 2, node->children + i + 1,                          \
+                (node->num - i) * sizeof(void *));                                       \
+        node->keys[i] = c->keys[min_keys - 1];                                           \
+        node->children[i + 1] = s;                                                       \
+        node->num++;                                                                     \
+    }
+
+#define __macro_btree_insert_code(style, type, cmp, t, item)                                     \
+    __macro_btree_node_vars(type);                                                               \
+    const size_t min_keys = __macro_btree_min(type);                                             \
+    __macro_btree_node_t *node = (__macro_btree_node_t *)t->root, *c, *s;                        \
+    size_t h, i, len, half;                                                                      \
+    if(!node) {                                                                                  \
+        __macro_btree_leaf_t *leaf = (__macro_btree_leaf_t *)malloc(__macro_btree_leaf_size);    \
+        if(!leaf)                                                                                \
+            return false;                                                                        \
+        leaf->num = 1;                                                                           \
+        leaf->keys[0] = *item;                                                                   \
+        t->root = leaf;                                                                          \
+        t->height = 0;                                                                           \
+        t->size = 1;                                                                             \
+        t->children_offset = offsetof(__macro_btree_node_t, children);                           \
+        return true;                                                                             \
+    }                                                                                            \
+    if(node->num == __macro_btree_cap(type)) {                                                   \
+        node = (__macro_btree_node_t *)malloc(sizeof(__macro_btree_node_t));                     \
+        if(!node)                                                                                \
+            return false;                                                                        \
+        node->num = 0;                                                                           \
+        node->children[0] = t->root;                                                             \
+        __macro_btree_split(type, node, 0, t->height == 0, c, s, min_keys);                      \
+        if(!s) {                                                                                 \
+            free(node);                                                                          \
+            return false;                                                                        \
+        }                                                                                        \
+        t->root = node;                                                                          \
+        t->height++;                                                                             \
+    }                                                                                            \
+    h = t->height;                                                                               \
+    while(true) {                                                                                \
+        __macro_btree_search(__macro_btree_right_lower, style, type, type, cmp, item, node,      \
+                             i, len, half);                                                      \
+        if(i < node->num && !macro_less(style, type, cmp, item, node->keys + i))                 \
+            return false;                                                                        \
+        if(!h) {                                                                                 \
+            memmove(node->keys + i + 1, node->keys + i, (node->num - i) * sizeof(type));         \
+            node->keys[i] = *item;                                                               \
+            node->num++;                                                                         \
+            t->size++;                                                                           \
+            return true;                                                                         \
+        }                                                                                        \
+        c = (__macro_btree_node_t *)node->children[i];                                           \
+        if(c->num == __macro_btree_cap(type)) {                                                  \
+            __macro_btree_split(type, node, i, h == 1, c, s, min_keys);                          \
+            if(!s)                                                                               \
+                return false;                                                                    \
+            if(macro_less(style, type, cmp, node->keys + i, item))                               \
+                i++;                                                                             \
+            else if(!macro_less(style, type, cmp, item, node->keys + i))                         \
+                return false;                                                                    \
+        }                                                                                        \
+        node = (__macro_btree_node_t *)node->children[i];                                        \
+        h--;                                                                                     \
+    }
+
+/* append child i+1 of node and the element between them to child i, h is the height
+   of the children */
+#define __macro_btree_merge(type, node, i, h, c, s)                                   \
+    c = (__macro_btree_node_t *)node->children[i];                                   \
+    s = (__macro_btree_node_t *)node->children[i + 1];                               \
+    c->keys[c->num] = node->keys[i];                                                 \
+    memcpy(c->keys + c->num + 1, s->keys, s->num * sizeof(type));                    \
+    if(h)                                                                            \
+        memcpy(c->children + c->num + 1, s->children, (s->num + 1) * sizeof(void *)); \
+    c->num += s->num + 1;                                                            \
+    free(s);                                                                         \
+    memmove(node->keys + i, node->keys + i + 1, (node->num - i - 1) * sizeof(type)); \
+    memmove(node->children + i + 1, node->children + i + 2,                          \
+            (node->num - i - 1) * sizeof(void *));                                   \
+    node->num--;                                                                     \
+    if(!node->num) {                                                                 \
+        /* only the root can run out of elements */                                  \
+        free(node);                                                                  \
+        t->root = c;                                                                 \
+        t->height--;                                                                 \
+    }
+
+/* make sure that child i of node has at least T elements by borrowing from a sibling
+   or by merging with one.  c is set to the child to step into */
+#define __macro_btree_fill(type, node, i, h, c, s, min_keys)                                \
+    c = (__macro_btree_node_t *)node->children[i];                                          \
+    if(c->num < min_keys) {                                                                 \
+        s = i ? (__macro_btree_node_t *)node->children[i - 1] : NULL;                       \
+        if(s && s->num >= min_keys) {                                                       \
+            memmove(c->keys + 1, c->keys, c->num * sizeof(type));                           \
+            c->keys[0] = node->keys[i - 1];                                                 \
+            node->keys[i - 1] = s->keys[s->num - 1];                                        \
+            if(h) {                                                                         \
+                memmove(c->children + 1, c->children, (c->num + 1) * sizeof(void *));       \
+                c->children[0] = s->children[s->num];                                       \
+            }                                                                               \
+            s->num--;                                                                       \
+            c->num++;                                                                       \
+        } else if(i < node->num &&                                                          \
+                  ((__macro_btree_node_t *)node->children[i + 1])->num >= min_keys) {       \
+            s = (__macro_btree_node_t *)node->children[i + 1];                              \
+            c->keys[c->num] = node->keys[i];                                                \
+            node->keys[i] = s->keys[0];                                                     \
+            memmove(s->keys, s->keys + 1, (s->num - 1) * sizeof(type));                     \
+            if(h) {                                                                         \
+                c->children[c->num + 1] = s->children[0];                                   \
+                memmove(s->children, s->children + 1, s->num * sizeof(void *));             \
+            }                                                                               \
+            s->num--;                                                                       \
+            c->num++;                                                                       \
+        } else {                                                                            \
+            if(i == node->num)                                                              \
+                i--;                                                                        \
+            __macro_btree_merge(type, node, i, h, c, s);                                    \
+        }                                                                                   \
+    }
+
+/* mode is 0 while searching for the key, 1 while searching for the largest element of
+   a subtree, and 2 for the smallest.  hole is the internal element which is replaced by
+   the largest (or smallest) element once that is removed from its leaf */
+#define __macro_btree_erase_code(kv, style, key_type, type, cmp, t, key)                         \
+    __macro_btree_node_vars(type);                                                               \
+    const size_t min_keys = __macro_btree_min(type);                                             \
+    __macro_btree_node_t *node = (__macro_btree_node_t *)t->root, *c, *s;                        \
+    type *hole = NULL;                                                                           \
+    size_t h = t->height, i, len, half;                                                          \
+    int mode = 0;                                                                                \
+    (void)__macro_btree_leaf_size;                                                               \
+    if(!node)                                                                                    \
+        return false;                                                                            \
+    while(true) {                                                                                \
+        if(mode == 0) {                                                                          \
+            __macro_btree_search(__macro_btree_right ## kv ## _lower, style, key_type, type,     \
+                                 cmp, key, node, i, len, half);                                  \
+            if(i < node->num && __macro_btree_equal ## kv(style, key_type, type, cmp, key,       \
+                                                          node->keys + i)) {                     \
+                if(!h) {                                                                         \
+                    memmove(node->keys + i, node->keys + i + 1,                                  \
+                            (node->num - i - 1) * sizeof(type));                                 \
+                    node->num--;                                                                 \
+                    break;                                                                       \
+                }                                                                                \
+                if(((__macro_btree_node_t *)node->children[i])->num >= min_keys) {               \
+                    hole = node->keys + i;                                                       \
+                    mode = 1;                                                                    \
+                } else if(((__macro_btree_node_t *)node->children[i + 1])->num >= min_keys) {    \
+                    hole = node->keys + i;                                                       \
+                    mode = 2;                                                                    \
+                    i++;                                                                         \
+                } else {                                                                         \
+                    /* the key moves down into the merged child */                               \
+                    __macro_btree_merge(type, node, i, h - 1, c, s);                             \
+                    node = c;                                                                    \
+                    h--;                                                                         \
+                    continue;                                                                    \
+                }                                                                                \
+                node = (__macro_btree_node_t *)node->children[i];                                \
+                h--;                                                                             \
+                continue;                                                                        \
+            }                                                                                    \
+            if(!h)                                                                               \
+                return false;                                                                    \
+        } else if(!h) {                                                                          \
+            if(mode == 1)                                                                        \
+                *hole = node->keys[node->num - 1];                                               \
+            else {                                                                               \
+                *hole = node->keys[0];                                                           \
+                memmove(node->keys, node->keys + 1, (node->num - 1) * sizeof(type));             \
+            }                                                                                    \
+            node->num--;                                                                         \
+            break;                                                                               \
+        } else                                                                                   \
+            i = mode == 1 ? node->num : 0;                                                       \
+        __macro_btree_fill(type, node, i, h - 1, c, s, min_keys);                                \
+        node = c;                                                                                \
+        h--;                                                                                     \
+    }                                                                                            \
+    t->size--;                                                                                   \
+    if(!t->size) {                                                                               \
+        free(t->root);                                                                           \
+        t->root = NULL;                                                                          \
+    }                                                                                            \
+    return true;
+
+#endif /* _macro_btree_code_H */
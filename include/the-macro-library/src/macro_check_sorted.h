@@ -4,6 +4,7 @@
 #define _macro_check_sorted_H
 
 #include "the-macro-library/macro_cmp.h"
+#include "the-macro-library/src/macro_sort_config.h"
 
 /*
     The basic idea with this is to quickly exit if a set is not sorted to one 
@@ -48,7 +49,7 @@
         if(macro_less(style, type, cmp, r_mid, r_hi)) {                       \
             goto find_mid;                                                    \
         }                                                                     \
-        if(n < 32) { \
+        if(n < MACRO_SORT_CHECK_FEW) { \
             delta = (n >> 2);                                                  \
             xp = r_lo;                                                            \
             if(macro_less(style, type, cmp, xp, xp+delta)) goto find_mid;         \
@@ -58,7 +59,7 @@
             yp -= delta; \
             if(macro_less(style, type, cmp, xp, xp+delta)) goto find_mid;         \
             if(macro_less(style, type, cmp, yp-delta, yp)) goto find_mid;         \
-        } else if(n < 256) { \
+        } else if(n < MACRO_SORT_CHECK_SOME) { \
             delta = (n >> 3);                                                  \
             xp = r_lo;                                                            \
             if(macro_less(style, type, cmp, xp, xp+delta)) goto find_mid;         \
@@ -108,7 +109,7 @@
         if(macro_less(style, type, cmp, r_mid, r_lo)) {                       \
             goto find_mid;                                                    \
         }                                                                     \
-        if(n < 32) { \
+        if(n < MACRO_SORT_CHECK_FEW) { \
             delta = n >> 2;                                                 \
             xp = r_lo;                                                            \
             if(macro_less(style, type, cmp, xp+delta, xp)) goto find_mid;         \
@@ -118,7 +119,7 @@
             yp -= delta; \
             if(macro_less(style, type, cmp, xp+delta, xp)) goto find_mid;         \
             if(macro_less(style, type, cmp, yp, yp-delta)) goto find_mid;         \
-        } else if(n < 256) { \
+        } else if(n < MACRO_SORT_CHECK_SOME) { \
             delta = n >> 3;                                                 \
             xp = r_lo;                                                            \
             if(macro_less(style, type, cmp, xp+delta, xp)) goto find_mid;         \
@@ -0,0 +1,111 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_eytzinger_code_H
+#define _macro_eytzinger_code_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "the-macro-library/macro_cmp.h"
+#include "the-macro-library/src/macro_prefetch.h"
+
+/*
+    The Eytzinger layout stores a sorted array as an implicit binary tree in breadth
+    first order.  Node k (1 based) is stored at base[k] (base[0] is unused) and its
+    children are nodes 2k and 2k+1.  The search always walks down to a leaf (k = 2k + went_right), so there
+    are no data dependent branches, and the 2^d descendants of k which are d levels
+    down are adjacent in memory (starting at base[k << d]) so one cache line can be
+    prefetched d levels ahead.  With base on a 64 byte boundary and a power of two
+    element size, that group starts on a cache line boundary.
+
+    Once k falls off the tree, the last node where the search went left is found by
+    removing the trailing right turns (one bits) and the final left turn.
+*/
+
+/* the number of nodes d levels below k which share a 64 byte cache line (a power of
+   two, or the nodes wouldn't all be descendants of k) */
+#define __macro_eytzinger_pow2_floor(x)                                        \
+    ((x) >= 64 ? 64 : (x) >= 32 ? 32 : (x) >= 16 ? 16 : (x) >= 8 ? 8 :        \
+     (x) >= 4 ? 4 : (x) >= 2 ? 2 : 1)
+
+#define __macro_eytzinger_ahead(value_type)    \
+    (sizeof(value_type) >= 32 ? 4 : __macro_eytzinger_pow2_floor(64 / sizeof(value_type)))
+
+/* near the bottom of the tree the prefetched node is past the end of the array, so
+   the address is computed as an integer rather than with pointer arithmetic */
+#define __macro_eytzinger_prefetch(value_type, b, k)                                     \
+    __mcro_prefetch((const void *)((uintptr_t)(b) +                                      \
+                    (k) * __macro_eytzinger_ahead(value_type) * sizeof(value_type)))
+
+#define __macro_eytzinger_descend(value_type, go_right)                  \
+    const value_type *b = (const value_type *)base;                       \
+    size_t k = 1;                                                         \
+    if(!n) return NULL;                                                   \
+    while(k <= n) {                                                       \
+        __macro_eytzinger_prefetch(value_type, b, k);                     \
+        k = (k << 1) + (go_right);                                        \
+    }                                                                     \
+    while(k & 1)                                                          \
+        k >>= 1;                                                          \
+    k >>= 1
+
+/* first element >= key */
+#define __macro_eytzinger_lower_bound_code(style, value_type, cmp, key, base, n)    \
+    __macro_eytzinger_descend(value_type,                                           \
+                              macro_less(style, value_type, cmp, b + k, key));  \
+    return k ? (value_type *)(b + k) : NULL;
+
+/* first element > key */
+#define __macro_eytzinger_upper_bound_code(style, value_type, cmp, key, base, n)    \
+    __macro_eytzinger_descend(value_type,                                           \
+                              !macro_less(style, value_type, cmp, key, b + k)); \
+    return k ? (value_type *)(b + k) : NULL;
+
+/* an element equal to key (the first one in sorted order) */
+#define __macro_eytzinger_core_code(style, value_type, cmp, key, base, n)           \
+    __macro_eytzinger_descend(value_type,                                           \
+                              macro_less(style, value_type, cmp, b + k, key));  \
+    if(k && !macro_less(style, value_type, cmp, key, b + k))                  \
+        return (value_type *)(b + k);                                         \
+    return NULL;
+
+#define __macro_eytzinger_kv_lower_bound_code(style, key_type, value_type, cmp, key, base, n)    \
+    __macro_eytzinger_descend(value_type,                                                        \
+        macro_cmp_kv(style, key_type, value_type, cmp, key, b + k) > 0);                   \
+    return k ? (value_type *)(b + k) : NULL;
+
+#define __macro_eytzinger_kv_upper_bound_code(style, key_type, value_type, cmp, key, base, n)    \
+    __macro_eytzinger_descend(value_type,                                                        \
+        macro_cmp_kv(style, key_type, value_type, cmp, key, b + k) >= 0);                  \
+    return k ? (value_type *)(b + k) : NULL;
+
+#define __macro_eytzinger_kv_core_code(style, key_type, value_type, cmp, key, base, n)           \
+    __macro_eytzinger_descend(value_type,                                                        \
+        macro_cmp_kv(style, key_type, value_type, cmp, key, b + k) > 0);                   \
+    if(k && macro_cmp_kv(style, key_type, value_type, cmp, key, b + k) == 0)               \
+        return (value_type *)(b + k);                                                      \
+    return NULL;
+
+/*
+    Copies the sorted array src into dest in Eytzinger order by walking the implicit
+    tree in order (without recursion).
+*/
+#define __macro_eytzinger_build_code(dest, src, n)    \
+    size_t i, k = 1;                                  \
+    if(!n) return;                                    \
+    while((k << 1) <= n)                              \
+        k <<= 1;                                      \
+    for(i = 0; i < n; i++) {                          \
+        dest[k] = src[i];                             \
+        if((k << 1) + 1 <= n) {                       \
+            k = (k << 1) + 1;                         \
+            while((k << 1) <= n)                      \
+                k <<= 1;                              \
+        } else {                                      \
+            while(k & 1)                              \
+                k >>= 1;                              \
+            k >>= 1;                                  \
+        }                                             \
+    }
+
+#endif /* _macro_eytzinger_code_H */
@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_for_each_H
+#define _macro_for_each_H
+
+/*
+    __macro_for_each(action, ctx, ...) expands action(ctx, x) for every x in the
+    variable argument list (up to 16 items).  This is used by the generators which
+    accept a list of fields such as macro_key and macro_cmp_fields.  The items are
+    typically parenthesized tuples like (field, asc) and __macro_apply can be used
+    to unpack them into a call.
+
+    __macro_apply(action, ctx, (a, b, c)) => action(ctx, a, b, c)
+
+    Because bin/convert-macros-to-code doesn't understand variable arguments, these
+    are meant for the generators and not for code which needs to be converted.
+*/
+
+#define __macro_cat(a, b) __macro_cat_(a, b)
+#define __macro_cat_(a, b) a ## b
+
+#define __macro_strip(...) __VA_ARGS__
+#define __macro_apply(action, ctx, t) __macro_apply_(action, ctx, __macro_strip t)
+#define __macro_apply_(action, ...) action(__VA_ARGS__)
+
+#define __macro_nargs(...)                                           \
+    __macro_nargs_(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8,    \
+                   7, 6, 5, 4, 3, 2, 1, 0)
+#define __macro_nargs_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11,    \
+                       _12, _13, _14, _15, _16, N, ...) N
+
+#define __macro_for_each(action, ctx, ...)                                      \
+    __macro_cat(__macro_for_each_, __macro_nargs(__VA_ARGS__))(action, ctx, __VA_ARGS__)
+
+#define __macro_for_each_1(f, c, x) f(c, x)
+#define __macro_for_each_2(f, c, x, ...) f(c, x) __macro_for_each_1(f, c, __VA_ARGS__)
+#define __macro_for_each_3(f, c, x, ...) f(c, x) __macro_for_each_2(f, c, __VA_ARGS__)
+#define __macro_for_each_4(f, c, x, ...) f(c, x) __macro_for_each_3(f, c, __VA_ARGS__)
+#define __macro_for_each_5(f, c, x, ...) f(c, x) __macro_for_each_4(f, c, __VA_ARGS__)
+#define __macro_for_each_6(f, c, x, ...) f(c, x) __macro_for_each_5(f, c, __VA_ARGS__)
+#define __macro_for_each_7(f, c, x, ...) f(c, x) __macro_for_each_6(f, c, __VA_ARGS__)
+#define __macro_for_each_8(f, c, x, ...) f(c, x) __macro_for_each_7(f, c, __VA_ARGS__)
+#define __macro_for_each_9(f, c, x, ...) f(c, x) __macro_for_each_8(f, c, __VA_ARGS__)
+#define __macro_for_each_10(f, c, x, ...) f(c, x) __macro_for_each_9(f, c, __VA_ARGS__)
+#define __macro_for_each_11(f, c, x, ...) f(c, x) __macro_for_each_10(f, c, __VA_ARGS__)
+#define __macro_for_each_12(f, c, x, ...) f(c, x) __macro_for_each_11(f, c, __VA_ARGS__)
+#define __macro_for_each_13(f, c, x, ...) f(c, x) __macro_for_each_12(f, c, __VA_ARGS__)
+#define __macro_for_each_14(f, c, x, ...) f(c, x) __macro_for_each_13(f, c, __VA_ARGS__)
+#define __macro_for_each_15(f, c, x, ...) f(c, x) __macro_for_each_14(f, c, __VA_ARGS__)
+#define __macro_for_each_16(f, c, x, ...) f(c, x) __macro_for_each_15(f, c, __VA_ARGS__)
+
+#endif /* _macro_for_each_H */
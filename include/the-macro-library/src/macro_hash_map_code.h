@@ -0,0 +1,180 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_hash_map_code_H
+#define _macro_hash_map_code_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "the-macro-library/macro_cmp.h"
+
+/*
+    An open addressing table with a control byte per slot, as in SwissTable.  A full
+    slot's control byte holds 7 bits of the element's hash, so a lookup checks the 8
+    control bytes of a group with a few integer operations and only compares the
+    elements whose 7 bits match (usually just the one it is looking for).
+
+    The capacity is a power of two (at least 16) and groups are 8 aligned slots.  The
+    probe visits groups in triangular steps, which reaches every group, and stops at
+    the first group with an empty slot.  An erased slot is marked deleted unless its
+    group already has an empty slot (no probe can have passed through such a group).
+    The table grows when it would be more than 7/8 full (counting deleted slots).
+*/
+
+#define __macro_hash_map_empty 0x80
+#define __macro_hash_map_deleted 0xFE
+#define __macro_hash_map_min_capacity 16
+
+#define __macro_hash_map_lsbs 0x0101010101010101ULL
+#define __macro_hash_map_msbs 0x8080808080808080ULL
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define __mcro_hash_map_le64(x) __builtin_bswap64(x)
+#else
+#define __mcro_hash_map_le64(x) (x)
+#endif
+
+/* spreads the user's hash so that both the low bits (the position) and the 7 bits in
+   the control byte are usable, even for an identity hash of small ints */
+static inline uint64_t _macro_hash_map_mix(uint64_t x) {
+    x *= 0x9E3779B97F4A7C15ULL;
+    return x ^ (x >> 32);
+}
+
+static inline uint64_t _macro_hash_map_group(const uint8_t *ctrl) {
+    uint64_t g;
+    memcpy(&g, ctrl, sizeof(g));
+    return __mcro_hash_map_le64(g);
+}
+
+/* the high bit of each byte in the result is set for a match (a byte above a real
+   match may also be set, so matches are always confirmed by a compare) */
+static inline uint64_t _macro_hash_map_match(uint64_t g, uint8_t h2) {
+    uint64_t x = g ^ (__macro_hash_map_lsbs * h2);
+    return (x - __macro_hash_map_lsbs) & ~x & __macro_hash_map_msbs;
+}
+
+static inline uint64_t _macro_hash_map_match_empty(uint64_t g) {
+    return g & ~(g << 6) & __macro_hash_map_msbs;
+}
+
+static inline uint64_t _macro_hash_map_match_free(uint64_t g) {
+    return g & ~(g << 7) & __macro_hash_map_msbs;
+}
+
+#define _macro_hash_map_first_match(m) ((size_t)__builtin_ctzll(m) >> 3)
+
+#define __macro_hash_map_equal(style, key_type, type, cmp, key, e) macro_equal(style, type, cmp, key, e)
+#define __macro_hash_map_equal_kv(style, key_type, type, cmp, key, e)    \
+    macro_equal_kv(style, key_type, type, cmp, key, e)
+#define __macro_hash_map_eq(kv, style, key_type, type, cmp, key, e)    \
+    __macro_hash_map_equal ## kv(style, key_type, type, cmp, key, e)
+
+/* the first slot which is empty or deleted in the probe sequence of hv */
+static inline size_t _macro_hash_map_find_free(const uint8_t *ctrl, size_t capacity, uint64_t hv) {
+    size_t mask = capacity - 1, pos = (size_t)(hv >> 7) & mask & ~(size_t)7, step = 0;
+    uint64_t m;
+    while (!(m = _macro_hash_map_match_free(_macro_hash_map_group(ctrl + pos)))) {
+        step += 8;
+        pos = (pos + step) & mask;
+    }
+    return pos + _macro_hash_map_first_match(m);
+}
+
+/* sets i to the slot of the element equal to key, or runs not_found (the variables are
+   assigned after they are declared so that not_found can be a goto in c++) */
+#define __macro_hash_map_probe_code(kv, style, key_type, value_type, hash, cmp, h, key, i, not_found) \
+    uint64_t hv, g, m;                                                                                  \
+    size_t mask, pos, step;                                                                             \
+    uint8_t h2;                                                                                         \
+    value_type *slots;                                                                                  \
+    if (!h->size)                                                                                       \
+        not_found;                                                                                      \
+    hv = _macro_hash_map_mix(hash(key));                                                                \
+    mask = h->capacity - 1;                                                                             \
+    pos = (size_t)(hv >> 7) & mask & ~(size_t)7;                                                        \
+    step = 0;                                                                                           \
+    h2 = (uint8_t)(hv & 0x7F);                                                                          \
+    slots = (value_type *)h->slots;                                                                     \
+    while (true) {                                                                                      \
+        g = _macro_hash_map_group(h->ctrl + pos);                                                       \
+        for (m = _macro_hash_map_match(g, h2); m; m &= m - 1) {                                         \
+            i = pos + _macro_hash_map_first_match(m);                                                   \
+            if (__macro_hash_map_eq(kv, style, key_type, value_type, cmp, key, slots + i))              \
+                goto found;                                                                             \
+        }                                                                                               \
+        if (_macro_hash_map_match_empty(g))                                                             \
+            not_found;                                                                                  \
+        step += 8;                                                                                      \
+        pos = (pos + step) & mask;                                                                      \
+    }                                                                                                   \
+    found:
+
+#define __macro_hash_map_find_code(kv, style, key_type, value_type, hash, cmp, h, key)      \
+    size_t i;                                                                               \
+    __macro_hash_map_probe_code(kv, style, key_type, value_type, hash, cmp, h, key, i,      \
+                                return NULL)                                                \
+    return slots + i;
+
+#define __macro_hash_map_erase_code(kv, style, key_type, value_type, hash, cmp, h, key)     \
+    size_t i;                                                                               \
+    __macro_hash_map_probe_code(kv, style, key_type, value_type, hash, cmp, h, key, i,      \
+                                return false)                                               \
+    (void)slots;                                                                            \
+    macro_hash_map_erase_at(h, i);                                                          \
+    return true;
+
+/* rehashes into a table of the given capacity (the elements are moved with memcpy) */
+#define __macro_hash_map_resize_code(type, hash, h, new_capacity)                          \
+    {                                                                                       \
+        size_t new_cap = new_capacity, j, k;                                                \
+        uint8_t *ctrl = (uint8_t *)malloc(new_cap + new_cap * sizeof(type));                \
+        if (!ctrl)                                                                          \
+            return false;                                                                   \
+        memset(ctrl, __macro_hash_map_empty, new_cap);                                      \
+        type *new_slots = (type *)(ctrl + new_cap), *old_slots = (type *)h->slots;          \
+        for (j = 0; j < h->capacity; j++) {                                                 \
+            if (h->ctrl[j] & 0x80)                                                          \
+                continue;                                                                   \
+            uint64_t ehv = _macro_hash_map_mix(hash(old_slots + j));                        \
+            k = _macro_hash_map_find_free(ctrl, new_cap, ehv);                              \
+            ctrl[k] = (uint8_t)(ehv & 0x7F);                                                \
+            memcpy(new_slots + k, old_slots + j, sizeof(type));                             \
+        }                                                                                   \
+        free(h->ctrl);                                                                      \
+        h->ctrl = ctrl;                                                                     \
+        h->slots = new_slots;                                                               \
+        h->capacity = new_cap;                                                              \
+        h->growth_left = new_cap - (new_cap >> 3) - h->size;                                \
+    }
+
+#define __macro_hash_map_insert_code(style, type, hash, cmp, h, item)                       \
+    size_t i;                                                                               \
+    __macro_hash_map_probe_code(, style, type, type, hash, cmp, h, item, i, goto insert)    \
+    return false;                                                                           \
+    insert:                                                                                 \
+    {                                                                                       \
+        /* the probe only hashes the item when the table has elements */                    \
+        if (!h->size)                                                                       \
+            hv = _macro_hash_map_mix(hash(item));                                           \
+        i = h->capacity ? _macro_hash_map_find_free(h->ctrl, h->capacity, hv) : 0;          \
+        if (!h->capacity || (h->ctrl[i] == __macro_hash_map_empty && !h->growth_left)) {    \
+            /* only grow if the table is mostly full, not mostly deleted */                 \
+            __macro_hash_map_resize_code(type, hash, h,                                     \
+                !h->capacity ? __macro_hash_map_min_capacity :                              \
+                h->size * 16 > h->capacity * 7 ?                                            \
+                h->capacity << 1 : h->capacity)                                             \
+            i = _macro_hash_map_find_free(h->ctrl, h->capacity, hv);                        \
+        }                                                                                   \
+        if (h->ctrl[i] == __macro_hash_map_empty)                                           \
+            h->growth_left--;                                                               \
+        h->ctrl[i] = (uint8_t)(hv & 0x7F);                                                  \
+        memcpy((type *)h->slots + i, item, sizeof(type));                                   \
+        h->size++;                                                                          \
+        return true;                                                                        \
+    }
+
+#endif /* _macro_hash_map_code_H */
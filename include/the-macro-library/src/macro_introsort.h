@@ -10,6 +10,7 @@
 #include <stdbool.h>
 
 
+#include "the-macro-library/src/macro_sort_config.h"
 #include "the-macro-library/src/macro_check_sorted.h"
 #include "the-macro-library/src/macro_dutch_flag_partition.h"
 #include "the-macro-library/src/macro_isort.h"
@@ -152,7 +153,7 @@ typedef struct {
 
 #define __macro_introsort_code(style, type, cmp)                  \
     __macro_introsort_ivars(type);                                \
-    if(n < 17) {                                                  \
+    if(n < MACRO_SORT_SMALL) {                                    \
         macro_micro_check_reverse_on(style, type, cmp, base, n, a, b)  \
         macro_isort(style, type, cmp, base, n, e, a, b, tmp );    \
         return;                                                   \
@@ -168,7 +169,7 @@ typedef struct {
 hi_mid_low:;                                                      \
     __macro_lo_mid_hi();                                          \
 find_pivot:;                                                      \
-    if(n > 40) {                                                  \
+    if(n > MACRO_SORT_NINTHER) {                                  \
         __macro_pivot_ninther(style, type, cmp);                  \
     } else {                                                      \
         __macro_pivot_5ther(style, type, cmp);                    \
@@ -196,7 +197,7 @@ pop_stack:;                                                       \
 loop:;                                                            \
     cur_depth++;                                                  \
 small_sort:;                                                      \
-    if(n < 17) {                                                  \
+    if(n < MACRO_SORT_SMALL) {                                    \
         macro_isort(style, type, cmp, base, n, e, a, b, tmp );    \
         goto pop_stack;                                           \
     }                                                             \
@@ -0,0 +1,258 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_introsort_step_H
+#define _macro_introsort_step_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+#include "the-macro-library/macro_time.h"
+#include "the-macro-library/src/macro_introsort.h"
+
+/*
+    A resumable version of the introsort.  All of the state that the introsort keeps in
+    local variables (the explicit stack, the current segment, and the pointers used by
+    the partition and the heap sort) lives in macro_sort_state_t so that the sort can
+    return in the middle of a partition and pick up where it left off.
+
+    The partition is the same three way (dutch flag) partition found in
+    macro_dutch_flag_partition.h, written as a loop so that the budget can be checked
+    between comparisons.  Segments under MACRO_SORT_SMALL elements are sorted with the
+    insertion sort in one go.  The macro_check_sorted fast path is not used because a
+    sorted scan of a large array can't be interrupted.
+
+    The larger side of a partition is pushed onto the stack and the smaller side is
+    sorted next, so the stack never needs more than 64 entries.  Each entry keeps the
+    depth of its segment (one more than the segment it was split from), so a chain of
+    bad pivots reaches depth_limit and falls back to the heap sort no matter which
+    side of each partition is pushed.
+*/
+typedef struct {
+    void *base;
+    ssize_t n;
+    int depth;
+} __macro_sort_step_stack_t;
+
+typedef struct {
+    __macro_sort_step_stack_t stack[64];
+    int top;
+    int cur_depth;
+    int depth_limit;
+    int phase;
+    int side;
+    void *base;
+    ssize_t n;
+    void *left_eq, *left_p, *right_p, *right_eq;
+    void *iter, *endp;
+} macro_sort_state_t;
+
+#define __macro_sort_step_segment 0
+#define __macro_sort_step_partition 1
+#define __macro_sort_step_heapify 2
+#define __macro_sort_step_heap_pop 3
+#define __macro_sort_step_done 4
+
+static inline void macro_sort_state_init(macro_sort_state_t *state, void *base, size_t n) {
+    int depth_limit = 0;
+    ssize_t tmp_n;
+    (void)tmp_n;
+    if (n > 1) {
+        __mcro_introsort_max_depth(n);
+    }
+    state->top = 0;
+    state->cur_depth = 0;
+    state->depth_limit = depth_limit;
+    state->phase = __macro_sort_step_segment;
+    state->base = base;
+    state->n = n > 1 ? (ssize_t)n : 0;
+}
+
+static inline bool macro_sort_state_done(const macro_sort_state_t *state) {
+    return state->phase == __macro_sort_step_done;
+}
+
+/* the clock is checked every 256 comparisons (so every step makes some progress) */
+#define __macro_sort_step_spent()                                                       \
+    ((budget_comparisons && cmps >= budget_comparisons) ||                              \
+     (deadline && cmps >= next_check &&                                                 \
+      (next_check = cmps + 256, macro_now() >= deadline)))
+
+#define __macro_sort_step_less(style, type, cmp, x, y)    \
+    (cmps++, macro_less(style, type, cmp, x, y))
+
+#define __macro_sort_step_save_partition()    \
+    state->left_eq = left_eq;                 \
+    state->left_p = left_p;                   \
+    state->right_p = right_p;                 \
+    state->right_eq = right_eq;               \
+    state->side = side
+
+#define __macro_sort_step_code(style, type, cmp)                                          \
+    type *base, *lo, *mid, *hi, *a, *b, *c, *d, *e, *f;                                   \
+    type *left_eq, *left_p, *right_p, *right_eq, *iter, *endp, *i, *largest, *left, *right; \
+    type tmp;                                                                             \
+    ssize_t n, delta, left_n, right_n, tmp_n;                                             \
+    int side;                                                                             \
+    size_t cmps = 0, next_check = 256;                                                    \
+    uint64_t deadline = budget_ns ? macro_now() + budget_ns : 0;                          \
+    base = (type *)state->base;                                                           \
+    n = state->n;                                                                         \
+    switch(state->phase) {                                                                \
+        case __macro_sort_step_partition:                                                 \
+            lo = base;                                                                    \
+            hi = lo + (n - 1);                                                            \
+            left_eq = (type *)state->left_eq;                                             \
+            left_p = (type *)state->left_p;                                               \
+            right_p = (type *)state->right_p;                                             \
+            right_eq = (type *)state->right_eq;                                           \
+            side = state->side;                                                           \
+            goto partition_loop;                                                          \
+        case __macro_sort_step_heapify:                                                   \
+            iter = (type *)state->iter;                                                   \
+            endp = (type *)state->endp;                                                   \
+            goto heapify_loop;                                                            \
+        case __macro_sort_step_heap_pop:                                                  \
+            endp = (type *)state->endp;                                                   \
+            goto heap_pop_loop;                                                           \
+        case __macro_sort_step_done:                                                      \
+            return true;                                                                  \
+        default:                                                                          \
+            break;                                                                        \
+    }                                                                                     \
+next_segment:;                                                                            \
+    if(!n) {                                                                              \
+        if(!state->top) {                                                                 \
+            state->phase = __macro_sort_step_done;                                        \
+            state->n = 0;                                                                 \
+            return true;                                                                  \
+        }                                                                                 \
+        state->top--;                                                                     \
+        base = (type *)state->stack[state->top].base;                                     \
+        n = state->stack[state->top].n;                                                   \
+        state->cur_depth = state->stack[state->top].depth;                                \
+    }                                                                                     \
+    if(__macro_sort_step_spent()) {                                                       \
+        state->phase = __macro_sort_step_segment;                                         \
+        state->base = base;                                                               \
+        state->n = n;                                                                     \
+        return false;                                                                     \
+    }                                                                                     \
+    if(n < MACRO_SORT_SMALL) {                                                            \
+        macro_isort(style, type, cmp, base, n, e, a, b, tmp);                             \
+        cmps += n << 2;                                                                   \
+        n = 0;                                                                            \
+        goto next_segment;                                                                \
+    }                                                                                     \
+    if(state->cur_depth >= state->depth_limit) {                                          \
+        endp = base + n;                                                                  \
+        iter = base + n / 2 - 1;                                                          \
+        goto heapify_loop;                                                                \
+    }                                                                                     \
+    __macro_lo_mid_hi();                                                                  \
+    if(n > MACRO_SORT_NINTHER) {                                                          \
+        __macro_pivot_ninther(style, type, cmp);                                          \
+        cmps += 12;                                                                       \
+    } else {                                                                              \
+        __macro_pivot_5ther(style, type, cmp);                                            \
+        cmps += 6;                                                                        \
+    }                                                                                     \
+    macro_swap(lo, mid);                                                                  \
+    left_eq = left_p = lo + 1;                                                            \
+    right_p = right_eq = hi;                                                              \
+    side = 0;                                                                             \
+partition_loop:;                                                                          \
+    while(left_p <= right_p) {                                                            \
+        if(__macro_sort_step_spent()) {                                                   \
+            __macro_sort_step_save_partition();                                           \
+            state->phase = __macro_sort_step_partition;                                   \
+            state->base = base;                                                           \
+            state->n = n;                                                                 \
+            return false;                                                                 \
+        }                                                                                 \
+        if(!side) {                                                                       \
+            if(__macro_sort_step_less(style, type, cmp, left_p, lo))                      \
+                left_p++;                                                                 \
+            else if(__macro_sort_step_less(style, type, cmp, lo, left_p))                 \
+                side = 1;                                                                 \
+            else {                                                                        \
+                macro_swap(left_eq, left_p);                                              \
+                left_eq++;                                                                \
+                left_p++;                                                                 \
+            }                                                                             \
+        } else {                                                                          \
+            if(__macro_sort_step_less(style, type, cmp, lo, right_p))                     \
+                right_p--;                                                                \
+            else if(__macro_sort_step_less(style, type, cmp, right_p, lo)) {              \
+                macro_swap(left_p, right_p);                                              \
+                left_p++;                                                                 \
+                right_p--;                                                                \
+                side = 0;                                                                 \
+            } else {                                                                      \
+                macro_swap(right_p, right_eq);                                            \
+                right_eq--;                                                               \
+                right_p--;                                                                \
+            }                                                                             \
+        }                                                                                 \
+    }                                                                                     \
+    left_n = left_p - left_eq;                                                            \
+    right_n = right_eq - right_p;                                                         \
+    tmp_n = left_eq - lo;                                                                 \
+    if(tmp_n > left_n)                                                                    \
+        tmp_n = left_n;                                                                   \
+    macro_vecswap(lo, left_p - tmp_n, a, b, tmp_n);                                       \
+    tmp_n = hi - right_eq;                                                                \
+    if(tmp_n > right_n)                                                                   \
+        tmp_n = right_n;                                                                  \
+    macro_vecswap(left_p, hi + 1 - tmp_n, a, b, tmp_n);                                   \
+    a = lo;                                                                               \
+    b = hi + 1 - right_n;                                                                 \
+    state->cur_depth++;                                                                   \
+    if(left_n < right_n) {                                                                \
+        c = a; a = b; b = c;                                                              \
+        tmp_n = left_n; left_n = right_n; right_n = tmp_n;                                \
+    }                                                                                     \
+    if(left_n > 1) {                                                                      \
+        state->stack[state->top].base = a;                                                \
+        state->stack[state->top].n = left_n;                                              \
+        state->stack[state->top].depth = state->cur_depth;                                \
+        state->top++;                                                                     \
+    }                                                                                     \
+    base = b;                                                                             \
+    n = right_n > 1 ? right_n : 0;                                                        \
+    goto next_segment;                                                                    \
+heapify_loop:;                                                                            \
+    while(iter >= base) {                                                                 \
+        if(__macro_sort_step_spent()) {                                                   \
+            state->phase = __macro_sort_step_heapify;                                     \
+            state->iter = iter;                                                           \
+            state->endp = endp;                                                           \
+            state->base = base;                                                           \
+            state->n = n;                                                                 \
+            return false;                                                                 \
+        }                                                                                 \
+        macro_max_heapify(style, type, cmp, base, endp,                                   \
+                          iter, i, largest, left, right)                                  \
+        cmps += state->depth_limit;                                                       \
+        iter--;                                                                           \
+    }                                                                                     \
+    endp = base + (n - 1);                                                                \
+heap_pop_loop:;                                                                           \
+    while(endp > base) {                                                                  \
+        if(__macro_sort_step_spent()) {                                                   \
+            state->phase = __macro_sort_step_heap_pop;                                    \
+            state->endp = endp;                                                           \
+            state->base = base;                                                           \
+            state->n = n;                                                                 \
+            return false;                                                                 \
+        }                                                                                 \
+        macro_swap(base, endp);                                                           \
+        macro_max_heapify(style, type, cmp, base, endp,                                   \
+                          base, i, largest, left, right)                                  \
+        cmps += state->depth_limit;                                                       \
+        endp--;                                                                           \
+    }                                                                                     \
+    n = 0;                                                                                \
+    goto next_segment;
+
+#endif /* _macro_introsort_step_H */
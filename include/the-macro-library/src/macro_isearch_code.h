@@ -0,0 +1,180 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_isearch_code_H
+#define _macro_isearch_code_H
+
+#include <stddef.h>
+#include <stdlib.h>
+
+/*
+    Searches over sorted numeric arrays which use the values themselves (instead of a
+    compare function) to guess where a key is.  Both find the lower bound (the first
+    element >= key) and return the same result as macro_bsearch_lower_bound.
+*/
+
+/* sets r to the first element in [lo, lo + len) which is >= key (or lo + len) without
+   branching on the comparisons (len must be > 0) */
+#define __macro_isearch_bsearch(lo, len, key, r, half)    \
+    while(len > 1) {                                      \
+        half = len >> 1;                                  \
+        len -= half;                                      \
+        lo += (size_t)(lo[half - 1] < key) * half;        \
+    }                                                     \
+    r = lo + (*lo < key);
+
+/*
+    Interpolation-sequential search.  The first probe is interpolated between the end
+    points of the array.  From there the search walks toward the key in steps which
+    double (1, 2, 4, ...), so a good guess costs a few comparisons, and a bad guess
+    (skewed keys) costs at most about 2 log2(n) comparisons.  The range that the walk
+    brackets is finished with a binary search.
+*/
+#define __macro_isearch_code(value_type, key, base, n)                          \
+    const value_type *a = (const value_type *)base;                             \
+    const value_type *lo, *r;                                                   \
+    value_type k = *key;                                                        \
+    size_t l, h, p, step, len, half;                                            \
+    if(!n || a[n - 1] < k)                                                      \
+        return NULL;                                                            \
+    if(!(a[0] < k))                                                             \
+        return (value_type *)a;                                                 \
+    /* a[l] < k <= a[h] */                                                      \
+    l = 0;                                                                      \
+    h = n - 1;                                                                  \
+    p = (size_t)((double)(h - l) * (((double)k - (double)a[l]) /                \
+                                    ((double)a[h] - (double)a[l])));            \
+    if(p <= l)                                                                  \
+        p = l + 1;                                                              \
+    if(p > h)                                                                   \
+        p = h;                                                                  \
+    step = 1;                                                                   \
+    if(a[p] < k) {                                                              \
+        l = p;                                                                  \
+        while(step < h - l && a[l + step] < k) {                                \
+            l += step;                                                          \
+            step <<= 1;                                                         \
+        }                                                                       \
+        if(step < h - l)                                                        \
+            h = l + step;                                                       \
+    } else {                                                                    \
+        h = p;                                                                  \
+        while(step < h - l && !(a[h - step] < k)) {                             \
+            h -= step;                                                          \
+            step <<= 1;                                                         \
+        }                                                                       \
+        if(step < h - l)                                                        \
+            l = h - step;                                                       \
+    }                                                                           \
+    lo = a + l + 1;                                                             \
+    len = h - l;                                                                \
+    __macro_isearch_bsearch(lo, len, k, r, half);                               \
+    return (value_type *)r;
+
+/*
+    The learned index is a piecewise linear model of position as a function of key.  It
+    is built greedily (a shrinking cone): a segment is extended as long as some slope
+    predicts the position of every distinct key in it within max_error, and the slope
+    in the middle of the remaining range is used.
+
+    A lookup binary searches the (few) segments for the one covering key, predicts the
+    position, and binary searches the max_error window around it.  If the window
+    doesn't bracket the key (only possible for keys which aren't in the array and fall
+    outside of the model) the whole array is searched.
+*/
+#define __macro_learned_index_build_code(value_type, segment_type, idx, base, n, max_error) \
+    size_t i, start, points = 0, num = 0, size = 16;                            \
+    double dx, s, s_lo, s_hi, slope_lo = 0.0, slope_hi = 0.0;                   \
+    double e = (double)max_error;                                               \
+    segment_type *segs;                                                         \
+    idx->base = base;                                                           \
+    idx->n = n;                                                                 \
+    idx->max_error = max_error;                                                 \
+    idx->num_segments = 0;                                                      \
+    idx->segments = NULL;                                                       \
+    if(!n)                                                                      \
+        return true;                                                            \
+    idx->segments = (segment_type *)malloc(size * sizeof(segment_type));        \
+    if(!idx->segments)                                                          \
+        return false;                                                           \
+    start = 0;                                                                  \
+    for(i = 1; i <= n; i++) {                                                   \
+        if(i < n) {                                                             \
+            if(!(base[i - 1] < base[i]))                                        \
+                continue; /* only the first of equal keys is modeled */         \
+            dx = (double)base[i] - (double)base[start];                         \
+            if(dx > 0.0) {                                                      \
+                s = (double)(i - start) / dx;                                   \
+                s_lo = ((double)(i - start) - e) / dx;                          \
+                s_hi = ((double)(i - start) + e) / dx;                          \
+                if(!points) {                                                   \
+                    slope_lo = s_lo;                                            \
+                    slope_hi = s_hi;                                            \
+                    points++;                                                   \
+                    continue;                                                   \
+                }                                                               \
+                if(s >= slope_lo && s <= slope_hi) {                            \
+                    if(s_lo > slope_lo)                                         \
+                        slope_lo = s_lo;                                        \
+                    if(s_hi < slope_hi)                                         \
+                        slope_hi = s_hi;                                        \
+                    points++;                                                   \
+                    continue;                                                   \
+                }                                                               \
+            }                                                                   \
+        }                                                                       \
+        if(num == size) {                                                       \
+            segs = (segment_type *)realloc(idx->segments,                       \
+                                           (size << 1) * sizeof(segment_type)); \
+            if(!segs) {                                                         \
+                free(idx->segments);                                            \
+                idx->segments = NULL;                                           \
+                return false;                                                   \
+            }                                                                   \
+            idx->segments = segs;                                               \
+            size <<= 1;                                                         \
+        }                                                                       \
+        idx->segments[num].key = base[start];                                   \
+        idx->segments[num].pos = start;                                         \
+        idx->segments[num].slope = points ? (slope_lo + slope_hi) * 0.5 : 0.0;  \
+        num++;                                                                  \
+        start = i;                                                              \
+        points = 0;                                                             \
+    }                                                                           \
+    idx->num_segments = num;                                                    \
+    return true;
+
+#define __macro_learned_index_lower_bound_code(value_type, idx, key)            \
+    const value_type *a = idx->base, *lo, *r;                                   \
+    value_type k = *key;                                                        \
+    size_t n = idx->n, s, len, half, l, h;                                      \
+    double p;                                                                   \
+    if(!n || a[n - 1] < k)                                                      \
+        return NULL;                                                            \
+    if(!(a[0] < k))                                                             \
+        return (value_type *)a;                                                 \
+    /* the last segment whose first key is <= k */                              \
+    s = 0;                                                                      \
+    len = idx->num_segments;                                                    \
+    while(len > 1) {                                                            \
+        half = len >> 1;                                                        \
+        len -= half;                                                            \
+        s += (size_t)(!(k < idx->segments[s + half].key)) * half;               \
+    }                                                                           \
+    p = (double)idx->segments[s].pos +                                          \
+        idx->segments[s].slope * ((double)k - (double)idx->segments[s].key);    \
+    l = p > (double)(idx->max_error + 1) ? (size_t)p - idx->max_error - 1 : 0;  \
+    h = p < (double)n ? (size_t)p + idx->max_error + 1 : n;                     \
+    if(h > n - 1)                                                               \
+        h = n - 1;                                                              \
+    if(l >= h || !(a[l] < k) || a[h] < k) {                                     \
+        /* outside of the error bound */                                        \
+        l = 0;                                                                  \
+        h = n - 1;                                                              \
+    }                                                                           \
+    /* a[l] < k <= a[h] */                                                      \
+    lo = a + l + 1;                                                             \
+    len = h - l;                                                                \
+    __macro_isearch_bsearch(lo, len, k, r, half);                               \
+    return (value_type *)r;
+
+#endif /* _macro_isearch_code_H */
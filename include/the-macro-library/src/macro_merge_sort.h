@@ -0,0 +1,213 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_merge_sort_code_H
+#define _macro_merge_sort_code_H
+
+#include <sys/types.h>
+
+#include "the-macro-library/macro_cmp.h"
+
+/*
+    A merge sort which is tuned to use as few comparisons as possible.  It is meant
+    for compare functions which are expensive relative to moving the data.
+
+    * runs of 32 elements are sorted with a binary insertion sort.  Each element
+      costs ceil(log2(i+1)) comparisons.  The ascending (or strictly descending) run
+      at the start of each block is found first, so sorted and reversed blocks cost
+      one comparison per element.
+    * runs are merged bottom up (no recursion).  If the last element of the left run
+      is not greater than the first element of the right run, the merge is skipped.
+    * the merge gallops.  Once one run has won 7 times in a row, an exponential
+      search followed by a binary search finds how many more elements to take from
+      that run.  This makes merging structured (partially sorted, reversed) input
+      cost O(log n) comparisons instead of O(n).
+
+    The smaller of the two runs is copied into buf (which must hold at least n/2
+    elements) and merged back into place.  Ties always favor the left run, so the sort
+    is stable.
+*/
+
+#define __macro_merge_sort_run 32
+
+/* find the first element in [lo, hi) for which cond is true using an exponential
+   search from lo followed by a binary search.  cond must be false and then true
+   (lower finds the first element not less than key, upper the first element greater
+   than key).  r is the result */
+#define __macro_gallop_lower(style, type, cmp, key, x) !macro_less(style, type, cmp, x, key)
+#define __macro_gallop_upper(style, type, cmp, key, x) macro_less(style, type, cmp, key, x)
+
+#define __macro_gallop(cond, style, type, cmp, key, lo, hi, r, ofs, l, h, m)   \
+    ofs = 0;                                                                    \
+    l = lo;                                                                     \
+    while(ofs < hi - lo && !(cond(style, type, cmp, key, lo + ofs))) {          \
+        l = lo + ofs + 1;                                                       \
+        ofs = (ofs << 1) + 1;                                                   \
+    }                                                                           \
+    h = ofs < hi - lo ? lo + ofs : hi;                                          \
+    __macro_gallop_bsearch(cond, style, type, cmp, key, r, l, h, m)
+
+/* the same as __macro_gallop, except the exponential search starts from hi */
+#define __macro_gallop_right(cond, style, type, cmp, key, lo, hi, r, ofs, l, h, m) \
+    ofs = 1;                                                                    \
+    h = hi;                                                                     \
+    while(ofs <= hi - lo && cond(style, type, cmp, key, hi - ofs)) {            \
+        h = hi - ofs;                                                           \
+        ofs = (ofs << 1) + 1;                                                   \
+    }                                                                           \
+    l = ofs <= hi - lo ? hi - ofs + 1 : lo;                                     \
+    __macro_gallop_bsearch(cond, style, type, cmp, key, r, l, h, m)
+
+#define __macro_gallop_bsearch(cond, style, type, cmp, key, r, l, h, m)    \
+    while(l < h) {                                                          \
+        m = l + ((h - l) >> 1);                                             \
+        if(cond(style, type, cmp, key, m))                                  \
+            h = m;                                                          \
+        else                                                                \
+            l = m + 1;                                                      \
+    }                                                                       \
+    r = l;
+
+/* insert each element of [start, ep) into the sorted range [base, start) using a
+   binary search to find its position */
+#define __macro_binary_insert(style, type, cmp, base, start, ep,     \
+                              curp, p, l, m, tmp)                    \
+    curp = start;                                                    \
+    while (curp < ep) {                                              \
+        tmp = *curp;                                                 \
+        l = base;                                                    \
+        p = curp;                                                    \
+        while (l < p) {                                              \
+            m = l + ((p - l) >> 1);                                  \
+            if (macro_less(style, type, cmp, &tmp, m))               \
+                p = m;                                               \
+            else                                                     \
+                l = m + 1;                                           \
+        }                                                            \
+        p = curp;                                                    \
+        while (p > l) {                                              \
+            *p = *(p - 1);                                           \
+            --p;                                                     \
+        }                                                            \
+        *p = tmp;                                                    \
+        ++curp;                                                      \
+    }
+
+/* sets p to the end of the run which starts at lo (a strictly descending run is
+   reversed, which keeps the sort stable) */
+#define __macro_natural_run(style, type, cmp, lo, hi, p, a, b, tmp)            \
+    p = lo + 1;                                                                \
+    if(p < hi && macro_less(style, type, cmp, p, lo)) {                        \
+        p++;                                                                   \
+        while(p < hi && macro_less(style, type, cmp, p, p - 1))                \
+            p++;                                                               \
+        a = lo;                                                                \
+        b = p - 1;                                                             \
+        while(a < b) {                                                         \
+            macro_swap(a, b);                                                  \
+            a++;                                                               \
+            b--;                                                               \
+        }                                                                      \
+    } else if(p < hi) {                                                        \
+        p++;                                                                   \
+        while(p < hi && !macro_less(style, type, cmp, p, p - 1))               \
+            p++;                                                               \
+    }
+
+/* merge [lo, mid) and [mid, hi) by copying the left run into buf and merging forward */
+#define __macro_merge_lo(style, type, cmp, lo, mid, hi, buf)                          \
+    a = buf;                                                                          \
+    ae = buf;                                                                         \
+    for(p = lo; p < mid; p++)                                                         \
+        *ae++ = *p;                                                                   \
+    b = mid;                                                                          \
+    d = lo;                                                                           \
+    a_wins = b_wins = 0;                                                              \
+    while(a < ae && b < hi) {                                                         \
+        if(macro_less(style, type, cmp, b, a)) {                                      \
+            *d++ = *b++;                                                              \
+            a_wins = 0;                                                               \
+            if(++b_wins >= 7) {                                                       \
+                __macro_gallop(__macro_gallop_lower, style, type, cmp,                \
+                               a, b, hi, p, ofs, l, h, m);                            \
+                while(b < p)                                                          \
+                    *d++ = *b++;                                                      \
+                b_wins = 0;                                                           \
+            }                                                                         \
+        } else {                                                                      \
+            *d++ = *a++;                                                              \
+            b_wins = 0;                                                               \
+            if(++a_wins >= 7) {                                                       \
+                __macro_gallop(__macro_gallop_upper, style, type, cmp,                \
+                               b, a, ae, p, ofs, l, h, m);                            \
+                while(a < p)                                                          \
+                    *d++ = *a++;                                                      \
+                a_wins = 0;                                                           \
+            }                                                                         \
+        }                                                                             \
+    }                                                                                 \
+    while(a < ae)                                                                     \
+        *d++ = *a++;
+
+/* merge [lo, mid) and [mid, hi) by copying the right run into buf and merging backward */
+#define __macro_merge_hi(style, type, cmp, lo, mid, hi, buf)                          \
+    b = buf;                                                                          \
+    for(p = mid; p < hi; p++)                                                         \
+        *b++ = *p;                                                                    \
+    a = mid;                                                                          \
+    d = hi;                                                                           \
+    a_wins = b_wins = 0;                                                              \
+    while(a > lo && b > buf) {                                                        \
+        if(macro_less(style, type, cmp, b - 1, a - 1)) {                              \
+            *--d = *--a;                                                              \
+            b_wins = 0;                                                               \
+            if(++a_wins >= 7) {                                                       \
+                __macro_gallop_right(__macro_gallop_upper, style, type, cmp,          \
+                                     b - 1, lo, a, p, ofs, l, h, m);                  \
+                while(a > p)                                                          \
+                    *--d = *--a;                                                      \
+                a_wins = 0;                                                           \
+            }                                                                         \
+        } else {                                                                      \
+            *--d = *--b;                                                              \
+            a_wins = 0;                                                               \
+            if(++b_wins >= 7) {                                                       \
+                __macro_gallop_right(__macro_gallop_lower, style, type, cmp,          \
+                                     a - 1, buf, b, p, ofs, l, h, m);                 \
+                while(b > p)                                                          \
+                    *--d = *--b;                                                      \
+                b_wins = 0;                                                           \
+            }                                                                         \
+        }                                                                             \
+    }                                                                                 \
+    while(b > buf)                                                                    \
+        *--d = *--b;
+
+#define __macro_merge_sort_code(style, type, cmp, base, n, buf)                          \
+    {                                                                                    \
+        type *lo, *mid, *hi, *ep, *a, *ae, *b, *d, *p, *l, *h, *m, *curp;                \
+        type tmp;                                                                        \
+        size_t i, width, a_wins, b_wins;                                                  \
+        ssize_t ofs;                                                                     \
+        ep = base + n;                                                                   \
+        for(lo = base; lo < ep; lo += __macro_merge_sort_run) {                          \
+            hi = ep - lo > __macro_merge_sort_run ? lo + __macro_merge_sort_run : ep;    \
+            __macro_natural_run(style, type, cmp, lo, hi, p, a, b, tmp);                 \
+            __macro_binary_insert(style, type, cmp, lo, p, hi, curp, p, l, m, tmp);      \
+        }                                                                                \
+        for(width = __macro_merge_sort_run; width < (size_t)(n); width <<= 1) {          \
+            for(i = 0; i + width < (size_t)(n); i += (width << 1)) {                     \
+                lo = base + i;                                                           \
+                mid = lo + width;                                                        \
+                hi = (size_t)(ep - mid) > width ? mid + width : ep;                      \
+                if(!macro_less(style, type, cmp, mid, mid - 1))                          \
+                    continue;                                                            \
+                if(hi - mid < mid - lo) {                                                \
+                    __macro_merge_hi(style, type, cmp, lo, mid, hi, buf);                \
+                } else {                                                                 \
+                    __macro_merge_lo(style, type, cmp, lo, mid, hi, buf);                \
+                }                                                                        \
+            }                                                                            \
+        }                                                                                \
+    }
+
+#endif /* _macro_merge_sort_code_H */
@@ -0,0 +1,17 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_prefetch_H
+#define _macro_prefetch_H
+
+/*
+    __mcro_prefetch(p) hints that the cache line at p will be read soon.  It never
+    faults, so it is safe to prefetch past the end of an array.  It does nothing on
+    compilers without __builtin_prefetch.
+*/
+#if defined(__GNUC__) || defined(__clang__)
+#define __mcro_prefetch(p) __builtin_prefetch((const void *)(p))
+#else
+#define __mcro_prefetch(p) ((void)0)
+#endif
+
+#endif /* _macro_prefetch_H */
@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_radix_sort_H
+#define _macro_radix_sort_H
+
+#include <string.h>
+
+/*
+    A least significant digit radix sort over a fixed size unsigned char array field
+    (an encoded key, see macro_key.h).  The sort is stable and makes one counting pass
+    and one scatter pass per key byte.  A byte position where every element has the
+    same value is skipped, which is common for the high bytes of small integers.
+
+    * type, field - the element type and the name of the unsigned char array in it
+    * base, n is the array to be sorted and the number of elements
+    * buf is a scratch array of n elements of type
+
+    The result always ends up in base.
+*/
+
+#define __macro_radix_sort_bytes_code(type, field, base, n, buf)                     \
+    {                                                                                \
+        size_t counts[256];                                                          \
+        size_t key_size = sizeof(((type *)0)->field);                                \
+        type *src = base, *dst = buf, *p, *ep, *swap_tmp;                            \
+        size_t i, sum, c;                                                            \
+        while(key_size > 0) {                                                        \
+            key_size--;                                                              \
+            memset(counts, 0, sizeof(counts));                                       \
+            ep = src + n;                                                            \
+            for(p = src; p < ep; p++)                                                \
+                counts[((const unsigned char *)p->field)[key_size]]++;               \
+            if(counts[((const unsigned char *)src->field)[key_size]] == (size_t)n)   \
+                continue;                                                            \
+            sum = 0;                                                                 \
+            for(i = 0; i < 256; i++) {                                               \
+                c = counts[i];                                                       \
+                counts[i] = sum;                                                     \
+                sum += c;                                                            \
+            }                                                                        \
+            for(p = src; p < ep; p++)                                                \
+                dst[counts[((const unsigned char *)p->field)[key_size]]++] = *p;     \
+            swap_tmp = src;                                                          \
+            src = dst;                                                               \
+            dst = swap_tmp;                                                          \
+        }                                                                            \
+        if(src != base)                                                              \
+            memcpy(base, src, (n) * sizeof(type));                                   \
+    }
+
+#endif /* _macro_radix_sort_H */
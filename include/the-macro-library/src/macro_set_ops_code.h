@@ -0,0 +1,232 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_set_ops_code_H
+#define _macro_set_ops_code_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "the-macro-library/macro_cmp.h"
+#include "the-macro-library/src/macro_merge_sort.h"
+
+/*
+    Intersection, union and difference of two sorted arrays.  The results match
+    std::set_intersection, std::set_union and std::set_difference: duplicates are
+    treated as a multiset, and equal elements are copied from a.
+
+    If one array is more than MACRO_GALLOP_RATIO times the length of the other, each
+    element of the short array is found in the long one with an exponential search
+    followed by a binary search (__macro_gallop from macro_merge_sort.h), so the cost
+    is O(short * log(long / short)) comparisons instead of O(short + long).  Otherwise
+    the arrays are merged linearly.
+
+    Each block sets r to the number of elements written to dest.  dest may be a for
+    the intersection and difference (the output never gets ahead of a).
+*/
+#ifndef MACRO_GALLOP_RATIO
+#define MACRO_GALLOP_RATIO 16
+#endif
+
+#define __macro_set_ops_vars(type, dest, a, na, b, nb)                         \
+    type *ap = (type *)(a), *ae = ap + (na);                                   \
+    type *bp = (type *)(b), *be = bp + (nb);                                   \
+    type *d = (dest), *p, *l, *h, *m;                                          \
+    ssize_t ofs
+
+#define __macro_set_ops_copy(d, src, end) \
+    while(src < end)                      \
+        *d++ = *src++;
+
+#define __macro_intersect_code(style, type, cmp, dest, a, na, b, nb, r)         \
+    {                                                                           \
+        __macro_set_ops_vars(type, dest, a, na, b, nb);                         \
+        if((size_t)(na) > (size_t)(nb) * MACRO_GALLOP_RATIO) {                  \
+            while(bp < be && ap < ae) {                                         \
+                __macro_gallop(__macro_gallop_lower, style, type, cmp,          \
+                               bp, ap, ae, p, ofs, l, h, m);                    \
+                ap = p;                                                         \
+                if(ap < ae && !macro_less(style, type, cmp, bp, ap))            \
+                    *d++ = *ap++;                                               \
+                bp++;                                                           \
+            }                                                                   \
+        } else if((size_t)(nb) > (size_t)(na) * MACRO_GALLOP_RATIO) {           \
+            while(ap < ae && bp < be) {                                         \
+                __macro_gallop(__macro_gallop_lower, style, type, cmp,          \
+                               ap, bp, be, p, ofs, l, h, m);                    \
+                bp = p;                                                         \
+                if(bp < be && !macro_less(style, type, cmp, ap, bp)) {          \
+                    *d++ = *ap;                                                 \
+                    bp++;                                                       \
+                }                                                               \
+                ap++;                                                           \
+            }                                                                   \
+        } else {                                                                \
+            while(ap < ae && bp < be) {                                         \
+                if(macro_less(style, type, cmp, ap, bp))                        \
+                    ap++;                                                       \
+                else if(macro_less(style, type, cmp, bp, ap))                   \
+                    bp++;                                                       \
+                else {                                                          \
+                    *d++ = *ap++;                                               \
+                    bp++;                                                       \
+                }                                                               \
+            }                                                                   \
+        }                                                                       \
+        r = (size_t)(d - (dest));                                               \
+    }
+
+#define __macro_union_code(style, type, cmp, dest, a, na, b, nb, r)             \
+    {                                                                           \
+        __macro_set_ops_vars(type, dest, a, na, b, nb);                         \
+        if((size_t)(na) > (size_t)(nb) * MACRO_GALLOP_RATIO) {                  \
+            while(bp < be) {                                                    \
+                __macro_gallop(__macro_gallop_lower, style, type, cmp,          \
+                               bp, ap, ae, p, ofs, l, h, m);                    \
+                __macro_set_ops_copy(d, ap, p);                                 \
+                if(ap < ae && !macro_less(style, type, cmp, bp, ap)) {          \
+                    *d++ = *ap++;                                               \
+                    bp++;                                                       \
+                } else                                                          \
+                    *d++ = *bp++;                                               \
+            }                                                                   \
+        } else if((size_t)(nb) > (size_t)(na) * MACRO_GALLOP_RATIO) {           \
+            while(ap < ae) {                                                    \
+                __macro_gallop(__macro_gallop_lower, style, type, cmp,          \
+                               ap, bp, be, p, ofs, l, h, m);                    \
+                __macro_set_ops_copy(d, bp, p);                                 \
+                if(bp < be && !macro_less(style, type, cmp, ap, bp))            \
+                    bp++;                                                       \
+                *d++ = *ap++;                                                   \
+            }                                                                   \
+        } else {                                                                \
+            while(ap < ae && bp < be) {                                         \
+                if(macro_less(style, type, cmp, ap, bp))                        \
+                    *d++ = *ap++;                                               \
+                else if(macro_less(style, type, cmp, bp, ap))                   \
+                    *d++ = *bp++;                                               \
+                else {                                                          \
+                    *d++ = *ap++;                                               \
+                    bp++;                                                       \
+                }                                                               \
+            }                                                                   \
+        }                                                                       \
+        __macro_set_ops_copy(d, ap, ae);                                        \
+        __macro_set_ops_copy(d, bp, be);                                        \
+        r = (size_t)(d - (dest));                                               \
+    }
+
+#define __macro_difference_code(style, type, cmp, dest, a, na, b, nb, r)        \
+    {                                                                           \
+        __macro_set_ops_vars(type, dest, a, na, b, nb);                         \
+        if((size_t)(na) > (size_t)(nb) * MACRO_GALLOP_RATIO) {                  \
+            while(bp < be && ap < ae) {                                         \
+                __macro_gallop(__macro_gallop_lower, style, type, cmp,          \
+                               bp, ap, ae, p, ofs, l, h, m);                    \
+                __macro_set_ops_copy(d, ap, p);                                 \
+                if(ap < ae && !macro_less(style, type, cmp, bp, ap))            \
+                    ap++;                                                       \
+                bp++;                                                           \
+            }                                                                   \
+        } else if((size_t)(nb) > (size_t)(na) * MACRO_GALLOP_RATIO) {           \
+            while(ap < ae && bp < be) {                                         \
+                __macro_gallop(__macro_gallop_lower, style, type, cmp,          \
+                               ap, bp, be, p, ofs, l, h, m);                    \
+                bp = p;                                                         \
+                if(bp < be && !macro_less(style, type, cmp, ap, bp))            \
+                    bp++;                                                       \
+                else                                                            \
+                    *d++ = *ap;                                                 \
+                ap++;                                                           \
+            }                                                                   \
+        } else {                                                                \
+            while(ap < ae && bp < be) {                                         \
+                if(macro_less(style, type, cmp, ap, bp))                        \
+                    *d++ = *ap++;                                               \
+                else if(macro_less(style, type, cmp, bp, ap))                   \
+                    bp++;                                                       \
+                else {                                                          \
+                    ap++;                                                       \
+                    bp++;                                                       \
+                }                                                               \
+            }                                                                   \
+        }                                                                       \
+        __macro_set_ops_copy(d, ap, ae);                                        \
+        r = (size_t)(d - (dest));                                               \
+    }
+
+/*
+    Intersects lists in order of increasing size.  The two shortest lists are
+    intersected into dest, and then dest is intersected with each longer list in place,
+    stopping early if it becomes empty.  dest must hold as many elements as the shortest
+    list.
+*/
+#define __macro_intersect_multi_code(style, type, cmp, dest, lists, sizes, num_lists) \
+    size_t i, j, r = 0, cur, prev = 0;                                                \
+    if(!num_lists)                                                                    \
+        return 0;                                                                     \
+    for(i = 0; i < num_lists; i++) {                                                  \
+        /* the next shortest list after prev (ties are taken in index order) */      \
+        cur = num_lists;                                                              \
+        for(j = 0; j < num_lists; j++) {                                              \
+            if(i && (sizes[j] < sizes[prev] || (sizes[j] == sizes[prev] && j <= prev))) \
+                continue;                                                             \
+            if(cur == num_lists || sizes[j] < sizes[cur])                             \
+                cur = j;                                                              \
+        }                                                                             \
+        if(!i) {                                                                      \
+            r = sizes[cur];                                                           \
+            for(j = 0; j < r; j++)                                                    \
+                dest[j] = lists[cur][j];                                              \
+        } else {                                                                      \
+            __macro_intersect_code(style, type, cmp, dest, dest, r,                   \
+                                   lists[cur], sizes[cur], r);                        \
+        }                                                                             \
+        if(!r)                                                                        \
+            return 0;                                                                 \
+        prev = cur;                                                                   \
+    }                                                                                 \
+    return r;
+
+/*
+    Intersects two strictly increasing uint32_t lists.  With AVX2, blocks of 8 from
+    each list are compared all against all (the block from b is rotated through 8
+    positions) and a movemask gives the elements of a which were found.  The block
+    with the smaller last element is then advanced (both if they are equal).  Lopsided
+    lists gallop instead and the tails are merged.
+*/
+static inline size_t macro_intersect_uint32(uint32_t *dest, const uint32_t *a, size_t na,
+                                            const uint32_t *b, size_t nb) {
+    size_t i = 0, j = 0, k = 0, r;
+#ifdef __AVX2__
+    if(na <= nb * MACRO_GALLOP_RATIO && nb <= na * MACRO_GALLOP_RATIO) {
+        const __m256i rot = _mm256_set_epi32(0, 7, 6, 5, 4, 3, 2, 1);
+        while(i + 8 <= na && j + 8 <= nb) {
+            __m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+            __m256i vb = _mm256_loadu_si256((const __m256i *)(b + j));
+            __m256i eq = _mm256_cmpeq_epi32(va, vb);
+            int s;
+            for(s = 1; s < 8; s++) {
+                vb = _mm256_permutevar8x32_epi32(vb, rot);
+                eq = _mm256_or_si256(eq, _mm256_cmpeq_epi32(va, vb));
+            }
+            unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(eq));
+            while(mask) {
+                dest[k++] = a[i + (size_t)__builtin_ctz(mask)];
+                mask &= mask - 1;
+            }
+            uint32_t amax = a[i + 7], bmax = b[j + 7];
+            i += (size_t)(amax <= bmax) << 3;
+            j += (size_t)(bmax <= amax) << 3;
+        }
+    }
+#endif
+    __macro_intersect_code(less, uint32_t, _, dest + k, a + i, na - i, b + j, nb - j, r);
+    return k + r;
+}
+
+#endif /* _macro_set_ops_code_H */
@@ -0,0 +1,45 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_sort_config_H
+#define _macro_sort_config_H
+
+/*
+    The thresholds used by the introsort (and the resumable and incremental sorts which
+    share its partitioning).  Each can be overridden at compile time with -D or by
+    defining it before the first include.  bin/macro-autotune.py measures them for an
+    element size on the current machine and writes a header with the results.
+
+    MACRO_SORT_SMALL      - segments with fewer elements are insertion sorted (17)
+    MACRO_SORT_NINTHER    - segments with more elements use a ninther pivot, otherwise
+                            the median of 5 is used (40)
+    MACRO_SORT_CHECK_FEW  - macro_check_sorted samples 4 points below this size (32)
+    MACRO_SORT_CHECK_SOME - macro_check_sorted samples 6 points below this size and 8
+                            points at or above it (256)
+
+    The header written by the autotuner must be included before the first header of the
+    library, as its values are checked here (and apply to every sort after it).
+*/
+
+#ifndef MACRO_SORT_SMALL
+#define MACRO_SORT_SMALL 17
+#endif
+
+#ifndef MACRO_SORT_NINTHER
+#define MACRO_SORT_NINTHER 40
+#endif
+
+#ifndef MACRO_SORT_CHECK_FEW
+#define MACRO_SORT_CHECK_FEW 32
+#endif
+
+#ifndef MACRO_SORT_CHECK_SOME
+#define MACRO_SORT_CHECK_SOME 256
+#endif
+
+/* macro_check_sorted and the pivot selection sample at n/8, so smaller segments must
+   be insertion sorted */
+#if MACRO_SORT_SMALL < 8
+#error "MACRO_SORT_SMALL must be at least 8"
+#endif
+
+#endif /* _macro_sort_config_H */
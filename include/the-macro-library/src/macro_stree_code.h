@@ -0,0 +1,140 @@
+// SPDX-FileCopyrightText:  2019-2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+#ifndef _macro_stree_code_H
+#define _macro_stree_code_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/*
+    A static B+ tree (S-tree) over 32 or 64 bit integer keys.  Each node is one 64 byte
+    cache line holding B = 64 / sizeof(key) keys and has B + 1 children, which are found
+    by index (node k's children are k * (B + 1) ... k * (B + 1) + B in the next layer) so
+    there are no pointers.  The layers are stored leaves first.  The leaf layer is the
+    sorted array itself (padded to a multiple of B), so a leaf position is a position in
+    the original array.  Key j of an internal node is the smallest key of the subtree to
+    the right of it.
+
+    The keys are stored so that they can be compared as signed integers (unsigned keys
+    have their top bit flipped) and the padding is the largest signed value.  A node is
+    searched by counting the keys less than x, which is a compare and movemask with
+    AVX2 and a loop the compiler can vectorize otherwise.  upper_bound(x) is
+    lower_bound(x + 1).
+*/
+
+#define __macro_stree_max_height 24
+
+#define __macro_stree_b(key_type) (64 / sizeof(key_type))
+
+/* flips the top bit of unsigned types (and does nothing to signed ones) */
+#define __macro_stree_bias(key_type)    \
+    ((key_type)((key_type)~(key_type)0 > (key_type)0 ? ~((key_type)-1 >> 1) : 0))
+
+#define __macro_stree_pad(key_type)    \
+    ((key_type)((1ULL << (sizeof(key_type) * 8 - 1)) - 1))
+
+static inline size_t macro_stree_rank32(const int32_t *node, int32_t x) {
+#ifdef __AVX2__
+    __m256i xv = _mm256_set1_epi32(x);
+    __m256i a = _mm256_cmpgt_epi32(xv, _mm256_load_si256((const __m256i *)node));
+    __m256i b = _mm256_cmpgt_epi32(xv, _mm256_load_si256((const __m256i *)(node + 8)));
+    unsigned m = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(a)) |
+                 ((unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(b)) << 8);
+    return (size_t)__builtin_popcount(m);
+#else
+    size_t i, r = 0;
+    for(i = 0; i < 16; i++)
+        r += node[i] < x;
+    return r;
+#endif
+}
+
+static inline size_t macro_stree_rank64(const int64_t *node, int64_t x) {
+#ifdef __AVX2__
+    __m256i xv = _mm256_set1_epi64x(x);
+    __m256i a = _mm256_cmpgt_epi64(xv, _mm256_load_si256((const __m256i *)node));
+    __m256i b = _mm256_cmpgt_epi64(xv, _mm256_load_si256((const __m256i *)(node + 4)));
+    unsigned m = (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(a)) |
+                 ((unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(b)) << 4);
+    return (size_t)__builtin_popcount(m);
+#else
+    size_t i, r = 0;
+    for(i = 0; i < 8; i++)
+        r += node[i] < x;
+    return r;
+#endif
+}
+
+#define __macro_stree_rank(key_type, node, x)                                   \
+    (sizeof(key_type) == 4 ? macro_stree_rank32((const int32_t *)(node), (int32_t)(x)) \
+                           : macro_stree_rank64((const int64_t *)(node), (int64_t)(x)))
+
+#define __macro_stree_build_code(key_type, t, sorted, n)                            \
+    const size_t B = __macro_stree_b(key_type);                                     \
+    size_t nodes[__macro_stree_max_height];                                         \
+    size_t h, i, j, k, l, c, total;                                                 \
+    key_type *tree;                                                                 \
+    t->tree = NULL;                                                                 \
+    t->n = n;                                                                       \
+    t->height = 0;                                                                  \
+    if(!n)                                                                          \
+        return true;                                                                \
+    nodes[0] = (n + B - 1) / B;                                                     \
+    t->offset[0] = 0;                                                               \
+    total = nodes[0];                                                               \
+    for(h = 1; nodes[h - 1] > 1; h++) {                                             \
+        nodes[h] = (nodes[h - 1] + B) / (B + 1);                                    \
+        t->offset[h] = total * B;                                                   \
+        total += nodes[h];                                                          \
+    }                                                                               \
+    t->height = h;                                                                  \
+    tree = (key_type *)aligned_alloc(64, total * 64);                               \
+    if(!tree)                                                                       \
+        return false;                                                               \
+    for(i = 0; i < n; i++)                                                          \
+        tree[i] = (key_type)(sorted[i] ^ __macro_stree_bias(key_type));             \
+    for(; i < nodes[0] * B; i++)                                                    \
+        tree[i] = __macro_stree_pad(key_type);                                      \
+    for(h = 1; h < t->height; h++) {                                                \
+        for(i = 0; i < nodes[h] * B; i++) {                                         \
+            k = i / B;                                                              \
+            j = i - k * B;                                                          \
+            c = k * (B + 1) + j + 1;                                                \
+            for(l = 1; l < h; l++)                                                  \
+                c *= (B + 1);                                                       \
+            tree[t->offset[h] + i] = c < nodes[0] ? tree[c * B]                     \
+                                                  : __macro_stree_pad(key_type);    \
+        }                                                                           \
+    }                                                                               \
+    t->tree = tree;                                                                 \
+    return true;
+
+/* x is biased, k ends as the position of the first key >= x */
+#define __macro_stree_search_code(key_type, t, x)                                   \
+    const size_t B = __macro_stree_b(key_type);                                     \
+    size_t h, k = 0;                                                                \
+    if(!t->n)                                                                       \
+        return 0;                                                                   \
+    for(h = t->height - 1; h > 0; h--)                                              \
+        k = k * (B + 1) + __macro_stree_rank(key_type, t->tree + t->offset[h] + k * B, x); \
+    k = k * B + __macro_stree_rank(key_type, t->tree + k * B, x);                   \
+    return k < t->n ? k : t->n;
+
+#define __macro_stree_lower_bound_code(key_type, t, key)                            \
+    key_type x = (key_type)(key ^ __macro_stree_bias(key_type));                    \
+    __macro_stree_search_code(key_type, t, x)
+
+#define __macro_stree_upper_bound_code(key_type, t, key)                            \
+    key_type x = (key_type)(key ^ __macro_stree_bias(key_type));                    \
+    if(x == __macro_stree_pad(key_type))                                            \
+        return t->n;                                                                \
+    x++;                                                                            \
+    __macro_stree_search_code(key_type, t, x)
+
+#endif /* _macro_stree_code_H */
@@ -3,13 +3,93 @@
 #ifndef _macro_swap_H
 #define _macro_swap_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+#include <type_traits>
+#endif
+
+/*
+    Elements (or ranges of elements) which are at least MACRO_SWAP_BLOCK_MIN bytes are
+    swapped with macro_block_swap instead of through tmp.  Copying through tmp reads
+    and writes each element three times, where the block swap moves 64 bytes at a time
+    through registers (the fixed size memcpy calls become vector loads and stores).
+
+    In C++, only trivially copyable types are swapped as bytes.
+*/
+#ifndef MACRO_SWAP_BLOCK_MIN
+#define MACRO_SWAP_BLOCK_MIN 64
+#endif
+
+#ifdef __cplusplus
+#define __mcro_swap_trivial(a)    \
+    std::is_trivially_copyable<typename std::remove_reference<decltype(*(a))>::type>::value
+#else
+#define __mcro_swap_trivial(a) 1
+#endif
+
+static inline void macro_block_swap(void *a, void *b, size_t len) {
+    unsigned char *x = (unsigned char *)a, *y = (unsigned char *)b;
+    unsigned char t[64], u[64];
+    while(len >= 64) {
+        memcpy(t, x, 64);
+        memcpy(u, y, 64);
+        memcpy(x, u, 64);
+        memcpy(y, t, 64);
+        x += 64;
+        y += 64;
+        len -= 64;
+    }
+    if(len >= 32) {
+        memcpy(t, x, 32);
+        memcpy(u, y, 32);
+        memcpy(x, u, 32);
+        memcpy(y, t, 32);
+        x += 32;
+        y += 32;
+        len -= 32;
+    }
+    if(len >= 16) {
+        memcpy(t, x, 16);
+        memcpy(u, y, 16);
+        memcpy(x, u, 16);
+        memcpy(y, t, 16);
+        x += 16;
+        y += 16;
+        len -= 16;
+    }
+    if(len >= 8) {
+        memcpy(t, x, 8);
+        memcpy(u, y, 8);
+        memcpy(x, u, 8);
+        memcpy(y, t, 8);
+        x += 8;
+        y += 8;
+        len -= 8;
+    }
+    while(len > 0) {
+        t[0] = *x;
+        *x++ = *y;
+        *y++ = t[0];
+        len--;
+    }
+}
+
 /*
     macro_swap requires tmp to be declared and to be of the type that
     a and b are pointed to.
 */
-#define macro_swap(a, b)    \
-    tmp = *(a);             \
-    *(a) = *(b);            \
-    *(b) = tmp
+#define macro_swap(a, b)                                                         \
+    do {                                                                         \
+        if(sizeof(*(a)) >= MACRO_SWAP_BLOCK_MIN && __mcro_swap_trivial(a)) {     \
+            macro_block_swap((a), (b), sizeof(*(a)));                            \
+        } else {                                                                 \
+            tmp = *(a);                                                          \
+            *(a) = *(b);                                                         \
+            *(b) = tmp;                                                          \
+        }                                                                        \
+    } while(0)
 
-#endif /* _macro_swap_H */
\ No newline at end of file
+#endif /* _macro_swap_H */
@@ -3,22 +3,32 @@
 #ifndef _macro_vecswap_H
 #define _macro_vecswap_H
 
+#include "the-macro-library/src/macro_swap.h"
+
 /*
     swaps x/tmp_n with y/tmp_n
 
     tmp_x, tmp_y are temporary variables which are the same type as x and y.
     tmp_num becomes zero after this macro, but is expected to be the number of
     elements to swap.
+
+    The two ranges are contiguous (and don't overlap), so once they span at least
+    MACRO_SWAP_BLOCK_MIN bytes they are swapped as one block (see macro_swap.h).
 */
 
-#define macro_vecswap(x, y, tmp_x, tmp_y, tmp_n)    \
-    tmp_x = x;                                      \
-    tmp_y = y;                                      \
-    while(tmp_n > 0) {                              \
-        macro_swap(tmp_x, tmp_y);                   \
-        tmp_x++;                                    \
-        tmp_y++;                                    \
-        tmp_n--;                                    \
+#define macro_vecswap(x, y, tmp_x, tmp_y, tmp_n)                                   \
+    tmp_x = x;                                                                     \
+    tmp_y = y;                                                                     \
+    if(tmp_n > 0 && (size_t)tmp_n * sizeof(*(tmp_x)) >= MACRO_SWAP_BLOCK_MIN &&    \
+       __mcro_swap_trivial(tmp_x)) {                                               \
+        macro_block_swap(tmp_x, tmp_y, (size_t)tmp_n * sizeof(*(tmp_x)));          \
+        tmp_n = 0;                                                                 \
+    }                                                                              \
+    while(tmp_n > 0) {                                                             \
+        macro_swap(tmp_x, tmp_y);                                                  \
+        tmp_x++;                                                                   \
+        tmp_y++;                                                                   \
+        tmp_n--;                                                                   \
     }
 
 #endif /* _macro_vecswap_H */
\ No newline at end of file